@@ -0,0 +1,69 @@
+// Scenario runner comparing the flat and packed per-cell node stores.
+// Usage: A_star_packed [map_file] [scen_file] [flat|packed|both]
+//
+// Peak RSS is process-wide, so "both" runs packed first: the number printed
+// after it is the packed peak, and the one after flat is the flat peak.
+// Run each mode on its own for clean numbers.
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "bench_util.h"
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+template <class Store>
+void run_mode(const string& name, const GridMap& map, const ComponentIndex& components,
+              const vector<Scenario>& scenarios) {
+    Store store;
+    SearchStats stats;
+    int solved = 0, failed = 0, rejected = 0;
+    double total_cost = 0;
+
+    Timer timer;
+    for (const auto& s : scenarios) {
+        // Blocked endpoints and start/goal in different components
+        if (!components.connected(s.start, s.goal)) {
+            failed++;
+            rejected++;
+            continue;
+        }
+        vector<pii> path = grid_a_star(map, s.start, s.goal, store, &stats);
+        if (!path.empty()) {
+            solved++;
+            total_cost += stats.cost;
+        } else {
+            failed++;
+        }
+    }
+    double secs = timer.seconds();
+
+    cout << "\n=== " << name << " ===\n";
+    cout << "Solved: " << solved << "  Failed: " << failed << " (" << rejected << " rejected without search)\n";
+    if (solved > 0)
+        cout << "Average path cost: " << total_cost / solved << "\n";
+    cout << "Expansions: " << stats.expansions << " in " << secs << " s ("
+         << (secs > 0 ? stats.expansions / secs : 0) << " exp/s)\n";
+    cout << "Node store: " << store.bytes() / (1024.0 * 1024.0) << " MB ("
+         << (double)store.bytes() / map.size() << " bytes/cell)\n";
+    cout << "Peak RSS: " << peak_rss_mb() << " MB\n";
+}
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    string scen_file = argc > 2 ? argv[2] : "AcrosstheCape.map.scen";
+    string mode = argc > 3 ? argv[3] : "both";
+
+    GridMap map = read_grid_map(map_file);
+    vector<Scenario> scenarios = read_scenarios(scen_file);
+    Timer timer;
+    ComponentIndex components(map);
+    cout << "Map " << map.rows << "x" << map.cols << ", " << scenarios.size() << " scenarios, "
+         << components.components() << " components (" << timer.seconds() * 1000 << " ms)\n";
+
+    if (mode == "packed" || mode == "both") run_mode<PackedNodeStore>("packed", map, components, scenarios);
+    if (mode == "flat" || mode == "both") run_mode<FlatNodeStore>("flat", map, components, scenarios);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <sys/resource.h>
+
+using namespace std;
+
+// Peak resident set size of this process so far, in MB (Linux reports KB).
+inline double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+struct Timer {
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+    void reset() { t0 = chrono::steady_clock::now(); }
+    double seconds() const {
+        return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    }
+};
+
+#endif // BENCH_UTIL_H
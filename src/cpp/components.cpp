@@ -0,0 +1,115 @@
+// Connected-component index: build time, O(1) rejection of unreachable
+// queries against what A* spends on them, and random cell toggles checked
+// against a full rebuild.
+// Usage: components [map_file] [queries] [updates] [check_every] [seed]
+#include "grid_map.h"
+#include "grid_components.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "bench_util.h"
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+// Same partition, whatever the label numbers
+bool same_components(const ComponentIndex& a, const ComponentIndex& b, size_t cells) {
+    if (a.components() != b.components()) return false;
+    vector<int> a_to_b, b_to_a;
+    for (size_t i = 0; i < cells; ++i) {
+        int la = a.label(i), lb = b.label(i);
+        if ((la == ComponentIndex::BLOCKED) != (lb == ComponentIndex::BLOCKED)) return false;
+        if (la == ComponentIndex::BLOCKED) continue;
+        if (la >= (int)a_to_b.size()) a_to_b.resize(la + 1, -1);
+        if (lb >= (int)b_to_a.size()) b_to_a.resize(lb + 1, -1);
+        if (a_to_b[la] < 0 && b_to_a[lb] < 0) a_to_b[la] = lb, b_to_a[lb] = la;
+        if (a_to_b[la] != lb || b_to_a[lb] != la) return false;
+        if (a.component_size(la) != b.component_size(lb)) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    int queries = argc > 2 ? stoi(argv[2]) : 200;
+    int updates = argc > 3 ? stoi(argv[3]) : 100000;
+    int check_every = argc > 4 ? stoi(argv[4]) : 10000;
+    uint64_t seed = argc > 5 ? stoull(argv[5]) : 1;
+
+    GridMap map = read_grid_map(map_file);
+    if (map.size() == 0) return 1;
+    Timer timer;
+    ComponentIndex index(map);
+    double build_seconds = timer.seconds();
+    uint32_t largest = 0;
+    for (size_t i = 0; i < map.size(); ++i) {
+        if (index.label(i) != ComponentIndex::BLOCKED) largest = max(largest, index.component_size(index.label(i)));
+    }
+    cout << "Map " << map.rows << "x" << map.cols << ": " << index.components() << " components (largest "
+         << largest << " cells), built in " << build_seconds * 1000 << " ms, " << index.bytes() / 1048576.0
+         << " MB\n";
+
+    // Random free start/goal pairs; only the unreachable ones are searched
+    mt19937_64 rng(seed);
+    auto random_free_cell = [&]() {
+        int i;
+        do i = rng() % map.size();
+        while (!map.passable[i]);
+        return map.cell(i);
+    };
+    vector<pair<pii, pii>> unreachable;
+    int drawn = 0;
+    for (; drawn < 1000 * queries && (int)unreachable.size() < queries; ++drawn) {
+        pii a = random_free_cell(), b = random_free_cell();
+        if (!index.connected(a, b)) unreachable.push_back({a, b});
+    }
+    cout << "\n=== " << unreachable.size() << " unreachable of " << drawn << " random queries ===\n";
+    if (!unreachable.empty()) {
+        FlatNodeStore store;
+        SearchStats stats;
+        int found = 0;
+        timer.reset();
+        for (const auto& q : unreachable) found += !grid_a_star(map, q.first, q.second, store, &stats).empty();
+        double search_seconds = timer.seconds();
+        timer.reset();
+        int rejected = 0;
+        for (int rep = 0; rep < 1000; ++rep) {
+            for (const auto& q : unreachable) rejected += !index.connected(q.first, q.second);
+        }
+        double reject_seconds = timer.seconds() / 1000;
+        cout << "A*:    " << search_seconds / unreachable.size() * 1e3 << " ms/query, "
+             << stats.expansions / unreachable.size() << " expansions/query" << (found ? " (PATH FOUND!)" : "")
+             << "\n";
+        cout << "Index: " << reject_seconds / unreachable.size() * 1e9 << " ns/query\n";
+        if (found || rejected != 1000 * (int)unreachable.size()) return 1;
+    }
+
+    if (updates <= 0) return 0;
+    cout << "\n=== " << updates << " random cell toggles ===\n";
+    double update_seconds = 0, rebuild_seconds = 0;
+    int rebuilds = 0;
+    bool ok = true;
+    for (int u = 1; u <= updates; ++u) {
+        pii p = map.cell(rng() % map.size());
+        timer.reset();
+        if (map.passable[map.index(p)]) index.block_cell(map, p.first, p.second);
+        else index.open_cell(map, p.first, p.second);
+        update_seconds += timer.seconds();
+        if (u % check_every == 0 || u == updates) {
+            timer.reset();
+            ComponentIndex fresh(map);
+            rebuild_seconds += timer.seconds();
+            ++rebuilds;
+            if (!same_components(index, fresh, map.size())) {
+                cout << "Mismatch with a full rebuild after " << u << " updates\n";
+                ok = false;
+                break;
+            }
+        }
+    }
+    cout << "Update: " << update_seconds / updates * 1e6 << " us average, rebuild: "
+         << rebuild_seconds / max(rebuilds, 1) * 1e3 << " ms; " << index.components() << " components now, "
+         << (ok ? "matches" : "DIFFERS FROM") << " a full rebuild\n";
+    return ok ? 0 : 1;
+}
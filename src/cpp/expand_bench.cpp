@@ -0,0 +1,103 @@
+// Batched neighbor scoring against the one-successor-at-a-time A* loop on
+// scenario suites: expansions per second for grid_a_star (FlatNodeStore),
+// grid_a_star_batched with the scalar kernel and with the SIMD kernel, and
+// a bit-for-bit check that all three return the same cost, expansions and
+// path on every query.
+// Usage: expand_bench [max_scenarios] [repeat] map_file...
+// Each map's scenarios are read from <map_file>.scen. Build with
+// -DSEARCH_NATIVE=ON for the AVX2 kernel; otherwise it is SSE2.
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_astar_simd.h"
+#include "grid_components.h"
+#include "bench_util.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+struct EngineRun {
+    double seconds = 0;
+    uint64_t expansions = 0;
+    vector<float> costs;
+    vector<vector<pii>> paths;
+};
+
+template <class Search>
+EngineRun run_engine(const GridMap& map, const vector<Scenario>& scenarios, int repeat, Search search) {
+    EngineRun run;
+    FlatNodeStore store;
+    for (int k = 0; k < repeat; ++k) {
+        for (const Scenario& s : scenarios) {
+            SearchStats stats;
+            Timer timer;
+            bool found = search(s, store, stats);
+            run.seconds += timer.seconds();
+            run.expansions += stats.expansions;
+            if (k > 0) continue;
+            run.costs.push_back(found ? stats.cost : -1.0f);
+            run.paths.push_back(found ? reconstruct_path(map, store, map.index(s.start), map.index(s.goal))
+                                      : vector<pii>());
+        }
+    }
+    return run;
+}
+
+bool same_bits(float a, float b) { return memcmp(&a, &b, sizeof(float)) == 0; }
+
+// Queries where b differs from a in cost bits or path
+int mismatches(const EngineRun& a, const EngineRun& b) {
+    int count = 0;
+    for (size_t i = 0; i < a.costs.size(); ++i)
+        if (!same_bits(a.costs[i], b.costs[i]) || a.paths[i] != b.paths[i]) ++count;
+    return count + (a.expansions != b.expansions);
+}
+
+int main(int argc, char** argv) {
+    int max_scenarios = argc > 1 ? stoi(argv[1]) : 500;
+    int repeat = argc > 2 ? max(1, stoi(argv[2])) : 1;
+    vector<string> map_files(argv + min(argc, 3), argv + argc);
+    if (map_files.empty()) map_files.push_back("AcrosstheCape.map");
+
+    cout << "SIMD kernel: " << GRID_SIMD_NAME << "\n";
+    cout << left << setw(28) << "map" << right << setw(8) << "queries" << setw(12) << "expansions" << setw(13)
+         << "loop Mexp/s" << setw(13) << "scalar" << setw(13) << "simd" << setw(9) << "speedup" << setw(11)
+         << "mismatch" << "\n";
+    int total_mismatches = 0;
+    for (const string& map_file : map_files) {
+        GridMap map = read_grid_map(map_file);
+        ComponentIndex components(map);
+        vector<Scenario> all = read_scenarios(map_file + ".scen"), scenarios;
+        int n = min<int>(max_scenarios, all.size());
+        for (int i = 0; i < n; ++i) {
+            const Scenario& s = all[(size_t)i * all.size() / n];
+            if (components.connected(s.start, s.goal)) scenarios.push_back(s);
+        }
+        if (scenarios.empty()) continue;
+
+        EngineRun loop = run_engine(map, scenarios, repeat, [&](const Scenario& s, FlatNodeStore& store,
+                                                                SearchStats& stats) {
+            return grid_a_star_search(map, s.start, s.goal, store, FlatNodeStore::heuristic, &stats);
+        });
+        EngineRun scalar = run_engine(map, scenarios, repeat, [&](const Scenario& s, FlatNodeStore& store,
+                                                                  SearchStats& stats) {
+            return grid_a_star_batched<false>(map, s.start, s.goal, store, &stats);
+        });
+        EngineRun simd = run_engine(map, scenarios, repeat, [&](const Scenario& s, FlatNodeStore& store,
+                                                                SearchStats& stats) {
+            return grid_a_star_batched<true>(map, s.start, s.goal, store, &stats);
+        });
+        int bad = mismatches(loop, scalar) + mismatches(loop, simd);
+        total_mismatches += bad;
+
+        string name = map_file.substr(map_file.find_last_of('/') + 1);
+        auto rate = [](const EngineRun& r) { return r.expansions / max(r.seconds, 1e-9) / 1e6; };
+        cout << left << setw(28) << name << right << setw(8) << scenarios.size() << setw(12) << loop.expansions
+             << fixed << setprecision(2) << setw(13) << rate(loop) << setw(13) << rate(scalar) << setw(13)
+             << rate(simd) << setw(9) << rate(simd) / rate(loop) << setw(11) << bad << "\n";
+    }
+    return total_mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,345 @@
+#include "fastmap_dynamic.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <functional>
+
+FastMapUpdater::FastMapUpdater(const GridMap& map, FastMapEmbedding& embedding)
+    : map(map), embedding(embedding), embedded(map.passable), mark(map.size(), 0),
+      prev(map.size()), seen_dirs(map.size(), 0) {
+    int dims = min<int>(embedding.dims, embedding.pivots.size());
+    embedding.dims = dims;
+    trees.resize(2 * dims);
+    offset.assign(dims, 0.0f);
+    FastMapUpdateStats stats;
+    rebuild(0, stats);
+}
+
+// Dimensions from..dims-1 from scratch, as at setup
+void FastMapUpdater::rebuild(int from, FastMapUpdateStats& stats) {
+    for (int k = from; k < embedding.dims; ++k) {
+        stats.pivots_moved += fix_pivots(k);
+        build_tree(trees[2 * k], embedding.pivots[k].first, k);
+        build_tree(trees[2 * k + 1], embedding.pivots[k].second, k);
+        float dab = trees[2 * k].dist[embedding.pivots[k].second];
+        offset[k] = dab < INFINITY ? dab : 0.0f;
+        // Dimension k must be in place before the residual graph of k + 1
+        for (size_t i = 0; i < map.size(); ++i) embedding.coords[i * embedding.stride + k] = coordinate(k, i);
+        stats.resettled += 2 * map.size();
+        stats.coords += map.size();
+    }
+}
+
+// Moves blocked pivots of dimension k to the nearest free cell
+int FastMapUpdater::fix_pivots(int k) {
+    int moved_pivots = 0;
+    for (int side = 0; side < 2; ++side) {
+        int& pivot = side == 0 ? embedding.pivots[k].first : embedding.pivots[k].second;
+        if (pivot >= 0 && map.passable[pivot]) continue;
+        pivot = nearest_free(pivot < 0 ? 0 : pivot);
+        ++moved_pivots;
+    }
+    return moved_pivots;
+}
+
+size_t FastMapUpdater::bytes() const {
+    size_t total = embedded.capacity() + mark.capacity() * sizeof(uint32_t) + prev.capacity() * sizeof(float) +
+                   seen_dirs.capacity() + offset.capacity() * sizeof(float);
+    for (const Tree& tree : trees) total += tree.dist.capacity() * sizeof(float) + tree.parent.capacity();
+    return total;
+}
+
+uint32_t FastMapUpdater::next_mark() {
+    if (++mark_generation == 0) {
+        fill(mark.begin(), mark.end(), 0);
+        mark_generation = 1;
+    }
+    return mark_generation;
+}
+
+// w_k(cell, dir): the move cost with the first k axes subtracted, as
+// FastMapBuilder::add_dimension leaves it. can_move does not look at the
+// source cell, so moves out of blocked cells are excluded here.
+float FastMapUpdater::residual(int k, int cell, int dir) const {
+    int r = cell / map.cols, c = cell % map.cols;
+    if (!map.passable[cell] || !map.can_move(r, c, dir)) return INFINITY;
+    const float* pu = &embedding.coords[(size_t)cell * embedding.stride];
+    const float* pv = &embedding.coords[(size_t)(cell + map.dir_offset(dir)) * embedding.stride];
+    float w = dir_cost(dir);
+    for (int j = 0; j < k; ++j) w = max(0.0f, w - fabs(pu[j] - pv[j]));
+    return w;
+}
+
+float FastMapUpdater::coordinate(int k, int cell) const {
+    float da = trees[2 * k].dist[cell], db = trees[2 * k + 1].dist[cell];
+    return da < INFINITY && db < INFINITY ? (da + offset[k] - db) / 2 : 0.0f;
+}
+
+void FastMapUpdater::build_tree(Tree& tree, int source, int k) {
+    auto cmp = greater<pair<float, int>>();
+    tree.dist.assign(map.size(), INFINITY);
+    tree.parent.assign(map.size(), NO_PARENT);
+    if (source < 0 || !map.passable[source]) return;
+    tree.dist[source] = 0.0f;
+    heap.assign(1, {0.0f, source});
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto [d, cell] = heap.back();
+        heap.pop_back();
+        if (d > tree.dist[cell]) continue;
+        for (int dir = 0; dir < 8; ++dir) {
+            float w = residual(k, cell, dir);
+            if (!(w < INFINITY)) continue;
+            int nb = cell + map.dir_offset(dir);
+            if (d + w < tree.dist[nb]) {
+                tree.dist[nb] = d + w;
+                tree.parent[nb] = (uint8_t)dir;
+                heap.emplace_back(d + w, nb);
+                push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+}
+
+bool FastMapUpdater::repair_tree(Tree& tree, int k, const vector<EdgeChange>& changes, vector<int>& touched) {
+    auto cmp = greater<pair<float, int>>();
+    uint32_t m = next_mark();
+
+    // Every cell below a changed tree edge loses its distance: its path to
+    // the pivot now costs something else, or no longer exists
+    size_t first = touched.size();
+    vector<int> stack;
+    for (const EdgeChange& e : changes) {
+        int v = e.cell + map.dir_offset(e.dir);
+        if (tree.parent[v] == e.dir && mark[v] != m) {
+            mark[v] = m;
+            stack.push_back(v);
+        }
+    }
+    while (!stack.empty()) {
+        int x = stack.back();
+        stack.pop_back();
+        touched.push_back(x);
+        int r = x / map.cols, c = x % map.cols;
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!map.in_bounds(r + DIR_DR[dir], c + DIR_DC[dir])) continue;
+            int child = x + map.dir_offset(dir);
+            if (mark[child] != m && tree.parent[child] == dir) {
+                mark[child] = m;
+                stack.push_back(child);
+            }
+        }
+        tree.dist[x] = INFINITY;
+        tree.parent[x] = NO_PARENT;
+    }
+    // Past half the map, a fresh Dijkstra is cheaper than reseeding
+    if (touched.size() - first > map.size() / 2) return false;
+
+    // Reset cells start from their best intact neighbor
+    heap.clear();
+    size_t reset_end = touched.size();
+    for (size_t t = first; t < reset_end; ++t) {
+        int x = touched[t];
+        for (int dir = 0; dir < 8; ++dir) {
+            float w = residual(k, x, dir); // weights are symmetric
+            if (!(w < INFINITY)) continue;
+            int y = x + map.dir_offset(dir);
+            if (mark[y] == m || !(tree.dist[y] < INFINITY)) continue;
+            float d = tree.dist[y] + w;
+            if (d < tree.dist[x]) {
+                tree.dist[x] = d;
+                tree.parent[x] = (uint8_t)OPPOSITE_DIR[dir];
+            }
+        }
+        if (tree.dist[x] < INFINITY) heap.emplace_back(tree.dist[x], x);
+    }
+    // Edges that got cheaper (or appeared) can shorten paths anywhere
+    for (const EdgeChange& e : changes) {
+        if (!(e.new_w < INFINITY) || !(tree.dist[e.cell] < INFINITY)) continue;
+        int v = e.cell + map.dir_offset(e.dir);
+        float d = tree.dist[e.cell] + e.new_w;
+        if (d < tree.dist[v]) {
+            tree.dist[v] = d;
+            tree.parent[v] = (uint8_t)e.dir;
+            heap.emplace_back(d, v);
+            touched.push_back(v);
+        }
+    }
+    make_heap(heap.begin(), heap.end(), cmp);
+
+    while (!heap.empty()) {
+        pop_heap(heap.begin(), heap.end(), cmp);
+        auto [d, cell] = heap.back();
+        heap.pop_back();
+        if (d > tree.dist[cell]) continue;
+        for (int dir = 0; dir < 8; ++dir) {
+            float w = residual(k, cell, dir);
+            if (!(w < INFINITY)) continue;
+            int nb = cell + map.dir_offset(dir);
+            if (d + w < tree.dist[nb]) {
+                tree.dist[nb] = d + w;
+                tree.parent[nb] = (uint8_t)dir;
+                heap.emplace_back(d + w, nb);
+                push_heap(heap.begin(), heap.end(), cmp);
+                touched.push_back(nb);
+            }
+        }
+    }
+    return true;
+}
+
+int FastMapUpdater::nearest_free(int cell) const {
+    int r0 = cell / map.cols, c0 = cell % map.cols;
+    for (int radius = 1; radius < max(map.rows, map.cols); ++radius) {
+        for (int r = r0 - radius; r <= r0 + radius; ++r) {
+            for (int c = c0 - radius; c <= c0 + radius; ++c) {
+                bool ring = r == r0 - radius || r == r0 + radius || c == c0 - radius || c == c0 + radius;
+                if (ring && map.is_passable(r, c)) return map.index(r, c);
+            }
+        }
+    }
+    return -1;
+}
+
+FastMapUpdateStats FastMapUpdater::update(const vector<pii>& cells) {
+    FastMapUpdateStats stats;
+    Timer timer;
+    GridMap before;
+    before.rows = map.rows;
+    before.cols = map.cols;
+
+    // Dimension 0: moves whose legality changed. A cell's state decides
+    // the moves into and out of it and the diagonals passing by it, all of
+    // which start in its 3x3 neighborhood.
+    vector<int> edited;
+    uint32_t m = next_mark();
+    for (const pii& p : cells) {
+        if (!map.in_bounds(p.first, p.second)) continue;
+        int i = map.index(p);
+        if (embedded[i] == map.passable[i] || mark[i] == m) continue;
+        mark[i] = m;
+        edited.push_back(i);
+    }
+    if (edited.empty()) return stats;
+    before.passable.swap(embedded);
+    vector<EdgeChange> changes;
+    uint32_t scanned = next_mark();
+    for (int x : edited) {
+        int r0 = x / map.cols, c0 = x % map.cols;
+        for (int r = r0 - 1; r <= r0 + 1; ++r) {
+            for (int c = c0 - 1; c <= c0 + 1; ++c) {
+                if (!map.in_bounds(r, c)) continue;
+                int i = map.index(r, c);
+                if (mark[i] == scanned) continue;
+                mark[i] = scanned;
+                for (int dir = 0; dir < 8; ++dir) {
+                    bool was = before.passable[i] && before.can_move(r, c, dir);
+                    bool is = map.passable[i] && map.can_move(r, c, dir);
+                    if (was != is)
+                        changes.push_back({i, dir, was ? dir_cost(dir) : INFINITY,
+                                           is ? dir_cost(dir) : INFINITY});
+                }
+            }
+        }
+    }
+    embedded.swap(before.passable);
+    for (int x : edited) embedded[x] = map.passable[x];
+
+    // Full-rebuild cost in cells: two trees and one coordinate per cell
+    // and dimension
+    size_t rebuild_cost = 3 * map.size() * embedding.dims;
+    for (int k = 0; k < embedding.dims; ++k) {
+        int moved_pivots = fix_pivots(k);
+        stats.pivots_moved += moved_pivots;
+        if (changes.empty() && moved_pivots == 0) break; // nothing below this dimension changes either
+        // Repair costs more per cell than a fresh Dijkstra, so once the
+        // batch has touched a fraction of a rebuild, rebuilding what is
+        // left is the cheaper bet
+        if (stats.resettled + stats.coords + changes.size() > rebuild_cost / REBUILD_DIVISOR) {
+            stats.rebuilt_from = k;
+            stats.edges += changes.size();
+            rebuild(k, stats);
+            break;
+        }
+        stats.edges += changes.size();
+
+        // Pivot distances, then the coordinates that depend on them
+        bool all = moved_pivots > 0;
+        vector<int> touched;
+        for (int side = 0; side < 2; ++side) {
+            Tree& tree = trees[2 * k + side];
+            int pivot = side == 0 ? embedding.pivots[k].first : embedding.pivots[k].second;
+            size_t before_repair = touched.size();
+            if (moved_pivots > 0 || !repair_tree(tree, k, changes, touched)) {
+                build_tree(tree, pivot, k);
+                touched.resize(before_repair);
+                all = true;
+            }
+            stats.resettled += all ? map.size() : touched.size() - before_repair;
+        }
+        if (moved_pivots > 0) {
+            float dab = trees[2 * k].dist[embedding.pivots[k].second];
+            offset[k] = dab < INFINITY ? dab : 0.0f;
+        }
+        // prev keeps the old coordinate of every refreshed cell (marked)
+        uint32_t refreshed = next_mark();
+        auto refresh = [&](int cell) {
+            if (mark[cell] == refreshed) return;
+            mark[cell] = refreshed;
+            float& p = embedding.coords[(size_t)cell * embedding.stride + k];
+            prev[cell] = p;
+            p = coordinate(k, cell);
+            if (p != prev[cell]) moved.push_back(cell);
+        };
+        moved.clear();
+        if (all) {
+            for (size_t i = 0; i < map.size(); ++i) refresh(i);
+        } else {
+            for (int cell : touched) refresh(cell);
+        }
+        stats.coords += moved.size();
+        if (k + 1 == embedding.dims) break;
+
+        // Residual weights of dimension k + 1: w' = max(0, w - |p_u - p_v|)
+        // changes where w changed or either end moved
+        auto old_p = [&](int cell) {
+            return mark[cell] == refreshed ? prev[cell] : embedding.coords[(size_t)cell * embedding.stride + k];
+        };
+        auto new_p = [&](int cell) { return embedding.coords[(size_t)cell * embedding.stride + k]; };
+        vector<EdgeChange> next;
+        auto consider = [&](int u, int dir, float old_w, float new_w) {
+            int v = u + map.dir_offset(dir);
+            float old_next = old_w < INFINITY ? max(0.0f, old_w - fabs(old_p(u) - old_p(v))) : INFINITY;
+            float new_next = new_w < INFINITY ? max(0.0f, new_w - fabs(new_p(u) - new_p(v))) : INFINITY;
+            if (old_next != new_next) next.push_back({u, dir, old_next, new_next});
+        };
+        // An edge is visited once: through changes, or from one of its ends
+        auto first_visit = [&](int u, int dir) {
+            if (seen_dirs[u] == 0) seen_cells.push_back(u);
+            bool first = !(seen_dirs[u] & (1 << dir));
+            seen_dirs[u] |= 1 << dir;
+            return first;
+        };
+        for (const EdgeChange& e : changes) {
+            first_visit(e.cell, e.dir);
+            consider(e.cell, e.dir, e.old_w, e.new_w);
+        }
+        for (int cell : moved) {
+            int r = cell / map.cols, c = cell % map.cols;
+            for (int dir = 0; dir < 8; ++dir) {
+                if (!map.passable[cell] || !map.can_move(r, c, dir)) continue;
+                int nb = cell + map.dir_offset(dir);
+                // Both directions: the trees are directed
+                for (auto [u, d] : {pair<int, int>{cell, dir}, pair<int, int>{nb, OPPOSITE_DIR[dir]}}) {
+                    if (!first_visit(u, d)) continue;
+                    float w = residual(k, u, d);
+                    consider(u, d, w, w);
+                }
+            }
+        }
+        for (int cell : seen_cells) seen_dirs[cell] = 0;
+        seen_cells.clear();
+        changes.swap(next);
+    }
+    stats.seconds = timer.seconds();
+    return stats;
+}
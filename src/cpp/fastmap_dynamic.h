@@ -0,0 +1,111 @@
+#ifndef FASTMAP_DYNAMIC_H
+#define FASTMAP_DYNAMIC_H
+
+#include "grid_map.h"
+#include "fastmap_embedding.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Keeps a FastMap embedding exact while cells are blocked and opened, so a
+// changing map does not need a full re-embedding.
+//
+// The pivots stay fixed. FastMap is admissible for any choice of pivots, so
+// the updated embedding is exactly what a fresh embedding with the same
+// pivots would be (up to float rounding). For every dimension, the updater
+// keeps the shortest-path trees of both pivots on that dimension's residual
+// graph. Each edit batch is pushed through the dimensions in order:
+//   1. residual edge weights that changed: at dimension 0 the moves around
+//      the edited cells; at dimension k + 1 the changed edges of dimension k
+//      and the edges of cells whose coordinate k moved
+//   2. dynamic shortest-path repair of both pivot trees: subtrees hanging
+//      off a changed tree edge are reset and re-seeded from their intact
+//      border, then Dijkstra runs from the seeds and from changed edges that
+//      got cheaper. Only cells whose distance can have changed are visited.
+//   3. cells whose pivot distances changed get their coordinate recomputed
+// Residual weights are not stored. w_k(u, v) is recomputed from the move
+// cost and the coordinates of the first k dimensions, the same expression
+// FastMapBuilder applies, so the updater needs only two distance floats and
+// two parent bytes per cell and dimension besides the embedding.
+//
+// The offset d(a, b) in (d(a, v) + d(a, b) - d(v, b)) / 2 is frozen at
+// setup. It shifts every coordinate of an axis equally, so L1 distances are
+// unaffected. A pivot that gets blocked moves to the nearest free cell; the
+// dimension's trees and offset are then rebuilt.
+//
+// A batch can cascade: coordinates that move in one dimension change the
+// residual weights of the next. Once the cells repaired and refreshed for
+// a batch approach the cost of a full rebuild, the remaining dimensions
+// are rebuilt from scratch instead (FastMapUpdateStats::rebuilt_from).
+struct FastMapUpdateStats {
+    size_t edges = 0;     // residual weights that changed, all dimensions
+    size_t resettled = 0; // pivot distances recomputed, all trees
+    size_t coords = 0;    // coordinates that moved
+    int pivots_moved = 0;
+    int rebuilt_from = -1; // first dimension rebuilt from scratch, -1 = none
+    double seconds = 0;
+};
+
+class FastMapUpdater {
+public:
+    // embedding must have pivots (build_fastmap / tune_fastmap) and belong
+    // to map. Builds the pivot trees (two full Dijkstras per dimension) and
+    // rewrites embedding.coords from them. Both references must outlive
+    // the updater.
+    FastMapUpdater(const GridMap& map, FastMapEmbedding& embedding);
+
+    // cells: cells whose passability changed in map since the last update
+    // (or since construction). Duplicates and unchanged cells are ignored.
+    FastMapUpdateStats update(const vector<pii>& cells);
+
+    size_t bytes() const;
+
+private:
+    static constexpr uint8_t NO_PARENT = 0xff;
+    // A batch whose repairs reach 1/REBUILD_DIVISOR of a full rebuild
+    // rebuilds its remaining dimensions instead
+    static const size_t REBUILD_DIVISOR = 4;
+
+    // Shortest-path tree of one pivot; parent is the direction of the move
+    // into the cell
+    struct Tree {
+        vector<float> dist;
+        vector<uint8_t> parent;
+    };
+    // Changed residual edge (cell, dir) with its old and new weight
+    struct EdgeChange {
+        int cell;
+        int dir;
+        float old_w, new_w;
+    };
+
+    const GridMap& map;
+    FastMapEmbedding& embedding;
+    vector<uint8_t> embedded;  // passability the trees describe
+    vector<Tree> trees;        // 2 per dimension: pivot a, then pivot b
+    vector<float> offset;      // frozen d(a, b) per dimension
+
+    // Scratch, reused across updates
+    vector<uint32_t> mark;
+    uint32_t mark_generation = 0;
+    vector<pair<float, int>> heap;
+    vector<float> prev;         // coordinate before the current level's refresh
+    vector<int> moved;          // cells whose coordinate moved at this level
+    vector<uint8_t> seen_dirs;  // edges already visited, a bit per direction
+    vector<int> seen_cells;
+
+    float residual(int k, int cell, int dir) const;
+    float coordinate(int k, int cell) const;
+    void build_tree(Tree& tree, int source, int k);
+    void rebuild(int from, FastMapUpdateStats& stats);
+    int fix_pivots(int k);
+    // Repairs tree after the edges in changes; appends the cells it
+    // recomputed to touched. False (tree left for build_tree) when most
+    // of the tree hangs off a changed edge.
+    bool repair_tree(Tree& tree, int k, const vector<EdgeChange>& changes, vector<int>& touched);
+    int nearest_free(int cell) const;
+    uint32_t next_mark();
+};
+
+#endif // FASTMAP_DYNAMIC_H
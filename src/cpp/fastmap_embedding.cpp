@@ -0,0 +1,145 @@
+#include "fastmap_embedding.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "node_store.h"
+#include "bench_util.h"
+#include <algorithm>
+
+// Reachable cell farthest from the source of dist, or -1.
+static int farthest(const vector<float>& dist) {
+    int best = -1;
+    for (size_t i = 0; i < dist.size(); ++i) {
+        if (dist[i] < INFINITY && (best < 0 || dist[i] > dist[best])) best = i;
+    }
+    return best;
+}
+
+FastMapBuilder::FastMapBuilder(const GridMap& map, uint32_t seed) : map(map), rng(seed) {
+    for (size_t i = 0; i < map.size(); ++i) {
+        if (map.passable[i]) free_cells.push_back(i);
+    }
+    weights.assign(map.size() * 8, INFINITY);
+    for (int i : free_cells) {
+        pii p = map.cell(i);
+        for (int dir = 0; dir < 8; ++dir) {
+            if (map.can_move(p.first, p.second, dir)) weights[(size_t)i * 8 + dir] = dir_cost(dir);
+        }
+    }
+    // First pivot search starts in the largest component: a start in a
+    // small pocket would only embed the pocket
+    if (free_cells.empty()) return;
+    ComponentIndex components(map);
+    int largest = components.label(free_cells[0]);
+    for (int i : free_cells) {
+        if (components.component_size(components.label(i)) > components.component_size(largest))
+            largest = components.label(i);
+    }
+    do start = free_cells[rng() % free_cells.size()];
+    while (components.label(start) != largest);
+}
+
+float FastMapBuilder::add_dimension() {
+    if (start < 0 || dims() >= FastMapEmbedding::MAX_DIMS) return 0.0f;
+    auto residual = [&](int cell, int dir) { return weights[(size_t)cell * 8 + dir]; };
+    vector<float> dist_a(map.size()), dist_b(map.size());
+
+    // Two sweeps towards the far end of the component
+    grid_dijkstra(map, start, residual, dist_a.data());
+    int b = farthest(dist_a);
+    grid_dijkstra(map, b, residual, dist_b.data());
+    int a = farthest(dist_b);
+    grid_dijkstra(map, a, residual, dist_a.data());
+    float dab = dist_a[b];
+    if (!(dab > 0.0f)) return 0.0f;
+
+    vector<float> axis(map.size(), 0.0f);
+    for (int i : free_cells) {
+        if (dist_a[i] < INFINITY && dist_b[i] < INFINITY) axis[i] = (dist_a[i] + dab - dist_b[i]) / 2;
+    }
+    for (int i : free_cells) {
+        for (int dir = 0; dir < 8; ++dir) {
+            float& w = weights[(size_t)i * 8 + dir];
+            if (w < INFINITY) w = max(0.0f, w - fabs(axis[i] - axis[i + map.dir_offset(dir)]));
+        }
+    }
+    axes.push_back(move(axis));
+    pivots.push_back({a, b});
+    start = a;
+    return dab;
+}
+
+FastMapEmbedding FastMapBuilder::embedding(int dims) const {
+    FastMapEmbedding embedding;
+    embedding.dims = min(dims, (int)axes.size());
+    embedding.stride = FastMapEmbedding::stride_for(embedding.dims);
+    embedding.pivots.assign(pivots.begin(), pivots.begin() + embedding.dims);
+    embedding.coords.assign(map.size() * embedding.stride, 0.0f);
+    for (int k = 0; k < embedding.dims; ++k) {
+        for (int i : free_cells) embedding.coords[(size_t)i * embedding.stride + k] = axes[k][i];
+    }
+    return embedding;
+}
+
+FastMapEmbedding build_fastmap(const GridMap& map, int max_dims, uint32_t seed, float eps) {
+    FastMapBuilder builder(map, seed);
+    while (builder.dims() < max_dims && builder.add_dimension() >= eps) {
+    }
+    return builder.embedding(builder.dims());
+}
+
+FastMapEmbedding tune_fastmap(const GridMap& map, const vector<Scenario>& sample, const FastMapTuneOptions& options,
+                              vector<FastMapTuneRow>* report) {
+    FlatNodeStore store;
+    // Sample expansions and time with the first `dims` axes (0 = octile)
+    auto measure = [&](const FastMapEmbedding& embedding, uint64_t& expansions, double& seconds) {
+        SearchStats stats;
+        Timer timer;
+        for (const Scenario& s : sample) {
+            if (!map.is_passable(s.start.first, s.start.second) || !map.is_passable(s.goal.first, s.goal.second))
+                continue;
+            if (embedding.dims == 0) {
+                grid_a_star(map, s.start, s.goal, store, &stats);
+            } else {
+                with_fastmap_heuristic(map, embedding, s.goal, [&](const auto& h) {
+                    return grid_a_star_with_heuristic(map, s.start, s.goal, store, h, &stats);
+                });
+            }
+        }
+        expansions = stats.expansions;
+        seconds = timer.seconds();
+    };
+
+    FastMapTuneRow row = {0, 0.0f, 0.0, 0, 0, 0.0};
+    measure(FastMapEmbedding(), row.expansions, row.query_seconds);
+    if (report) report->push_back(row);
+
+    Timer build_timer;
+    FastMapBuilder builder(map, options.seed);
+    double build_seconds = build_timer.seconds();
+    int best_dims = 0;
+    uint64_t best_expansions = row.expansions, last_expansions = row.expansions;
+    float first_gain = 0.0f;
+    int stalled = 0;
+    while (builder.dims() < min(options.max_dims, FastMapEmbedding::MAX_DIMS)) {
+        build_timer.reset();
+        float gain = builder.add_dimension();
+        if (gain <= 0.0f) break;
+        FastMapEmbedding embedding = builder.embedding(builder.dims());
+        build_seconds += build_timer.seconds();
+        if (first_gain == 0.0f) first_gain = gain;
+
+        row = {embedding.dims, gain, build_seconds, embedding.coords.size() * sizeof(float), 0, 0.0};
+        measure(embedding, row.expansions, row.query_seconds);
+        if (report) report->push_back(row);
+
+        if (row.expansions < best_expansions) {
+            best_expansions = row.expansions;
+            best_dims = embedding.dims;
+        }
+        bool improved = row.expansions < last_expansions * (1.0 - options.min_improvement);
+        stalled = improved ? 0 : stalled + 1;
+        last_expansions = row.expansions;
+        if (gain < options.min_gain * first_gain || stalled >= options.patience) break;
+    }
+    return builder.embedding(best_dims);
+}
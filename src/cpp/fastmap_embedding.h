@@ -0,0 +1,174 @@
+#ifndef FASTMAP_EMBEDDING_H
+#define FASTMAP_EMBEDDING_H
+
+#include "grid_map.h"
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Single-source Dijkstra over the 8-connected moves of map. weight(cell, dir)
+// is the cost of the move from cell in direction dir; moves can_move rejects
+// are never offered and infinite weights are skipped. dist must hold
+// map.size() floats; cells that cannot be reached are left at INFINITY.
+template <class Weight>
+void grid_dijkstra(const GridMap& map, int source, Weight weight, float* dist) {
+    using QueueElement = pair<float, int>;
+    priority_queue<QueueElement, vector<QueueElement>, greater<>> open_list;
+    for (size_t i = 0; i < map.size(); ++i) dist[i] = INFINITY;
+    dist[source] = 0.0f;
+    open_list.emplace(0.0f, source);
+
+    while (!open_list.empty()) {
+        auto [d, current] = open_list.top();
+        open_list.pop();
+        if (d > dist[current]) continue;
+        int r = current / map.cols;
+        int c = current % map.cols;
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!map.can_move(r, c, dir)) continue;
+            float w = weight(current, dir);
+            if (!(w < INFINITY)) continue;
+            int nb = current + map.dir_offset(dir);
+            if (d + w < dist[nb]) {
+                dist[nb] = d + w;
+                open_list.emplace(d + w, nb);
+            }
+        }
+    }
+}
+
+// FastMap embedding of a grid (Li et al., "FastMap: A Near-Optimal
+// Algorithm for Embedding Graphs into Euclidean Space"). Each dimension picks
+// two far-apart pivots a and b, places every cell v at
+// (d(a, v) + d(a, b) - d(v, b)) / 2 and subtracts the axis from the residual
+// edge weights: w' = max(0, w - |p_u - p_v|). The L1 distance between two
+// embedded cells never exceeds their true octile-cost distance, so it is an
+// admissible (and consistent) A* heuristic.
+//
+// Only the component of the first pivot is embedded; other cells keep
+// coordinate 0, which leaves the heuristic admissible there too.
+//
+// Each cell's coordinates are padded with zeros to `stride` floats (a
+// multiple of 4), so the heuristic kernel runs over a fixed, vectorizable
+// width.
+struct FastMapEmbedding {
+    static const int MAX_DIMS = 16;
+
+    int dims = 0;
+    int stride = 0;       // floats per cell
+    vector<float> coords; // cell-major: coords[cell * stride + k]
+    vector<pii> pivots;   // flat cell indices (a, b) per dimension
+
+    static int stride_for(int dims) { return (dims + 3) / 4 * 4; }
+
+    float distance(int a, int b) const {
+        const float* pa = &coords[(size_t)a * stride];
+        const float* pb = &coords[(size_t)b * stride];
+        float sum = 0.0f;
+        for (int k = 0; k < dims; ++k) sum += fabs(pa[k] - pb[k]);
+        return sum;
+    }
+};
+
+// A* heuristic max(octile, FastMap L1) towards one goal, for
+// grid_a_star_with_heuristic. Both terms are admissible and consistent, and
+// so is their max. Fused into one kernel: the goal's coordinates are copied
+// into the functor, the L1 loop runs over a compile-time STRIDE of padded
+// floats, and octile and max are computed in the same pass.
+template <int STRIDE>
+struct FastMapHeuristic {
+    const float* coords;
+    int cols;
+    int goal_row, goal_col;
+    float goal_coords[STRIDE];
+
+    FastMapHeuristic(const GridMap& map, const FastMapEmbedding& embedding, const pii& goal)
+        : coords(embedding.coords.data()), cols(map.cols), goal_row(goal.first), goal_col(goal.second) {
+        const float* g = &embedding.coords[(size_t)map.index(goal) * STRIDE];
+        for (int k = 0; k < STRIDE; ++k) goal_coords[k] = g[k];
+    }
+
+    float operator()(const pii& cell, const pii& /*goal*/) const {
+        const float* p = coords + ((size_t)cell.first * cols + cell.second) * STRIDE;
+        float l1 = 0.0f;
+        for (int k = 0; k < STRIDE; ++k) l1 += fabs(p[k] - goal_coords[k]);
+        int dr = abs(cell.first - goal_row);
+        int dc = abs(cell.second - goal_col);
+        float oct = octile_combine(dr > dc ? dr : dc, dr < dc ? dr : dc);
+        return l1 > oct ? l1 : oct;
+    }
+};
+
+// Calls visit(heuristic) with the FastMapHeuristic instance that matches the
+// embedding's stride, so the search is compiled once per stride and the
+// kernel has no per-call dispatch. The embedding must have dims > 0.
+template <class Visitor>
+auto with_fastmap_heuristic(const GridMap& map, const FastMapEmbedding& embedding, const pii& goal, Visitor&& visit) {
+    switch (embedding.stride) {
+    case 4: return visit(FastMapHeuristic<4>(map, embedding, goal));
+    case 8: return visit(FastMapHeuristic<8>(map, embedding, goal));
+    case 12: return visit(FastMapHeuristic<12>(map, embedding, goal));
+    default: return visit(FastMapHeuristic<16>(map, embedding, goal));
+    }
+}
+
+// Adds FastMap dimensions one at a time, keeping the residual edge weights
+// between calls, so callers can stop as soon as another axis stops paying.
+class FastMapBuilder {
+public:
+    FastMapBuilder(const GridMap& map, uint32_t seed);
+
+    // Adds one axis and returns its pivot distance d(a, b) on the residual
+    // graph: how much distance the axis captures. 0 when nothing is left
+    // to embed (or MAX_DIMS is reached); no axis is added then.
+    float add_dimension();
+    int dims() const { return axes.size(); }
+    // Embedding made of the first `dims` axes
+    FastMapEmbedding embedding(int dims) const;
+
+private:
+    const GridMap& map;
+    vector<int> free_cells;
+    vector<float> weights; // residual weight of every move, cell-major
+    vector<vector<float>> axes;
+    vector<pii> pivots;
+    mt19937 rng;
+    int start = -1;
+};
+
+// Builds up to max_dims dimensions; stops early once the pivot distance on
+// the residual graph drops below eps. Pivot choice is seeded.
+FastMapEmbedding build_fastmap(const GridMap& map, int max_dims, uint32_t seed, float eps = 1e-3f);
+
+// Per-map choice of the embedding dimension. Axes are added one at a time;
+// after each, A* with max(octile, FastMap L1) is run on the sample queries.
+// Tuning stops once an axis captures less than min_gain of the first axis's
+// pivot distance, or once the sample's expansions drop by less than
+// min_improvement (a fraction) for `patience` axes in a row. The returned
+// embedding has the dimension with the fewest sample expansions.
+struct FastMapTuneOptions {
+    int max_dims = FastMapEmbedding::MAX_DIMS;
+    float min_gain = 0.02f;
+    double min_improvement = 0.01;
+    int patience = 2;
+    uint32_t seed = 1;
+};
+
+// One line of the tuning report; dims = 0 is plain octile
+struct FastMapTuneRow {
+    int dims;
+    float pivot_distance;  // captured by the newest axis
+    double build_seconds;  // cumulative preprocessing time
+    size_t bytes;          // embedding size at this dimension
+    uint64_t expansions;   // over the sample
+    double query_seconds;  // over the sample
+};
+
+FastMapEmbedding tune_fastmap(const GridMap& map, const vector<Scenario>& sample, const FastMapTuneOptions& options,
+                              vector<FastMapTuneRow>* report = nullptr);
+
+#endif // FASTMAP_EMBEDDING_H
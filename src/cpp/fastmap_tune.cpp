@@ -0,0 +1,111 @@
+// Per-map FastMap dimension tuning: adds axes while they keep cutting A*
+// expansions on a sample of the scenarios, then compares octile, the
+// chosen max(octile, FastMap L1) with the fused kernel, and the same
+// heuristic evaluated axis by axis on the full scenario file.
+// Usage: fastmap_tune [map_file] [scen_file] [samples] [max_dims] [min_gain] [min_improvement]
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "fastmap_embedding.h"
+#include "bench_util.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+struct RunResult {
+    uint64_t expansions = 0;
+    double seconds = 0;
+    double total_cost = 0;
+    int solved = 0;
+};
+
+template <class Search>
+RunResult run_all(const GridMap& map, const vector<Scenario>& scenarios, Search search) {
+    RunResult result;
+    SearchStats stats;
+    Timer timer;
+    for (const Scenario& s : scenarios) {
+        if (!map.is_passable(s.start.first, s.start.second) || !map.is_passable(s.goal.first, s.goal.second))
+            continue;
+        stats.cost = 0;
+        if (!search(s, stats).empty()) {
+            ++result.solved;
+            result.total_cost += stats.cost;
+        }
+    }
+    result.seconds = timer.seconds();
+    result.expansions = stats.expansions;
+    return result;
+}
+
+void print_run(const string& name, const RunResult& r, const RunResult& base) {
+    cout << left << setw(26) << name << right << setw(12) << r.expansions << setw(9) << fixed << setprecision(1)
+         << 100.0 * r.expansions / max<uint64_t>(1, base.expansions) << "%" << setw(10) << setprecision(3)
+         << r.seconds << " s" << setw(10) << setprecision(1) << (r.expansions / max(r.seconds, 1e-9)) / 1e6
+         << " M exp/s  cost " << setprecision(3) << r.total_cost << "\n";
+}
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    string scen_file = argc > 2 ? argv[2] : "AcrosstheCape.map.scen";
+    int samples = argc > 3 ? stoi(argv[3]) : 100;
+    FastMapTuneOptions options;
+    if (argc > 4) options.max_dims = stoi(argv[4]);
+    if (argc > 5) options.min_gain = stof(argv[5]);
+    if (argc > 6) options.min_improvement = stod(argv[6]);
+
+    GridMap map = read_grid_map(map_file);
+    vector<Scenario> scenarios = read_scenarios(scen_file);
+    cout << "Map " << map.rows << "x" << map.cols << ", " << scenarios.size() << " scenarios\n";
+
+    // Spread the sample over the file, which is sorted by bucket
+    vector<Scenario> sample;
+    int n = min<int>(samples, scenarios.size());
+    for (int i = 0; i < n; ++i) sample.push_back(scenarios[(size_t)i * scenarios.size() / n]);
+
+    vector<FastMapTuneRow> report;
+    Timer timer;
+    FastMapEmbedding embedding = tune_fastmap(map, sample, options, &report);
+    double tune_seconds = timer.seconds();
+
+    cout << "\n=== Tuning on " << sample.size() << " sample queries ===\n";
+    cout << setw(4) << "K" << setw(14) << "pivot dist" << setw(12) << "build s" << setw(10) << "MB" << setw(14)
+         << "expansions" << setw(10) << "vs oct" << setw(12) << "query s\n";
+    for (const FastMapTuneRow& row : report) {
+        cout << setw(4) << row.dims << setw(14) << fixed << setprecision(2) << row.pivot_distance << setw(12)
+             << setprecision(3) << row.build_seconds << setw(10) << setprecision(1) << row.bytes / 1048576.0
+             << setw(14) << row.expansions << setw(9) << 100.0 * row.expansions / max<uint64_t>(1, report[0].expansions)
+             << "%" << setw(11) << setprecision(3) << row.query_seconds << "\n";
+    }
+    cout << "Chosen K = " << embedding.dims << " (tuning took " << tune_seconds << " s)\n";
+
+    cout << "\n=== All scenarios ===\n";
+    FlatNodeStore store;
+    RunResult octile_run = run_all(map, scenarios, [&](const Scenario& s, SearchStats& stats) {
+        return grid_a_star(map, s.start, s.goal, store, &stats);
+    });
+    print_run("octile", octile_run, octile_run);
+    if (embedding.dims == 0) return 0;
+
+    RunResult fused = run_all(map, scenarios, [&](const Scenario& s, SearchStats& stats) {
+        return with_fastmap_heuristic(map, embedding, s.goal, [&](const auto& h) {
+            return grid_a_star_with_heuristic(map, s.start, s.goal, store, h, &stats);
+        });
+    });
+    print_run("max(octile, FM) fused", fused, octile_run);
+
+    // Same values, one axis at a time through FastMapEmbedding::distance
+    RunResult separate = run_all(map, scenarios, [&](const Scenario& s, SearchStats& stats) {
+        int goal = map.index(s.goal);
+        auto h = [&](const pii& a, const pii& b) { return max(octile(a, b), embedding.distance(map.index(a), goal)); };
+        return grid_a_star_with_heuristic(map, s.start, s.goal, store, h, &stats);
+    });
+    print_run("max(octile, FM) per-axis", separate, octile_run);
+
+    double drift = fabs(fused.total_cost - octile_run.total_cost) / max(1.0, octile_run.total_cost);
+    cout << "Solved " << fused.solved << "/" << octile_run.solved << ", relative cost difference " << drift << "\n";
+    return fused.solved == octile_run.solved && drift < 1e-5 ? 0 : 1;
+}
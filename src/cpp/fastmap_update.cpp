@@ -0,0 +1,150 @@
+// Incremental FastMap maintenance under local edits: applies batches of cell
+// toggles around random centres, keeps the embedding current with
+// FastMapUpdater, and compares the update time with a full rebuild, with
+// batches repaired incrementally and batches that fell back to a rebuild
+// reported apart. Every check_every batches it checks the embedding against
+// one rebuilt from scratch with the same pivots (max coordinate difference,
+// up to a shift per axis) and runs sample queries with octile, the updated
+// embedding and a fresh build_fastmap (costs must match octile A*;
+// expansions show how informed each is).
+// Usage: fastmap_update [map_file] [dims] [batches] [batch_cells] [radius] [check_every] [queries] [seed]
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "fastmap_embedding.h"
+#include "fastmap_dynamic.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    int dims = argc > 2 ? stoi(argv[2]) : 8;
+    int batches = argc > 3 ? stoi(argv[3]) : 100;
+    int batch_cells = argc > 4 ? stoi(argv[4]) : 8;
+    int radius = argc > 5 ? stoi(argv[5]) : 3;
+    int check_every = argc > 6 ? max(1, stoi(argv[6])) : 25;
+    int queries = argc > 7 ? stoi(argv[7]) : 100;
+    uint32_t seed = argc > 8 ? stoul(argv[8]) : 1;
+
+    GridMap map = read_grid_map(map_file);
+    Timer timer;
+    FastMapEmbedding embedding = build_fastmap(map, dims, seed);
+    double build_s = timer.seconds();
+    timer.reset();
+    FastMapUpdater updater(map, embedding);
+    double setup_s = timer.seconds();
+    cout << "Map " << map.rows << "x" << map.cols << ", " << embedding.dims << " dims: build_fastmap " << fixed
+         << setprecision(1) << build_s * 1000 << " ms, updater setup " << setup_s * 1000 << " ms, "
+         << updater.bytes() / 1048576.0 << " MB of trees\n\n";
+
+    mt19937 rng(seed);
+    FlatNodeStore store;
+    // Queries with both endpoints free and connected, octile / updated / rebuilt
+    auto sample = [&](const FastMapEmbedding& fresh, uint64_t expansions[3], int& wrong) {
+        ComponentIndex components(map);
+        mt19937 query_rng(seed + 1);
+        wrong = 0;
+        for (int q = 0, tries = 0; q < queries && tries < 100 * queries; ++tries) {
+            pii s = map.cell(query_rng() % map.size()), g = map.cell(query_rng() % map.size());
+            if (!components.connected(s, g)) continue;
+            ++q;
+            SearchStats octile_stats, updated_stats, fresh_stats;
+            grid_a_star(map, s, g, store, &octile_stats);
+            with_fastmap_heuristic(map, embedding, g, [&](const auto& h) {
+                return grid_a_star_with_heuristic(map, s, g, store, h, &updated_stats);
+            });
+            with_fastmap_heuristic(map, fresh, g, [&](const auto& h) {
+                return grid_a_star_with_heuristic(map, s, g, store, h, &fresh_stats);
+            });
+            float opt = octile_stats.cost;
+            if (fabs(updated_stats.cost - opt) > 1e-3f * (1 + opt)) ++wrong;
+            expansions[0] += octile_stats.expansions;
+            expansions[1] += updated_stats.expansions;
+            expansions[2] += fresh_stats.expansions;
+        }
+    };
+
+    cout << setw(7) << "batch" << setw(11) << "update_ms" << setw(9) << "edges" << setw(11) << "resettled"
+         << setw(9) << "coords" << setw(12) << "rebuild_ms" << setw(10) << "max_diff" << setw(7) << "wrong"
+         << setw(10) << "exp_oct" << setw(10) << "exp_upd" << setw(10) << "exp_new" << "\n";
+    vector<double> update_ms, rebuilt_ms; // incremental / fell back to a rebuild
+    FastMapUpdateStats window;
+    int window_batches = 0, pivots_moved = 0;
+    for (int b = 1; b <= batches; ++b) {
+        pii centre = map.cell(rng() % map.size());
+        vector<pii> cells;
+        for (int k = 0; k < batch_cells; ++k) {
+            int r = centre.first + (int)(rng() % (2 * radius + 1)) - radius;
+            int c = centre.second + (int)(rng() % (2 * radius + 1)) - radius;
+            if (!map.in_bounds(r, c)) continue;
+            map.passable[map.index(r, c)] ^= 1;
+            cells.push_back({r, c});
+        }
+        FastMapUpdateStats stats = updater.update(cells);
+        (stats.rebuilt_from < 0 ? update_ms : rebuilt_ms).push_back(stats.seconds * 1000);
+        window.edges += stats.edges;
+        window.resettled += stats.resettled;
+        window.coords += stats.coords;
+        window.seconds += stats.seconds;
+        pivots_moved += stats.pivots_moved;
+        ++window_batches;
+        if (b % check_every != 0 && b != batches) continue;
+
+        // Same pivots from scratch
+        FastMapEmbedding rebuilt = embedding;
+        fill(rebuilt.coords.begin(), rebuilt.coords.end(), 0.0f);
+        timer.reset();
+        FastMapUpdater fresh_updater(map, rebuilt);
+        double rebuild_ms = timer.seconds() * 1000;
+        // The updater keeps d(a, b) from setup, so an axis may be shifted as
+        // a whole; compare relative to pivot a, over the cells it reaches
+        ComponentIndex components(map);
+        float max_diff = 0.0f;
+        for (int k = 0; k < embedding.dims; ++k) {
+            int a = embedding.pivots[k].first;
+            auto at = [&](const FastMapEmbedding& e, size_t i) { return e.coords[i * e.stride + k]; };
+            float shift = at(embedding, a) - at(rebuilt, a);
+            for (size_t i = 0; i < map.size(); ++i) {
+                if (components.connected(map.cell(i), map.cell(a)))
+                    max_diff = max(max_diff, fabs(at(embedding, i) - at(rebuilt, i) - shift));
+            }
+        }
+
+        uint64_t expansions[3] = {0, 0, 0};
+        int wrong = 0;
+        sample(build_fastmap(map, dims, seed), expansions, wrong);
+        cout << setw(7) << b << setw(11) << setprecision(3) << window.seconds * 1000 / window_batches << setw(9)
+             << window.edges / window_batches << setw(11) << window.resettled / window_batches << setw(9)
+             << window.coords / window_batches << setw(12) << setprecision(1) << rebuild_ms << setw(10)
+             << setprecision(5) << max_diff << setw(7) << wrong << setw(10) << expansions[0] << setw(10)
+             << expansions[1] << setw(10) << expansions[2] << "\n";
+        window = FastMapUpdateStats();
+        window_batches = 0;
+    }
+
+    auto summary = [&](const string& name, vector<double>& ms) {
+        cout << name << ": " << ms.size() << " batches";
+        if (!ms.empty()) {
+            sort(ms.begin(), ms.end());
+            double mean = 0;
+            for (double t : ms) mean += t;
+            mean /= ms.size();
+            cout << ", mean " << setprecision(3) << mean << " ms, p99 "
+                 << ms[min(ms.size() - 1, ms.size() * 99 / 100)] << " ms, max " << ms.back() << " ms";
+        }
+        cout << "\n";
+    };
+    cout << "\n";
+    summary("Incremental", update_ms);
+    summary("Rebuilt", rebuilt_ms);
+    cout << "build_fastmap " << setprecision(1) << build_s * 1000 << " ms; " << pivots_moved << " pivots moved\n";
+    return 0;
+}
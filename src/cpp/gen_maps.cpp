@@ -0,0 +1,93 @@
+// Deterministic benchmark suite: every family x size as <tag>_<size>_s<seed>.map
+// plus a matching .map.scen with bucketed optimal costs.
+// Usage: gen_maps [out_dir] [families] [sizes] [seed] [per_bucket] [verify]
+// families: comma-separated random[:density], rooms[:room_size],
+//           maze[:corridor_width], islands[:density]
+// sizes:    comma-separated side lengths, 64 .. 16384
+// per_bucket = 0 writes maps only. verify > 0 re-solves that many scenarios
+// per map with grid A* and reports the largest cost mismatch (maps up to
+// 4096^2, where the A* node store stays under 128 MB).
+#include "grid_map.h"
+#include "map_gen.h"
+#include "grid_astar.h"
+#include "node_store.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+using namespace std;
+
+vector<string> split(const string& list) {
+    vector<string> items;
+    stringstream in(list);
+    for (string item; getline(in, item, ',');)
+        if (!item.empty()) items.push_back(item);
+    return items;
+}
+
+int main(int argc, char** argv) {
+    string out_dir = argc > 1 ? argv[1] : "maps";
+    string families = argc > 2 ? argv[2] : "random:0.2,rooms:16,maze:1,islands:0.15";
+    string sizes = argc > 3 ? argv[3] : "64,256,1024";
+    uint64_t seed = argc > 4 ? stoull(argv[4]) : 1;
+    int per_bucket = argc > 5 ? stoi(argv[5]) : 10;
+    int verify = argc > 6 ? stoi(argv[6]) : 20;
+
+    if (mkdir(out_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        cerr << "Failed to create directory: " << out_dir << endl;
+        return 1;
+    }
+
+    bool ok = true;
+    for (const string& family : split(families)) {
+        for (const string& size : split(sizes)) {
+            MapGenOptions options;
+            if (!parse_map_family(family, options)) {
+                cerr << "Unknown map family: " << family << endl;
+                return 1;
+            }
+            options.rows = options.cols = stoi(size);
+            options.seed = seed;
+            string name = map_family_tag(options) + "_" + size + "_s" + to_string(seed) + ".map";
+            string path = out_dir + "/" + name;
+
+            Timer timer;
+            GridMap map = generate_map(options);
+            double gen_seconds = timer.seconds();
+            size_t free_cells = count(map.passable.begin(), map.passable.end(), 1);
+            ok &= write_grid_map(map, path);
+            cout << name << ": " << map.rows << "x" << map.cols << ", " << 100.0 * free_cells / map.size()
+                 << "% free, generated in " << gen_seconds << " s\n";
+            if (per_bucket <= 0) continue;
+
+            timer.reset();
+            ScenarioOptions scen_options;
+            scen_options.per_bucket = per_bucket;
+            scen_options.seed = seed;
+            vector<Scenario> scenarios = generate_scenarios(map, scen_options);
+            double scen_seconds = timer.seconds();
+            ok &= write_scenarios(scenarios, map, name, path + ".scen");
+            int buckets = scenarios.empty() ? 0 : (int)floor(scenarios.back().cost / 4) + 1;
+            cout << "  " << scenarios.size() << " scenarios in " << buckets << " buckets, " << scen_seconds << " s\n";
+
+            if (verify > 0 && map.size() <= 4096u * 4096u) {
+                PackedNodeStore store;
+                double worst = 0;
+                for (int i = 0; i < min<int>(verify, scenarios.size()); ++i) {
+                    const Scenario& s = scenarios[(size_t)i * scenarios.size() / min<int>(verify, scenarios.size())];
+                    SearchStats stats;
+                    vector<pii> found = grid_a_star(map, s.start, s.goal, store, &stats);
+                    worst = max(worst, found.empty() ? INFINITY : fabs(stats.cost - s.cost) / max(1.0, s.cost));
+                }
+                cout << "  A* check: worst relative cost error " << worst << "\n";
+                ok &= worst < 1e-3;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
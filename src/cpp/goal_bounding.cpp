@@ -0,0 +1,103 @@
+// Goal bounding: builds (or maps a saved) table for a map, then runs the
+// scenarios with plain A* and with goal-bounded A*, reporting build time,
+// table memory, the share of legal moves pruned, expansions and time.
+// Every bounded cost is checked against plain A*.
+// Usage: goal_bounding [map_file] [scen_file] [bounds_file] [threads] [max_scenarios] [rebuild]
+// bounds_file defaults to <map_file>.gb; it is built and saved when it is
+// missing, stale, or rebuild is 1.
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "goal_bounds.h"
+#include "bench_util.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    string scen_file = argc > 2 ? argv[2] : "AcrosstheCape.map.scen";
+    string bounds_file = argc > 3 ? argv[3] : map_file + ".gb";
+    int threads = argc > 4 ? stoi(argv[4]) : (int)max(1u, thread::hardware_concurrency());
+    int max_scenarios = argc > 5 ? stoi(argv[5]) : 1000;
+    bool rebuild = argc > 6 && string(argv[6]) == "1";
+
+    GridMap map = read_grid_map(map_file);
+    ComponentIndex components(map);
+    vector<Scenario> all = read_scenarios(scen_file), scenarios;
+    int n = min<int>(max_scenarios, all.size());
+    for (int i = 0; i < n; ++i) {
+        const Scenario& s = all[(size_t)i * all.size() / n];
+        if (components.connected(s.start, s.goal)) scenarios.push_back(s);
+    }
+    size_t free_cells = 0;
+    for (uint8_t p : map.passable) free_cells += p != 0;
+    cout << "Map " << map.rows << "x" << map.cols << ", " << free_cells << " free cells, " << scenarios.size()
+         << " scenarios\n";
+
+    GoalBounds bounds;
+    string error;
+    Timer timer;
+    if (!rebuild && bounds.load(bounds_file, map, &error)) {
+        cout << "Mapped " << bounds_file << " in " << fixed << setprecision(3) << timer.seconds() * 1000 << " ms\n";
+    } else {
+        if (!rebuild) cout << "No usable table (" << error << "), building\n";
+        if (!bounds.build(map, threads, &error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        cout << "Built in " << fixed << setprecision(2) << bounds.build_seconds << " s with " << threads
+             << " threads (" << bounds.build_seconds * 1e6 / max<size_t>(free_cells, 1) << " us per Dijkstra)\n";
+        if (!bounds.save(bounds_file, &error)) cerr << error << endl;
+        else cout << "Saved " << bounds_file << "\n";
+    }
+    cout << "Table: " << setprecision(1) << bounds.bytes() / 1048576.0 << " MB, "
+         << (double)bounds.bytes() / map.size() << " bytes per cell\n";
+
+    FlatNodeStore store;
+    SearchStats plain, bounded;
+    double plain_s = 0, bounded_s = 0;
+    uint64_t legal = 0, pruned = 0;
+    int wrong = 0;
+    for (const Scenario& s : scenarios) {
+        timer.reset();
+        grid_a_star_search(map, s.start, s.goal, store, FlatNodeStore::heuristic, &plain);
+        plain_s += timer.seconds();
+        float cost = plain.cost;
+
+        timer.reset();
+        bool found = grid_a_star_search(map, s.start, s.goal, store, FlatNodeStore::heuristic, &bounded,
+                                        [&](int cell, int dir) { return bounds.allows(cell, dir, s.goal); });
+        bounded_s += timer.seconds();
+        if (!found || fabs(bounded.cost - cost) > 1e-3f * (1 + cost)) ++wrong;
+    }
+    // Pruning rate over the cells the bounded searches expanded, counted
+    // in a separate pass so it does not weigh on the timings
+    for (const Scenario& s : scenarios) {
+        grid_a_star_search(map, s.start, s.goal, store, FlatNodeStore::heuristic, nullptr, [&](int cell, int dir) {
+            ++legal;
+            bool keep = bounds.allows(cell, dir, s.goal);
+            pruned += !keep;
+            return keep;
+        });
+    }
+
+    cout << setw(10) << "search" << setw(14) << "expansions" << setw(10) << "time_s" << setw(12) << "us/query"
+         << "\n";
+    auto row = [&](const string& name, const SearchStats& stats, double seconds) {
+        cout << setw(10) << name << setw(14) << stats.expansions << setw(10) << setprecision(3) << seconds
+             << setw(12) << setprecision(1) << seconds * 1e6 / max<size_t>(scenarios.size(), 1) << "\n";
+    };
+    row("A*", plain, plain_s);
+    row("bounded", bounded, bounded_s);
+    cout << "Pruned " << setprecision(1) << 100.0 * pruned / max<uint64_t>(legal, 1) << "% of legal moves, "
+         << setprecision(2) << (double)plain.expansions / max<uint64_t>(bounded.expansions, 1)
+         << "x fewer expansions, " << plain_s / max(bounded_s, 1e-9) << "x faster, " << wrong
+         << " cost mismatches\n";
+    return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+#include "goal_bounds.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[8] = {'S', 'A', 'G', 'B', 'N', 'D', '1', '\n'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t rows, cols;
+    uint64_t map_hash;
+    uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 32, "header is 32 bytes");
+
+const GoalBounds::Box EMPTY_BOX = {INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN};
+
+// Dijkstra from one source that remembers, for every cell it reaches, the
+// first move of the path it found; reused across sources
+struct FirstMoveDijkstra {
+    const GridMap& map;
+    vector<float> dist;
+    vector<uint8_t> first;
+    vector<uint32_t> stamp;
+    uint32_t generation = 0;
+    vector<pair<float, int>> heap;
+
+    explicit FirstMoveDijkstra(const GridMap& map)
+        : map(map), dist(map.size()), first(map.size()), stamp(map.size(), 0) {}
+
+    // Grows boxes[d] (8 per source) by every cell whose path starts with d
+    void run(int source, GoalBounds::Box* boxes) {
+        ++generation;
+        auto cmp = greater<pair<float, int>>();
+        heap.clear();
+        stamp[source] = generation;
+        dist[source] = 0.0f;
+        int sr = source / map.cols, sc = source % map.cols;
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!map.can_move(sr, sc, dir)) continue;
+            int nb = source + map.dir_offset(dir);
+            stamp[nb] = generation;
+            dist[nb] = dir_cost(dir);
+            first[nb] = (uint8_t)dir;
+            heap.emplace_back(dist[nb], nb);
+            push_heap(heap.begin(), heap.end(), cmp);
+        }
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), cmp);
+            auto [d, cell] = heap.back();
+            heap.pop_back();
+            if (d > dist[cell]) continue;
+            int r = cell / map.cols, c = cell % map.cols;
+            GoalBounds::Box& box = boxes[first[cell]];
+            box.r0 = min<int16_t>(box.r0, r);
+            box.c0 = min<int16_t>(box.c0, c);
+            box.r1 = max<int16_t>(box.r1, r);
+            box.c1 = max<int16_t>(box.c1, c);
+            for (int dir = 0; dir < 8; ++dir) {
+                if (!map.can_move(r, c, dir)) continue;
+                int nb = cell + map.dir_offset(dir);
+                float nd = d + dir_cost(dir);
+                if (stamp[nb] == generation && dist[nb] <= nd) continue;
+                stamp[nb] = generation;
+                dist[nb] = nd;
+                first[nb] = first[cell];
+                heap.emplace_back(nd, nb);
+                push_heap(heap.begin(), heap.end(), cmp);
+            }
+        }
+    }
+};
+
+} // namespace
+
+uint64_t grid_map_hash(const GridMap& map) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](uint64_t byte) {
+        h ^= byte;
+        h *= 1099511628211ull;
+    };
+    for (int k = 0; k < 4; ++k) mix((uint32_t)map.rows >> (8 * k) & 0xff);
+    for (int k = 0; k < 4; ++k) mix((uint32_t)map.cols >> (8 * k) & 0xff);
+    for (uint8_t p : map.passable) mix(p != 0);
+    return h;
+}
+
+GoalBounds::~GoalBounds() { release(); }
+
+void GoalBounds::release() {
+    if (mapping) munmap(mapping, mapping_size);
+    mapping = nullptr;
+    mapping_size = 0;
+    owned.clear();
+    owned.shrink_to_fit();
+    boxes = nullptr;
+    cells = 0;
+}
+
+bool GoalBounds::build(const GridMap& map, int threads, string* error) {
+    if (map.rows > INT16_MAX || map.cols > INT16_MAX) {
+        if (error) *error = "map too large for int16 goal bounds";
+        return false;
+    }
+    release();
+    Timer timer;
+    rows = map.rows;
+    cols = map.cols;
+    cells = map.size();
+    hash = grid_map_hash(map);
+    owned.assign(cells * 8, EMPTY_BOX);
+
+    // Sources are handed out in small chunks; every source writes only its
+    // own 8 boxes
+    atomic<size_t> next{0};
+    const size_t CHUNK = 64;
+    auto worker = [&]() {
+        FirstMoveDijkstra dijkstra(map);
+        for (size_t begin; (begin = next.fetch_add(CHUNK)) < cells;) {
+            for (size_t cell = begin; cell < min(begin + CHUNK, cells); ++cell) {
+                if (map.passable[cell]) dijkstra.run((int)cell, &owned[cell * 8]);
+            }
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < max(1, threads); ++t) pool.emplace_back(worker);
+    worker();
+    for (thread& t : pool) t.join();
+
+    boxes = owned.data();
+    build_seconds = timer.seconds();
+    return true;
+}
+
+bool GoalBounds::save(const string& path, string* error) const {
+    if (empty()) {
+        if (error) *error = "no goal bounds to save";
+        return false;
+    }
+    FileHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.rows = rows;
+    header.cols = cols;
+    header.map_hash = hash;
+    string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    bool ok = f && fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(boxes, sizeof(Box), cells * 8, f) == cells * 8;
+    if (f && fclose(f) != 0) ok = false;
+    // Written aside and renamed, so a reader never maps a half-written file
+    if (ok && rename(tmp.c_str(), path.c_str()) != 0) ok = false;
+    if (!ok) {
+        if (error) *error = "cannot write " + path + ": " + strerror(errno);
+        remove(tmp.c_str());
+    }
+    return ok;
+}
+
+bool GoalBounds::load(const string& path, const GridMap& map, string* error) {
+    auto fail = [&](const string& why) {
+        if (error) *error = path + ": " + why;
+        return false;
+    };
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail(strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return fail(strerror(errno));
+    }
+    size_t expected = sizeof(FileHeader) + map.size() * 8 * sizeof(Box);
+    if ((size_t)st.st_size != expected) {
+        close(fd);
+        return fail("size does not match the map");
+    }
+    void* data = mmap(nullptr, expected, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return fail(strerror(errno));
+
+    const FileHeader* header = (const FileHeader*)data;
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->rows != (uint32_t)map.rows ||
+        header->cols != (uint32_t)map.cols || header->map_hash != grid_map_hash(map)) {
+        munmap(data, expected);
+        return fail("not goal bounds for this map");
+    }
+    release();
+    mapping = data;
+    mapping_size = expected;
+    rows = map.rows;
+    cols = map.cols;
+    cells = map.size();
+    hash = header->map_hash;
+    boxes = (const Box*)((const char*)data + sizeof(FileHeader));
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef GOAL_BOUNDS_H
+#define GOAL_BOUNDS_H
+
+#include "grid_map.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Goal bounding (Rabin and Sturtevant) for static grids. For every cell and
+// each of its 8 moves the table holds the bounding box of all cells whose
+// optimal path from that cell starts with that move (one Dijkstra per
+// cell). A query to goal can skip every move whose box does not contain the
+// goal: each cell keeps at least the move its own Dijkstra picked, so an
+// optimal path survives the pruning and A* still returns the optimal cost.
+//
+// A box is four int16 (8 bytes), so the table is 64 bytes per cell and maps
+// are limited to 32767 rows and columns. Building is O(cells) Dijkstras and
+// is meant to be done once per map and saved; the saved file is mapped
+// read-only (mmap) and used in place, so loading does not read the table
+// and processes serving the same map share its pages.
+//
+// File layout: 32-byte header (magic "SAGBND1\n", u32 rows, u32 cols, u64
+// hash of the passable bytes, u64 zero), then the boxes cell-major, 8 per
+// cell in direction order, host byte order.
+class GoalBounds {
+public:
+    struct Box {
+        int16_t r0, c0, r1, c1; // inclusive; r0 > r1 for an empty box
+
+        bool contains(const pii& p) const {
+            return p.first >= r0 && p.first <= r1 && p.second >= c0 && p.second <= c1;
+        }
+    };
+
+    GoalBounds() = default;
+    ~GoalBounds();
+    GoalBounds(const GoalBounds&) = delete;
+    GoalBounds& operator=(const GoalBounds&) = delete;
+
+    // One Dijkstra per free cell, spread over `threads` workers. False
+    // (error set) if the map does not fit int16 coordinates.
+    bool build(const GridMap& map, int threads, string* error = nullptr);
+    bool save(const string& path, string* error = nullptr) const;
+    // Maps a saved table; false (error set) if the file is missing, damaged,
+    // or was built for a different map
+    bool load(const string& path, const GridMap& map, string* error = nullptr);
+
+    // Whether move dir out of cell can start an optimal path to goal
+    bool allows(int cell, int dir, const pii& goal) const { return boxes[(size_t)cell * 8 + dir].contains(goal); }
+    const Box& box(int cell, int dir) const { return boxes[(size_t)cell * 8 + dir]; }
+
+    bool empty() const { return boxes == nullptr; }
+    bool mapped() const { return mapping != nullptr; }
+    size_t bytes() const { return cells * 8 * sizeof(Box); }
+    double build_seconds = 0;
+
+private:
+    const Box* boxes = nullptr;
+    size_t cells = 0;
+    int rows = 0, cols = 0;
+    uint64_t hash = 0;
+    vector<Box> owned;          // after build()
+    void* mapping = nullptr;    // after load()
+    size_t mapping_size = 0;
+
+    void release();
+};
+
+// FNV-1a over the map's size and passable bytes; ties a saved table to its map
+uint64_t grid_map_hash(const GridMap& map);
+
+#endif // GOAL_BOUNDS_H
@@ -0,0 +1,124 @@
+#ifndef GRID_ASTAR_H
+#define GRID_ASTAR_H
+
+#include "grid_map.h"
+#include "node_store.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+using namespace std;
+
+struct SearchStats {
+    uint64_t expansions = 0;
+    uint64_t generated = 0;
+    float cost = 0.0f;
+    bool cost_overflow = false; // nodes past Store::MAX_G were dropped
+};
+
+// Walks parent links back from goal to start, then reverses.
+template <class Map, class Store>
+vector<pii> reconstruct_path(const Map& map, const Store& store, int start, int goal) {
+    vector<pii> path = {map.cell(goal)};
+    for (int i = goal; i != start; ) {
+        i = store.parent(i);
+        path.push_back(map.cell(i));
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+// Move filter that keeps every legal move
+struct AllMoves {
+    bool operator()(int /*cell*/, int /*dir*/) const { return true; }
+};
+
+// A* over a flat GridMap with a caller-supplied heuristic(cell, goal) in
+// Store::cost_t units. Map may also be anything with GridMap's read
+// interface (rows, cols, index, can_move, dir_offset, size), such as a
+// pinned GridSnapshot (versioned_grid.h). Per-cell state lives in Store
+// (FlatNodeStore or PackedNodeStore), which is reused across calls. Same
+// neighbor rules as a_star(), minus the moves allow(cell, dir) rejects (e.g.
+// goal bounding, goal_bounds.h). Returns whether goal was reached; the path
+// is left in the store's parent links for reconstruct_path or encode_path
+// (path_codec.h). Nodes whose g would pass Store::MAX_G are not generated.
+template <class Map, class Store, class Heuristic, class MoveFilter = AllMoves>
+bool grid_a_star_search(const Map& map, const pii& start, const pii& goal, Store& store, Heuristic heuristic,
+                        SearchStats* stats = nullptr, MoveFilter allow = MoveFilter()) {
+    using cost_t = typename Store::cost_t;
+    using QueueElement = pair<cost_t, int>;
+    priority_queue<QueueElement, vector<QueueElement>, greater<>> open_list;
+
+    store.reset(map);
+    int s = map.index(start);
+    int t = map.index(goal);
+    store.set(s, 0, s, 0);
+    open_list.emplace(heuristic(start, goal), s);
+
+    uint64_t expansions = 0, generated = 1;
+    bool overflow = false;
+    if (stats) stats->cost_overflow = false; // per call, unlike the counters
+    while (!open_list.empty()) {
+        int current = open_list.top().second;
+        open_list.pop();
+        if (store.closed(current)) continue;
+        store.close(current);
+        ++expansions;
+
+        if (current == t) {
+            if (stats) {
+                stats->expansions += expansions;
+                stats->generated += generated;
+                stats->cost = Store::to_float(store.g(t));
+            }
+            return true;
+        }
+
+        int r = current / map.cols;
+        int c = current % map.cols;
+        cost_t g_cur = store.g(current);
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!map.can_move(r, c, dir) || !allow(current, dir)) continue;
+            int nb = current + map.dir_offset(dir);
+            if (store.closed(nb)) continue;
+
+            cost_t tentative_g = g_cur + Store::step_cost(dir);
+            if (tentative_g > Store::MAX_G || tentative_g < g_cur) { // past the store's cost range
+                overflow = true;
+                continue;
+            }
+            if (!store.generated(nb) || tentative_g < store.g(nb)) {
+                store.set(nb, tentative_g, current, dir);
+                open_list.emplace(tentative_g + heuristic({r + DIR_DR[dir], c + DIR_DC[dir]}, goal), nb);
+                ++generated;
+            }
+        }
+    }
+
+    if (stats) {
+        stats->expansions += expansions;
+        stats->generated += generated;
+        stats->cost_overflow = overflow;
+    }
+    return false; // No path found, or none within Store::MAX_G
+}
+
+// grid_a_star_search with the path as cells; {} when no path exists.
+template <class Map, class Store, class Heuristic>
+vector<pii> grid_a_star_with_heuristic(const Map& map, const pii& start, const pii& goal, Store& store,
+                                       Heuristic heuristic, SearchStats* stats = nullptr) {
+    if (!grid_a_star_search(map, start, goal, store, heuristic, stats)) return {};
+    return reconstruct_path(map, store, map.index(start), map.index(goal));
+}
+
+// Octile-heuristic A*, as a_star().
+template <class Map, class Store>
+vector<pii> grid_a_star(const Map& map, const pii& start, const pii& goal, Store& store,
+                        SearchStats* stats = nullptr) {
+    auto heuristic = [](const pii& a, const pii& b) { return Store::heuristic(a, b); };
+    return grid_a_star_with_heuristic(map, start, goal, store, heuristic, stats);
+}
+
+#endif // GRID_ASTAR_H
@@ -0,0 +1,236 @@
+#ifndef GRID_ASTAR_SIMD_H
+#define GRID_ASTAR_SIMD_H
+
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GRID_SIMD_NAME "avx2"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__FMA__)
+#include <immintrin.h>
+#endif
+#define GRID_SIMD_NAME "sse2"
+#else
+#define GRID_SIMD_NAME "none"
+#endif
+
+using namespace std;
+
+// Batched neighbor scoring for octile A* on a FlatNodeStore. An expansion
+// scores all eight moves at once instead of one successor at a time:
+//   1. move mask: which of the 8 moves are legal (bounds, obstacles, corner
+//      rule), from the 3x3 neighborhood through a 256-entry table
+//   2. gather the 8 neighbors' g and generation/closed flags from the store
+//   3. tentative g, octile h and f for all 8 lanes, and a compare mask of
+//      the moves that improve their target (legal, not closed, and not yet
+//      generated or cheaper than its g)
+// Only the improved moves reach the open list, in direction order, so the
+// search expands exactly what grid_a_star() does.
+//
+// score_moves_simd uses AVX2 (8 lanes, hardware gathers) when compiled with
+// it (SEARCH_NATIVE), else two 4-lane SSE2 halves; score_moves_scalar is the
+// portable fallback. All three evaluate the same float operations in the
+// same order as octile() and FlatNodeStore::step_cost, with h fused exactly
+// when octile_combine() is (under FMA), so their results are bit-identical
+// whatever -ffp-contract says (expand_bench checks this on whole scenario
+// suites). Expansion counts can still differ between FMA and non-FMA builds
+// (e.g. rooms16_256: 586639 vs 586625); costs do not.
+struct ScoredMoves {
+    uint32_t improved = 0; // bit dir: move dir improves its target
+    alignas(32) float g[8];
+    alignas(32) float f[8];
+};
+
+// Legal moves out of (r, c) as a bit per direction
+inline uint32_t move_mask(const GridMap& map, int r, int c) {
+    // Neighborhood pattern (bit d: cell in direction d is free) -> legal moves.
+    // A diagonal needs both orthogonal cells it passes between.
+    static const auto table = [] {
+        array<uint8_t, 256> t{};
+        for (int pattern = 0; pattern < 256; ++pattern) {
+            auto free_at = [&](int dr, int dc) {
+                for (int d = 0; d < 8; ++d)
+                    if (DIR_DR[d] == dr && DIR_DC[d] == dc) return (pattern >> d & 1) != 0;
+                return false;
+            };
+            for (int d = 0; d < 8; ++d) {
+                bool ok = pattern >> d & 1;
+                if (is_diagonal(d)) ok = ok && free_at(0, DIR_DC[d]) && free_at(DIR_DR[d], 0);
+                if (ok) t[pattern] |= 1u << d;
+            }
+        }
+        return t;
+    }();
+    if (r <= 0 || c <= 0 || r >= map.rows - 1 || c >= map.cols - 1) {
+        uint32_t mask = 0;
+        for (int d = 0; d < 8; ++d)
+            if (map.can_move(r, c, d)) mask |= 1u << d;
+        return mask;
+    }
+    const uint8_t* up = &map.passable[(size_t)(r - 1) * map.cols + c - 1];
+    const uint8_t* mid = up + map.cols;
+    const uint8_t* down = mid + map.cols;
+    uint32_t pattern = (up[0] != 0) | (up[1] != 0) << 1 | (up[2] != 0) << 2 | (mid[0] != 0) << 3 |
+                       (mid[2] != 0) << 4 | (down[0] != 0) << 5 | (down[1] != 0) << 6 | (down[2] != 0) << 7;
+    return table[pattern];
+}
+
+inline void score_moves_scalar(const GridMap& map, const FlatNodeStore& store, int cell, float g_cur,
+                               const pii& goal, uint32_t legal, ScoredMoves& out) {
+    int r = cell / map.cols, c = cell % map.cols;
+    uint32_t closed_flags = store.generation << 1 | 1u;
+    out.improved = 0;
+    for (int d = 0; d < 8; ++d) {
+        int nb = cell + map.dir_offset(d);
+        float g = g_cur + FlatNodeStore::step_cost(d);
+        float dr = fabsf((float)(r + DIR_DR[d]) - (float)goal.first);
+        float dc = fabsf((float)(c + DIR_DC[d]) - (float)goal.second);
+        float hi = dr > dc ? dr : dc, lo = dr < dc ? dr : dc;
+        out.g[d] = g;
+        out.f[d] = g + octile_combine(hi, lo);
+        if (!(legal >> d & 1)) continue;
+        const FlatNodeStore::Node& n = store.nodes[nb];
+        if (n.flags == closed_flags) continue;
+        if ((n.flags >> 1) != store.generation || g < n.g) out.improved |= 1u << d;
+    }
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+inline void score_moves_simd(const GridMap& map, const FlatNodeStore& store, int cell, float g_cur,
+                             const pii& goal, uint32_t legal, ScoredMoves& out) {
+    static_assert(sizeof(FlatNodeStore::Node) == 16, "gather assumes 4 words per node, g first, flags last");
+    alignas(32) static const float DR[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+    alignas(32) static const float DC[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    alignas(32) static const float STEP[8] = {SQRT2, 1, SQRT2, 1, 1, SQRT2, 1, SQRT2};
+    int r = cell / map.cols, c = cell % map.cols;
+    // Illegal moves may point outside the grid; they gather from the cell itself
+    alignas(32) int word[8];
+    for (int d = 0; d < 8; ++d) word[d] = (legal >> d & 1 ? cell + map.dir_offset(d) : cell) * 4;
+    const float* base = &store.nodes[0].g;
+    uint32_t gen = store.generation;
+    int closed_flags = (int)(gen << 1 | 1u);
+
+#if defined(__AVX2__)
+    __m256i idx = _mm256_load_si256((const __m256i*)word);
+    __m256 g_nb = _mm256_i32gather_ps(base, idx, 4);
+    __m256i flags = _mm256_i32gather_epi32((const int*)base + 3, idx, 4);
+    __m256 g = _mm256_add_ps(_mm256_set1_ps(g_cur), _mm256_load_ps(STEP));
+    __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 dr = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps((float)r), _mm256_load_ps(DR)),
+                                                     _mm256_set1_ps((float)goal.first)));
+    __m256 dc = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps((float)c), _mm256_load_ps(DC)),
+                                                     _mm256_set1_ps((float)goal.second)));
+    __m256 hi = _mm256_max_ps(dr, dc), lo = _mm256_min_ps(dr, dc);
+#if defined(__FMA__)
+    __m256 h = _mm256_fmadd_ps(_mm256_set1_ps(SQRT2 - 1.0f), lo, hi); // as octile_combine()
+#else
+    __m256 h = _mm256_add_ps(hi, _mm256_mul_ps(_mm256_set1_ps(SQRT2 - 1.0f), lo));
+#endif
+    _mm256_store_ps(out.g, g);
+    _mm256_store_ps(out.f, _mm256_add_ps(g, h));
+    __m256i closed = _mm256_cmpeq_epi32(flags, _mm256_set1_epi32(closed_flags));
+    __m256i generated = _mm256_cmpeq_epi32(_mm256_srli_epi32(flags, 1), _mm256_set1_epi32((int)gen));
+    __m256 cheaper = _mm256_cmp_ps(g, g_nb, _CMP_LT_OQ);
+    __m256 open_or_new = _mm256_or_ps(_mm256_castsi256_ps(_mm256_xor_si256(generated, _mm256_set1_epi32(-1))),
+                                      cheaper);
+    uint32_t improving = _mm256_movemask_ps(_mm256_andnot_ps(_mm256_castsi256_ps(closed), open_or_new));
+#else
+    uint32_t improving = 0;
+    for (int half = 0; half < 8; half += 4) {
+        const int* w = word + half;
+        __m128 g_nb = _mm_setr_ps(base[w[0]], base[w[1]], base[w[2]], base[w[3]]);
+        const int* fl = (const int*)base + 3;
+        __m128i flags = _mm_setr_epi32(fl[w[0]], fl[w[1]], fl[w[2]], fl[w[3]]);
+        __m128 g = _mm_add_ps(_mm_set1_ps(g_cur), _mm_load_ps(STEP + half));
+        __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 dr = _mm_andnot_ps(sign, _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float)r), _mm_load_ps(DR + half)),
+                                                   _mm_set1_ps((float)goal.first)));
+        __m128 dc = _mm_andnot_ps(sign, _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float)c), _mm_load_ps(DC + half)),
+                                                   _mm_set1_ps((float)goal.second)));
+        __m128 hi = _mm_max_ps(dr, dc), lo = _mm_min_ps(dr, dc);
+#if defined(__FMA__)
+        __m128 h = _mm_fmadd_ps(_mm_set1_ps(SQRT2 - 1.0f), lo, hi); // as octile_combine()
+#else
+        __m128 h = _mm_add_ps(hi, _mm_mul_ps(_mm_set1_ps(SQRT2 - 1.0f), lo));
+#endif
+        _mm_store_ps(out.g + half, g);
+        _mm_store_ps(out.f + half, _mm_add_ps(g, h));
+        __m128i closed = _mm_cmpeq_epi32(flags, _mm_set1_epi32(closed_flags));
+        __m128i generated = _mm_cmpeq_epi32(_mm_srli_epi32(flags, 1), _mm_set1_epi32((int)gen));
+        __m128 cheaper = _mm_cmplt_ps(g, g_nb);
+        __m128 open_or_new = _mm_or_ps(_mm_castsi128_ps(_mm_xor_si128(generated, _mm_set1_epi32(-1))), cheaper);
+        improving |= (uint32_t)_mm_movemask_ps(_mm_andnot_ps(_mm_castsi128_ps(closed), open_or_new)) << half;
+    }
+#endif
+    out.improved = improving & legal;
+}
+#else
+inline void score_moves_simd(const GridMap& map, const FlatNodeStore& store, int cell, float g_cur,
+                             const pii& goal, uint32_t legal, ScoredMoves& out) {
+    score_moves_scalar(map, store, cell, g_cur, goal, legal, out);
+}
+#endif
+
+// grid_a_star_search(map, start, goal, FlatNodeStore, octile) with batched
+// neighbor scoring; SIMD = false runs the scalar kernel. Same expansions,
+// costs and parent links as the one-successor-at-a-time loop.
+template <bool SIMD>
+bool grid_a_star_batched(const GridMap& map, const pii& start, const pii& goal, FlatNodeStore& store,
+                         SearchStats* stats = nullptr) {
+    using QueueElement = pair<float, int>;
+    priority_queue<QueueElement, vector<QueueElement>, greater<>> open_list;
+
+    store.reset(map);
+    int s = map.index(start);
+    int t = map.index(goal);
+    store.set(s, 0, s, 0);
+    open_list.emplace(octile(start, goal), s);
+
+    ScoredMoves moves;
+    uint64_t expansions = 0, generated = 1;
+    while (!open_list.empty()) {
+        int current = open_list.top().second;
+        open_list.pop();
+        if (store.closed(current)) continue;
+        store.close(current);
+        ++expansions;
+
+        if (current == t) {
+            if (stats) {
+                stats->expansions += expansions;
+                stats->generated += generated;
+                stats->cost = store.g(t);
+            }
+            return true;
+        }
+
+        uint32_t legal = move_mask(map, current / map.cols, current % map.cols);
+        if (SIMD) score_moves_simd(map, store, current, store.g(current), goal, legal, moves);
+        else score_moves_scalar(map, store, current, store.g(current), goal, legal, moves);
+        for (uint32_t bits = moves.improved; bits; bits &= bits - 1) {
+            int dir = __builtin_ctz(bits);
+            int nb = current + map.dir_offset(dir);
+            store.set(nb, moves.g[dir], current, dir);
+            open_list.emplace(moves.f[dir], nb);
+            ++generated;
+        }
+    }
+
+    if (stats) {
+        stats->expansions += expansions;
+        stats->generated += generated;
+    }
+    return false;
+}
+
+#endif // GRID_ASTAR_SIMD_H
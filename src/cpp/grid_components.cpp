@@ -0,0 +1,206 @@
+#include "grid_components.h"
+#include <algorithm>
+
+// 4-neighbourhood in ring order N, E, S, W; RING_CORNER[k] lies between
+// side k and side k + 1
+static const int RING_DR[4] = {-1, 0, 1, 0};
+static const int RING_DC[4] = {0, 1, 0, -1};
+static const int CORNER_DR[4] = {-1, 1, 1, -1};
+static const int CORNER_DC[4] = {1, 1, -1, -1};
+
+void ComponentIndex::build(const GridMap& map) {
+    rows = map.rows;
+    cols = map.cols;
+    labels.assign(map.size(), BLOCKED);
+    sizes.clear();
+    free_labels.clear();
+    live = 0;
+
+    // Pass 1: labels[i] is a union-find parent. Roots are linked under the
+    // smaller root, so every parent index is below its child's.
+    auto find = [&](int x) {
+        while (labels[x] != x) x = labels[x] = labels[labels[x]];
+        return x;
+    };
+    auto unite = [&](int a, int b) {
+        a = find(a), b = find(b);
+        if (a != b) labels[max(a, b)] = min(a, b);
+    };
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            int i = map.index(r, c);
+            if (!map.passable[i]) continue;
+            labels[i] = i;
+            if (c > 0 && map.passable[i - 1]) unite(i, i - 1);
+            if (r > 0 && map.passable[i - cols]) unite(i, i - cols);
+        }
+    }
+    // Pass 2: parents come first, so one forward scan turns parent links
+    // into final labels
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (labels[i] == BLOCKED) continue;
+        labels[i] = labels[i] == (int)i ? new_label(0) : labels[labels[i]];
+        ++sizes[labels[i]];
+    }
+}
+
+int ComponentIndex::new_label(uint32_t size) {
+    ++live;
+    if (free_labels.empty()) {
+        sizes.push_back(size);
+        return sizes.size() - 1;
+    }
+    int label = free_labels.back();
+    free_labels.pop_back();
+    sizes[label] = size;
+    return label;
+}
+
+void ComponentIndex::release_label(int label) {
+    sizes[label] = 0;
+    free_labels.push_back(label);
+    --live;
+}
+
+uint32_t ComponentIndex::relabel(int cell, int to) {
+    int from = labels[cell];
+    uint32_t count = 1;
+    labels[cell] = to;
+    stack.assign(1, cell);
+    while (!stack.empty()) {
+        int i = stack.back();
+        stack.pop_back();
+        int r = i / cols, c = i % cols;
+        for (int k = 0; k < 4; ++k) {
+            int nr = r + RING_DR[k], nc = c + RING_DC[k];
+            if (nr < 0 || nr >= rows || nc < 0 || nc >= cols) continue;
+            int nb = nr * cols + nc;
+            if (labels[nb] != from) continue;
+            labels[nb] = to;
+            ++count;
+            stack.push_back(nb);
+        }
+    }
+    return count;
+}
+
+void ComponentIndex::open_cell(GridMap& map, int r, int c) {
+    int i = map.index(r, c);
+    if (map.passable[i]) return;
+    map.passable[i] = 1;
+
+    int neighbours[4], n = 0, largest = BLOCKED;
+    for (int k = 0; k < 4; ++k) {
+        if (!map.is_passable(r + RING_DR[k], c + RING_DC[k])) continue;
+        int nb = map.index(r + RING_DR[k], c + RING_DC[k]);
+        neighbours[n++] = nb;
+        if (largest == BLOCKED || sizes[labels[nb]] > sizes[largest]) largest = labels[nb];
+    }
+    if (n == 0) {
+        labels[i] = new_label(1);
+        return;
+    }
+    labels[i] = largest;
+    ++sizes[largest];
+    // Fold the smaller components into the largest
+    for (int k = 0; k < n; ++k) {
+        int label = labels[neighbours[k]];
+        if (label == largest) continue;
+        sizes[largest] += relabel(neighbours[k], largest);
+        release_label(label);
+    }
+}
+
+void ComponentIndex::block_cell(GridMap& map, int r, int c) {
+    int i = map.index(r, c);
+    if (!map.passable[i]) return;
+    int label = labels[i];
+    map.passable[i] = 0;
+    labels[i] = BLOCKED;
+    if (--sizes[label] == 0) {
+        release_label(label);
+        return;
+    }
+
+    // Group the free sides that stay joined through a free corner cell
+    bool side_free[4];
+    int side_cell[4], group[4];
+    for (int k = 0; k < 4; ++k) {
+        side_free[k] = map.is_passable(r + RING_DR[k], c + RING_DC[k]);
+        side_cell[k] = side_free[k] ? map.index(r + RING_DR[k], c + RING_DC[k]) : -1;
+        group[k] = k;
+    }
+    auto find = [&](int k) {
+        while (group[k] != k) k = group[k];
+        return k;
+    };
+    auto unite = [&](int a, int b) { group[max(find(a), find(b))] = min(find(a), find(b)); };
+    for (int k = 0; k < 4; ++k) {
+        int next = (k + 1) % 4;
+        if (side_free[k] && side_free[next] && map.is_passable(r + CORNER_DR[k], c + CORNER_DC[k])) unite(k, next);
+    }
+    auto open_groups = [&](const vector<int>* queue, const size_t* head) {
+        bool open[4] = {false, false, false, false};
+        for (int k = 0; k < 4; ++k)
+            if (side_free[k] && head[k] < queue[k].size()) open[find(k)] = true;
+        return (int)count(open, open + 4, true);
+    };
+    int groups = 0;
+    for (int k = 0; k < 4; ++k) groups += side_free[k] && find(k) == k;
+    if (groups <= 1) return;
+
+    // One BFS per side in lockstep; sides whose searches meet are merged.
+    // Stops once at most one group is still growing: every other group has
+    // then been enumerated completely and is a component of its own.
+    if (mark.size() != labels.size()) mark.assign(labels.size(), 0);
+    vector<int> queue[4];
+    size_t head[4] = {0, 0, 0, 0};
+    for (int k = 0; k < 4; ++k) {
+        if (!side_free[k]) continue;
+        queue[k].push_back(side_cell[k]);
+        mark[side_cell[k]] = k + 1;
+    }
+    while (open_groups(queue, head) > 1) {
+        for (int k = 0; k < 4; ++k) {
+            if (!side_free[k] || head[k] == queue[k].size()) continue;
+            int cell = queue[k][head[k]++];
+            int cr = cell / cols, cc = cell % cols;
+            for (int d = 0; d < 4; ++d) {
+                if (!map.is_passable(cr + RING_DR[d], cc + RING_DC[d])) continue;
+                int nb = map.index(cr + RING_DR[d], cc + RING_DC[d]);
+                if (mark[nb] == 0) {
+                    mark[nb] = k + 1;
+                    queue[k].push_back(nb);
+                } else if (find(mark[nb] - 1) != find(k)) {
+                    unite(mark[nb] - 1, k);
+                }
+            }
+        }
+    }
+
+    // Finished groups split off; the one still growing (or the first, if
+    // all finished together) keeps the old label
+    int keep = -1;
+    for (int k = 0; k < 4; ++k) {
+        if (side_free[k] && head[k] < queue[k].size()) keep = find(k);
+    }
+    for (int k = 0; k < 4 && keep < 0; ++k) {
+        if (side_free[k]) keep = find(k);
+    }
+    for (int g = 0; g < 4; ++g) {
+        if (!side_free[g] || find(g) != g || g == keep) continue;
+        uint32_t count = 0;
+        for (int k = 0; k < 4; ++k) {
+            if (side_free[k] && find(k) == g) count += queue[k].size();
+        }
+        int split = new_label(count);
+        sizes[label] -= count;
+        for (int k = 0; k < 4; ++k) {
+            if (!side_free[k] || find(k) != g) continue;
+            for (int cell : queue[k]) labels[cell] = split;
+        }
+    }
+    for (int k = 0; k < 4; ++k) {
+        for (int cell : queue[k]) mark[cell] = 0;
+    }
+}
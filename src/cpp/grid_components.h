@@ -0,0 +1,71 @@
+#ifndef GRID_COMPONENTS_H
+#define GRID_COMPONENTS_H
+
+#include "grid_map.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Connected-component labels for a GridMap, so a query whose start and goal
+// lie in different components is answered without searching. Under the
+// can_move rules a diagonal step needs both orthogonal cells free, so
+// 8-connected reachability equals 4-connected reachability and the labels
+// are 4-connected components.
+//
+// build() is a two-pass union-find over the grid (union with the left and
+// upper neighbour, then flatten to one label per cell). open_cell() and
+// block_cell() keep the labels exact as the map changes: opening merges the
+// neighbouring components (the smaller ones are relabelled into the
+// largest), blocking first checks whether the free neighbours stay joined
+// around the cell and otherwise runs one BFS per side in lockstep, stopping
+// as soon as all but one side is exhausted, so only the parts that actually
+// split off are relabelled.
+class ComponentIndex {
+public:
+    static constexpr int BLOCKED = -1;
+
+    ComponentIndex() = default;
+    explicit ComponentIndex(const GridMap& map) { build(map); }
+
+    void build(const GridMap& map);
+
+    // Label of a cell, BLOCKED for obstacles
+    int label(int cell) const { return labels[cell]; }
+    int label(int r, int c) const { return labels[(size_t)r * cols + c]; }
+
+    // True if both cells are in bounds, free and in the same component
+    bool connected(const pii& a, const pii& b) const {
+        if (a.first < 0 || a.first >= rows || a.second < 0 || a.second >= cols) return false;
+        if (b.first < 0 || b.first >= rows || b.second < 0 || b.second >= cols) return false;
+        int la = label(a.first, a.second);
+        return la != BLOCKED && la == label(b.first, b.second);
+    }
+
+    int components() const { return live; }
+    // Cells in component `label`
+    uint32_t component_size(int label) const { return sizes[label]; }
+    size_t bytes() const { return labels.size() * sizeof(int32_t) + sizes.size() * sizeof(uint32_t); }
+
+    // Set map.passable for (r, c) and update the labels to match. No-op if
+    // the cell already has that state.
+    void open_cell(GridMap& map, int r, int c);
+    void block_cell(GridMap& map, int r, int c);
+
+private:
+    int new_label(uint32_t size);
+    void release_label(int label);
+    // Relabels every cell 4-connected to `cell` as `to`; returns the count
+    uint32_t relabel(int cell, int to);
+
+    int rows = 0;
+    int cols = 0;
+    int live = 0;
+    vector<int32_t> labels;
+    vector<uint32_t> sizes;      // by label, 0 = unused
+    vector<int> free_labels;     // unused label ids for reuse
+    vector<int> stack;           // scratch for relabel
+    vector<uint8_t> mark;        // scratch for block_cell: 1 + side that reached a cell
+};
+
+#endif // GRID_COMPONENTS_H
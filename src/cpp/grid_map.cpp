@@ -0,0 +1,111 @@
+#include "grid_map.h"
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+bool is_obstacle_char(char ch) {
+    return ch == '@' || ch == 'T' || ch == 'W';
+}
+
+bool load_grid_map(const string& filename, GridMap& map, string* error) {
+    auto fail = [&](const string& message) {
+        if (error) *error = message + ": " + filename;
+        return false;
+    };
+    ifstream fin(filename);
+    if (!fin.is_open()) return fail("cannot open map file");
+    map = GridMap();
+    string line;
+    bool header_done = false;
+    while (getline(fin, line)) {
+        string key;
+        long long value = 0;
+        istringstream fields(line);
+        fields >> key;
+        if (key == "map") {
+            header_done = true;
+            break;
+        }
+        if (key != "height" && key != "width") continue;
+        if (!(fields >> value) || value <= 0 || value > INT_MAX) return fail("bad " + key + " in map file");
+        (key == "height" ? map.rows : map.cols) = (int)value;
+    }
+    if (!header_done || map.rows <= 0 || map.cols <= 0) return fail("no map header in map file");
+    // Cell indices are ints
+    if ((long long)map.rows * map.cols > INT_MAX) return fail("map too large in map file");
+    map.passable.assign(map.size(), 0);
+    for (int r = 0; r < map.rows && getline(fin, line); ++r) {
+        int n = min((int)line.size(), map.cols);
+        uint8_t* row = &map.passable[(size_t)r * map.cols];
+        for (int c = 0; c < n; ++c) {
+            row[c] = !is_obstacle_char(line[c]);
+        }
+    }
+    return true;
+}
+
+GridMap read_grid_map(const string& filename) {
+    GridMap map;
+    string error;
+    if (!load_grid_map(filename, map, &error)) {
+        cerr << "Failed to read map: " << error << endl;
+        exit(1);
+    }
+    return map;
+}
+
+vector<Scenario> read_scenarios(const string& filename) {
+    ifstream fin(filename);
+    if (!fin.is_open()) {
+        cerr << "Failed to open scenario file: " << filename << endl;
+        exit(1);
+    }
+    string line;
+    getline(fin, line); // skip version line
+
+    vector<Scenario> scenarios;
+    while (getline(fin, line)) {
+        istringstream iss(line);
+        int bucket, width, height, sx, sy, gx, gy;
+        string map_name;
+        double cost;
+        if (!(iss >> bucket >> map_name >> width >> height >> sx >> sy >> gx >> gy >> cost)) continue;
+        scenarios.push_back({{sy, sx}, {gy, gx}, cost});  // note: row, col order!
+    }
+    return scenarios;
+}
+
+bool write_grid_map(const GridMap& map, const string& filename) {
+    ofstream fout(filename);
+    fout << "type octile\nheight " << map.rows << "\nwidth " << map.cols << "\nmap\n";
+    string line(map.cols + 1, '\n');
+    for (int r = 0; r < map.rows; ++r) {
+        const uint8_t* row = &map.passable[(size_t)r * map.cols];
+        for (int c = 0; c < map.cols; ++c) line[c] = row[c] ? '.' : '@';
+        fout.write(line.data(), line.size());
+    }
+    if (!fout) {
+        cerr << "Failed to write map file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+bool write_scenarios(const vector<Scenario>& scenarios, const GridMap& map, const string& map_name,
+                     const string& filename) {
+    ofstream fout(filename);
+    fout << "version 1\n" << fixed << setprecision(8);
+    for (const Scenario& s : scenarios) {
+        fout << (int)floor(s.cost / 4) << "\t" << map_name << "\t" << map.cols << "\t" << map.rows << "\t"
+             << s.start.second << "\t" << s.start.first << "\t" << s.goal.second << "\t" << s.goal.first << "\t"
+             << s.cost << "\n";
+    }
+    if (!fout) {
+        cerr << "Failed to write scenario file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
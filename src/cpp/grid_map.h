@@ -0,0 +1,102 @@
+#ifndef GRID_MAP_H
+#define GRID_MAP_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+using pii = pair<int, int>;
+
+// 8-connected move directions, same order as get_neighbors_8.
+// A direction fits in 3 bits; OPPOSITE_DIR[d] undoes move d.
+const int DIR_DR[8] = {-1,-1,-1, 0, 0, 1, 1, 1};
+const int DIR_DC[8] = {-1, 0, 1,-1, 1,-1, 0, 1};
+const int OPPOSITE_DIR[8] = {7, 6, 5, 4, 3, 2, 1, 0};
+const float SQRT2 = 1.41421356f;
+
+inline bool is_diagonal(int dir) {
+    return DIR_DR[dir] != 0 && DIR_DC[dir] != 0;
+}
+
+inline float dir_cost(int dir) {
+    return is_diagonal(dir) ? SQRT2 : 1.0f;
+}
+
+// Flat row-major grid: one byte per cell, 1 = traversable.
+struct GridMap {
+    int rows = 0;
+    int cols = 0;
+    vector<uint8_t> passable;
+
+    int index(int r, int c) const { return r * cols + c; }
+    int index(const pii& p) const { return p.first * cols + p.second; }
+    pii cell(int idx) const { return {idx / cols, idx % cols}; }
+    size_t size() const { return (size_t)rows * cols; }
+
+    bool in_bounds(int r, int c) const {
+        return r >= 0 && r < rows && c >= 0 && c < cols;
+    }
+
+    bool is_passable(int r, int c) const {
+        return in_bounds(r, c) && passable[(size_t)r * cols + c];
+    }
+
+    // Same rules as get_neighbors_8: target must be free and a diagonal
+    // move is dropped if either orthogonal side is blocked.
+    bool can_move(int r, int c, int dir) const {
+        int nr = r + DIR_DR[dir];
+        int nc = c + DIR_DC[dir];
+        if (!is_passable(nr, nc)) return false;
+        if (is_diagonal(dir) && (!is_passable(r, nc) || !is_passable(nr, c))) return false;
+        return true;
+    }
+
+    // Offset of move dir in flat index space.
+    int dir_offset(int dir) const { return DIR_DR[dir] * cols + DIR_DC[dir]; }
+};
+
+struct Scenario {
+    pii start;
+    pii goal;
+    double cost;
+};
+
+// hi + (sqrt(2) - 1) * lo, the octile distance from the larger and smaller
+// axis difference. It is fused explicitly when the target has FMA, so the
+// rounding does not depend on -ffp-contract; the SIMD kernels in
+// grid_astar_simd.h make the same choice. Builds with and without FMA can
+// differ in the last bit of h, so their A* runs may break ties differently.
+inline float octile_combine(float hi, float lo) {
+#if defined(__FMA__)
+    return fmaf(SQRT2 - 1.0f, lo, hi);
+#else
+    return hi + (SQRT2 - 1.0f) * lo;
+#endif
+}
+
+// Octile distance for 8-connected grids with unit/sqrt(2) costs.
+inline float octile(const pii& a, const pii& b) {
+    int dr = abs(a.first - b.first);
+    int dc = abs(a.second - b.second);
+    return octile_combine(dr > dc ? dr : dc, dr < dc ? dr : dc);
+}
+
+bool is_obstacle_char(char ch);
+// Reads a MovingAI .map file; false (with error set) if it cannot be opened
+// or its header is missing or malformed
+bool load_grid_map(const string& filename, GridMap& map, string* error = nullptr);
+// Same, but reports the error and exits: for the command-line drivers
+GridMap read_grid_map(const string& filename);
+vector<Scenario> read_scenarios(const string& filename);
+
+// Writers for the same formats ('.' free, '@' blocked; MovingAI scenario
+// lines with bucket = floor(cost / 4)). Return false on I/O error.
+bool write_grid_map(const GridMap& map, const string& filename);
+bool write_scenarios(const vector<Scenario>& scenarios, const GridMap& map, const string& map_name,
+                     const string& filename);
+
+#endif // GRID_MAP_H
@@ -0,0 +1,105 @@
+// HDA* against serial A* on the hardest queries of a scenario file: wall
+// time, speedup, search overhead (expansions relative to A*), messages per
+// expansion and load balance for each thread count and hash. Every HDA*
+// cost is checked against the serial optimum.
+// Usage: hda_bench [map_file] [scen_file] [threads] [zobrist|abstract|both] [queries] [batch] [block]
+// threads: comma-separated; queries: how many of the longest scenarios.
+// Speedup needs as many free cores as threads.
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "hda_star.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    string scen_file = argc > 2 ? argv[2] : "AcrosstheCape.map.scen";
+    string thread_list = argc > 3 ? argv[3] : "1,2,4,8";
+    string hashes = argc > 4 ? argv[4] : "both";
+    int queries = argc > 5 ? stoi(argv[5]) : 5;
+    size_t batch = argc > 6 ? stoul(argv[6]) : 64;
+    int block = argc > 7 ? stoi(argv[7]) : 8;
+
+    GridMap map = read_grid_map(map_file);
+    ComponentIndex components(map);
+    vector<Scenario> scenarios;
+    for (const Scenario& s : read_scenarios(scen_file))
+        if (components.connected(s.start, s.goal)) scenarios.push_back(s);
+    sort(scenarios.begin(), scenarios.end(), [](const Scenario& a, const Scenario& b) { return a.cost > b.cost; });
+    scenarios.resize(min<size_t>(scenarios.size(), queries));
+    if (scenarios.empty()) {
+        cerr << "No solvable scenarios in " << scen_file << endl;
+        return 1;
+    }
+    cout << "Map " << map.rows << "x" << map.cols << ", " << scenarios.size() << " longest scenarios, "
+         << thread::hardware_concurrency() << " hardware threads\n";
+
+    FlatNodeStore store;
+    vector<float> optimal;
+    double serial_s = 0;
+    uint64_t serial_expansions = 0;
+    for (const Scenario& s : scenarios) {
+        SearchStats stats;
+        Timer timer;
+        grid_a_star(map, s.start, s.goal, store, &stats);
+        serial_s += timer.seconds();
+        serial_expansions += stats.expansions;
+        optimal.push_back(stats.cost);
+    }
+    cout << "Serial A*: " << fixed << setprecision(3) << serial_s << " s, " << serial_expansions << " expansions\n\n";
+
+    cout << setw(9) << "hash" << setw(8) << "threads" << setw(10) << "time_s" << setw(9) << "speedup" << setw(10)
+         << "overhead" << setw(10) << "msg/exp" << setw(11) << "max/mean" << setw(9) << "wrong" << "\n";
+    for (HdaHash hash : {HdaHash::Zobrist, HdaHash::Abstract}) {
+        string hash_name = hash == HdaHash::Zobrist ? "zobrist" : "abstract";
+        if (hashes != "both" && hashes != hash_name) continue;
+        stringstream list(thread_list);
+        for (string item; getline(list, item, ',');) {
+            HdaOptions options;
+            options.threads = stoi(item);
+            options.hash = hash;
+            options.batch = batch;
+            options.block = block;
+            HdaStar hda(map, options);
+
+            HdaStats stats;
+            double seconds = 0;
+            int wrong = 0;
+            for (size_t i = 0; i < scenarios.size(); ++i) {
+                HdaStats one;
+                Timer timer;
+                vector<pii> path = hda.search(scenarios[i].start, scenarios[i].goal, &one);
+                seconds += timer.seconds();
+                // Optimal cost, and a path of that cost
+                double walked = 0;
+                for (size_t k = 1; k < path.size(); ++k) walked += octile(path[k - 1], path[k]);
+                if (path.empty() || fabs(one.cost - optimal[i]) > 1e-3f * (1 + optimal[i]) ||
+                    fabs(walked - optimal[i]) > 1e-3 * (1 + optimal[i]))
+                    ++wrong;
+                stats.expansions += one.expansions;
+                stats.sent += one.sent;
+                stats.thread_expansions.resize(one.thread_expansions.size());
+                for (size_t t = 0; t < one.thread_expansions.size(); ++t)
+                    stats.thread_expansions[t] += one.thread_expansions[t];
+            }
+            uint64_t most = *max_element(stats.thread_expansions.begin(), stats.thread_expansions.end());
+            double mean = (double)stats.expansions / options.threads;
+            cout << setw(9) << hash_name << setw(8) << options.threads << setw(10) << setprecision(3) << seconds
+                 << setw(9) << setprecision(2) << serial_s / seconds << setw(10) << setprecision(3)
+                 << (double)stats.expansions / max<uint64_t>(serial_expansions, 1) << setw(10)
+                 << (double)stats.sent / max<uint64_t>(stats.expansions, 1) << setw(11) << setprecision(2)
+                 << most / max(mean, 1.0) << setw(9) << wrong << "\n";
+        }
+    }
+    return 0;
+}
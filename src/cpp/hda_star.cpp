@@ -0,0 +1,208 @@
+#include "hda_star.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+
+HdaStar::HdaStar(const GridMap& map, const HdaOptions& options) : map(map), options(options) {
+    this->options.threads = max(1, options.threads);
+    this->options.block = max(1, options.block);
+    this->options.batch = max<size_t>(1, options.batch);
+    mt19937_64 rng(options.seed);
+    zobrist_row.resize(map.rows);
+    zobrist_col.resize(map.cols);
+    for (uint32_t& z : zobrist_row) z = (uint32_t)rng();
+    for (uint32_t& z : zobrist_col) z = (uint32_t)rng();
+}
+
+int HdaStar::owner(int cell) const {
+    int r = cell / map.cols, c = cell % map.cols;
+    uint32_t h;
+    if (options.hash == HdaHash::Zobrist) {
+        h = zobrist_row[r] ^ zobrist_col[c];
+    } else {
+        uint32_t block = (uint32_t)(r / options.block) * 0x9E3779B1u + (uint32_t)(c / options.block);
+        h = block * 0x85EBCA6Bu;
+        h ^= h >> 16;
+    }
+    return (int)(h % (uint32_t)options.threads);
+}
+
+size_t HdaStar::bytes() const {
+    return g.capacity() * sizeof(float) + parent.capacity() * sizeof(int) + stamp.capacity() * sizeof(uint32_t) +
+           (zobrist_row.capacity() + zobrist_col.capacity()) * sizeof(uint32_t);
+}
+
+vector<pii> HdaStar::search(const pii& start, const pii& goal, HdaStats* stats) {
+    if (!map.is_passable(start.first, start.second) || !map.is_passable(goal.first, goal.second)) return {};
+    if (start == goal) {
+        if (stats) stats->cost = 0.0f;
+        return {start};
+    }
+    if (g.size() != map.size()) {
+        g.assign(map.size(), 0.0f);
+        parent.assign(map.size(), 0);
+        stamp.assign(map.size(), 0);
+        generation = 0;
+    }
+    if (++generation == 0) {
+        fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+
+    int threads = options.threads;
+    inboxes = vector<Inbox>(threads);
+    start_cell = map.index(start);
+    goal_cell = map.index(goal);
+    incumbent = INFINITY;
+    in_flight = 0;
+    sent_total = 0;
+    busy = threads;
+    done = false;
+
+    vector<HdaStats> per_thread(threads);
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(&HdaStar::worker, this, t, &per_thread[t]);
+    for (thread& t : pool) t.join();
+
+    if (stats) {
+        stats->thread_expansions.assign(threads, 0);
+        for (int t = 0; t < threads; ++t) {
+            stats->expansions += per_thread[t].expansions;
+            stats->generated += per_thread[t].generated;
+            stats->sent += per_thread[t].sent;
+            stats->batches += per_thread[t].batches;
+            stats->thread_expansions[t] = per_thread[t].expansions;
+        }
+    }
+    float cost = incumbent;
+    if (isinf(cost)) return {};
+    if (stats) stats->cost = cost;
+
+    vector<pii> path = {goal};
+    for (int i = goal_cell; i != start_cell;) {
+        i = parent[i];
+        path.push_back(map.cell(i));
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+void HdaStar::worker(int id, HdaStats* stats) {
+    using QueueElement = pair<float, int>;
+    vector<QueueElement> open_list; // binary heap, smallest f first
+    auto cmp = greater<QueueElement>();
+    vector<vector<Message>> outbox(options.threads);
+    Inbox& inbox = inboxes[id];
+    const pii goal = map.cell(goal_cell);
+    bool is_busy = true;
+    size_t since_flush = 0;
+
+    // Only called by the owner of cell
+    auto relax = [&](int cell, int from, float g_new) {
+        if (stamp[cell] == generation && g[cell] <= g_new) return;
+        float f = g_new + octile(map.cell(cell), goal);
+        if (f >= incumbent.load(memory_order_relaxed)) return;
+        stamp[cell] = generation;
+        g[cell] = g_new;
+        parent[cell] = from;
+        if (cell == goal_cell) {
+            incumbent = g_new; // the goal is never expanded
+            return;
+        }
+        open_list.emplace_back(f, cell);
+        push_heap(open_list.begin(), open_list.end(), cmp);
+        ++stats->generated;
+    };
+
+    auto send = [&](int to) {
+        vector<Message>& items = outbox[to];
+        if (items.empty()) return;
+        Batch* batch = new Batch;
+        batch->items.swap(items);
+        items.reserve(options.batch);
+        // Counted before it becomes visible, so a termination check never
+        // misses a batch on its way
+        in_flight.fetch_add(batch->items.size());
+        sent_total.fetch_add(batch->items.size());
+        stats->sent += batch->items.size();
+        ++stats->batches;
+        Inbox& target = inboxes[to];
+        batch->next = target.head.load(memory_order_relaxed);
+        while (!target.head.compare_exchange_weak(batch->next, batch, memory_order_release, memory_order_relaxed)) {
+        }
+    };
+    auto flush_all = [&]() {
+        for (int t = 0; t < options.threads; ++t) send(t);
+        since_flush = 0;
+    };
+
+    if (owner(start_cell) == id) relax(start_cell, start_cell, 0.0f);
+
+    while (!done.load(memory_order_relaxed)) {
+        if (inbox.head.load(memory_order_relaxed)) {
+            if (!is_busy) {
+                busy.fetch_add(1);
+                is_busy = true;
+            }
+            Batch* batch = inbox.head.exchange(nullptr, memory_order_acquire);
+            int64_t taken = 0;
+            while (batch) {
+                for (const Message& m : batch->items) relax(m.cell, m.parent, m.g);
+                taken += batch->items.size();
+                Batch* next = batch->next;
+                delete batch;
+                batch = next;
+            }
+            in_flight.fetch_sub(taken);
+        }
+
+        float bound = incumbent.load(memory_order_relaxed);
+        if (!open_list.empty() && open_list.front().first < bound) {
+            pop_heap(open_list.begin(), open_list.end(), cmp);
+            auto [f, cell] = open_list.back();
+            open_list.pop_back();
+            float g_cur = g[cell];
+            // Stale entry: a cheaper path to cell was queued after this one
+            // (same expression as in relax, so an unchanged g gives the same f)
+            if (f > g_cur + octile(map.cell(cell), goal)) continue;
+            ++stats->expansions;
+
+            int r = cell / map.cols, c = cell % map.cols;
+            for (int dir = 0; dir < 8; ++dir) {
+                if (!map.can_move(r, c, dir)) continue;
+                int nb = cell + map.dir_offset(dir);
+                float g_nb = g_cur + dir_cost(dir);
+                int to = owner(nb);
+                if (to == id) {
+                    relax(nb, cell, g_nb);
+                } else if (g_nb + octile({r + DIR_DR[dir], c + DIR_DC[dir]}, goal) < bound) {
+                    outbox[to].push_back(Message{nb, cell, g_nb});
+                    if (outbox[to].size() >= options.batch) send(to);
+                }
+            }
+            // Partial batches go out regularly so other threads are not starved
+            if (++since_flush >= options.batch) flush_all();
+            continue;
+        }
+
+        // Nothing below the incumbent here: hand over what is buffered, then idle
+        flush_all();
+        if (inbox.head.load(memory_order_relaxed)) continue;
+        if (is_busy) {
+            busy.fetch_sub(1);
+            is_busy = false;
+        }
+        // Done when no node was in flight, every thread was idle after that,
+        // and nothing was sent in between; idle threads only wake up on a
+        // message, so nothing can happen afterwards
+        uint64_t sent_before = sent_total.load();
+        if (in_flight.load() == 0 && busy.load() == 0 && sent_total.load() == sent_before) {
+            done = true;
+            break;
+        }
+        this_thread::yield();
+    }
+    for (vector<Message>& items : outbox) items.clear();
+}
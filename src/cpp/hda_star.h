@@ -0,0 +1,95 @@
+#ifndef HDA_STAR_H
+#define HDA_STAR_H
+
+#include "grid_map.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Hash-distributed A* (HDA*, Kishimoto, Fukunaga and Botea) for one large
+// query on several threads. Every cell is owned by one thread, chosen by a
+// hash of the cell; only the owner keeps its g-value and parent and puts it
+// on its own open list. Successors owned by another thread are buffered per
+// destination and handed over in batches through that thread's lock-free
+// inbox (a multi-producer, single-consumer list of batches).
+//
+// Expansion order is no longer global, so a cell can be expanded again when
+// a cheaper path to it arrives later. The goal's owner keeps the best cost
+// seen so far (the incumbent); nodes with f >= incumbent are dropped. The
+// search ends when every thread has nothing below the incumbent and no batch
+// is in flight, which makes the incumbent optimal with the (consistent)
+// octile heuristic. Same neighbor rules and costs as grid_a_star().
+enum class HdaHash {
+    Zobrist,  // xor of random words per row and column: even load, most successors leave the thread
+    Abstract, // hash of the BLOCK x BLOCK block: fewer messages, coarser load balance
+};
+
+struct HdaOptions {
+    int threads = 4;
+    HdaHash hash = HdaHash::Zobrist;
+    int block = 8;        // side of an abstract block, HdaHash::Abstract only
+    size_t batch = 64;    // nodes per message batch
+    uint64_t seed = 1;    // Zobrist tables
+};
+
+struct HdaStats {
+    uint64_t expansions = 0;   // re-expansions included
+    uint64_t generated = 0;
+    uint64_t sent = 0;         // nodes sent to another thread
+    uint64_t batches = 0;
+    float cost = 0.0f;
+    vector<uint64_t> thread_expansions;
+};
+
+class HdaStar {
+public:
+    HdaStar(const GridMap& map, const HdaOptions& options);
+
+    // Optimal path start -> goal, {} if there is none. The per-cell tables
+    // are kept between calls.
+    vector<pii> search(const pii& start, const pii& goal, HdaStats* stats = nullptr);
+
+    int owner(int cell) const;
+    size_t bytes() const;
+
+private:
+    struct Message {
+        int cell;
+        int parent;
+        float g;
+    };
+    struct Batch {
+        Batch* next = nullptr;
+        vector<Message> items;
+    };
+    // Producers push whole batches; the owner takes all of them at once
+    struct Inbox {
+        atomic<Batch*> head{nullptr};
+        char pad[64 - sizeof(atomic<Batch*>)];
+    };
+
+    const GridMap& map;
+    HdaOptions options;
+    vector<uint32_t> zobrist_row, zobrist_col;
+
+    // Per-cell state, each entry written only by the cell's owner
+    vector<float> g;
+    vector<int> parent;
+    vector<uint32_t> stamp;
+    uint32_t generation = 0;
+
+    // Per-query shared state
+    vector<Inbox> inboxes;
+    int start_cell = 0, goal_cell = 0;
+    atomic<float> incumbent{0};
+    atomic<int64_t> in_flight{0}; // nodes pushed to an inbox and not yet taken in
+    atomic<uint64_t> sent_total{0};
+    atomic<int> busy{0};          // threads that may still have work below the incumbent
+    atomic<bool> done{false};
+
+    void worker(int id, HdaStats* stats);
+};
+
+#endif // HDA_STAR_H
@@ -1,10 +1,7 @@
 #include "puzzle.h"
+#include "perm_index.h"
 #include <iostream>
 #include <queue>
-#include <unordered_set>
-#include <unordered_map>
-#include <algorithm>  
-#include <string>
 
 
 using namespace std;
@@ -12,43 +9,37 @@ using namespace std;
 vector<array<int, 4>> bfs_solve(array<int, 4> initial_state) {
     array<int, 4> goal_state = {1, 2, 3, 0};
 
-    queue<array<int, 4>> q;
-    unordered_set<string> visited;
-    unordered_map<string, array<int, 4>> parent;
+    // States are queued and stored by permutation rank: no strings, no hashing
+    PermutationIndexer indexer(4, 4);
+    RankParentTable parents(indexer.count);
+    queue<uint32_t> q;
 
-    auto to_string_state = [](array<int, 4> state) {
-        string s = "";
-        for (int num : state) {
-            s += to_string(num);
-        }
-        return s;
-    };
-
-    q.push(initial_state);
-    visited.insert(to_string_state(initial_state));
-    parent[to_string_state(initial_state)] = {-1, -1, -1, -1};
+    uint32_t root = indexer.rank(initial_state.data());
+    q.push(root);
+    parents.set(root, root);
 
     while (!q.empty()) {
-        array<int, 4> current_state = q.front();
+        uint32_t current = q.front();
         q.pop();
+        array<int, 4> current_state;
+        indexer.unrank(current, current_state.data());
 
         if (current_state == goal_state) {
             vector<array<int, 4>> path;
-            while (current_state != array<int, 4>{-1, -1, -1, -1}) {
-                path.push_back(current_state);
-                current_state = parent[to_string_state(current_state)];
+            for (uint64_t r : parents.path_to(current)) {
+                array<int, 4> state;
+                indexer.unrank(r, state.data());
+                path.push_back(state);
             }
-            reverse(path.begin(), path.end());
             return path;
         }
 
         SlidingPuzzle puzzle(current_state);
         for (array<int, 4> next_state : puzzle.get_next_states()) {
-            string state_str = to_string_state(next_state);
-            if (visited.find(state_str) == visited.end()) {
-                q.push(next_state);
-                visited.insert(state_str);
-                parent[state_str] = current_state;
+            uint32_t next = indexer.rank(next_state.data());
+            if (!parents.visited(next)) {
+                q.push(next);
+                parents.set(next, current);
             }
         }
     }
@@ -1,9 +1,7 @@
 #include <iostream>
 #include <stack>
-#include <unordered_set>
-#include <unordered_map>
 #include "puzzle.cpp"  // Include your SlidingPuzzle class
-#include <string>
+#include "perm_index.h"
 
 
 using namespace std;
@@ -12,32 +10,28 @@ using namespace std;
 vector<array<int, 4>> dfs_solve(array<int, 4> initial_state) {
     array<int, 4> goal_state = {1, 2, 3, 0};
 
-    stack<array<int, 4>> s;  // DFS stack
-    unordered_set<string> visited;  // Track visited states
-    unordered_map<string, array<int, 4>> parent;  // Store parent states
+    PermutationIndexer indexer(4, 4);  // State <-> rank, replaces string keys
+    stack<uint32_t> s;  // DFS stack of state ranks
+    RankParentTable parents(indexer.count);  // Visited flags + parent ranks
 
-    auto to_string_state = [](array<int, 4> state) {
-        string s = "";
-        for (int num : state) s += to_string(num);
-        return s;
-    };
-
-    s.push(initial_state);
-    visited.insert(to_string_state(initial_state));
-    parent[to_string_state(initial_state)] = {-1, -1, -1, -1};  // Sentinel for root
+    uint32_t root = indexer.rank(initial_state.data());
+    s.push(root);
+    parents.set(root, root);  // Root is its own parent
 
     while (!s.empty()) {
-        array<int, 4> current_state = s.top();
+        uint32_t current = s.top();
         s.pop();
+        array<int, 4> current_state;
+        indexer.unrank(current, current_state.data());
 
         // If we reach the goal state, reconstruct the path
         if (current_state == goal_state) {
             vector<array<int, 4>> path;
-            while (current_state != array<int, 4>{-1, -1, -1, -1}) {
-                path.push_back(current_state);
-                current_state = parent[to_string_state(current_state)];
+            for (uint64_t r : parents.path_to(current)) {
+                array<int, 4> state;
+                indexer.unrank(r, state.data());
+                path.push_back(state);
             }
-            reverse(path.begin(), path.end());
             return path;
         }
 
@@ -47,11 +41,10 @@ vector<array<int, 4>> dfs_solve(array<int, 4> initial_state) {
         reverse(next_states.begin(), next_states.end());  // Ensure LIFO behavior
 
         for (array<int, 4> next_state : next_states) {
-            string state_str = to_string_state(next_state);
-            if (visited.find(state_str) == visited.end()) {
-                s.push(next_state);
-                visited.insert(state_str);
-                parent[state_str] = current_state;
+            uint32_t next = indexer.rank(next_state.data());
+            if (!parents.visited(next)) {
+                s.push(next);
+                parents.set(next, current);
             }
         }
     }
@@ -0,0 +1,312 @@
+#include "external_bfs.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <sys/stat.h>
+
+static const size_t IO_BUFFER_BYTES = 1 << 16;
+static const size_t RUN_HEADER_BYTES = 12;
+
+bool RunWriter::open(const string& file) {
+    path = file;
+    out.open(path, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "Failed to open run file for writing: " << path << endl;
+        return false;
+    }
+    count = 0;
+    last = 0;
+    bytes = RUN_HEADER_BYTES;
+    buffer.clear();
+    buffer.reserve(IO_BUFFER_BYTES + 10);
+    char header[RUN_HEADER_BYTES] = {'R', 'U', 'N', '1'};
+    out.write(header, sizeof(header));
+    return (bool)out;
+}
+
+void RunWriter::push(uint64_t key) {
+    uint64_t delta = key - last;
+    last = key;
+    ++count;
+    while (delta >= 0x80) {
+        buffer.push_back((char)(delta | 0x80));
+        delta >>= 7;
+    }
+    buffer.push_back((char)delta);
+    if (buffer.size() >= IO_BUFFER_BYTES) flush();
+}
+
+void RunWriter::flush() {
+    out.write(buffer.data(), buffer.size());
+    bytes += buffer.size();
+    buffer.clear();
+}
+
+bool RunWriter::close() {
+    flush();
+    out.seekp(4);
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.close();
+    if (!out) {
+        cerr << "Failed to write run file: " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool RunReader::open(const string& path) {
+    in.open(path, ios::binary);
+    char header[RUN_HEADER_BYTES];
+    if (!in.is_open() || !in.read(header, sizeof(header)) || memcmp(header, "RUN1", 4) != 0) {
+        cerr << "Invalid run file: " << path << endl;
+        return false;
+    }
+    memcpy(&count, header + 4, sizeof(count));
+    remaining = count;
+    last = 0;
+    buffer.resize(IO_BUFFER_BYTES);
+    pos = end = 0;
+    return true;
+}
+
+bool RunReader::refill() {
+    in.read(buffer.data(), buffer.size());
+    pos = 0;
+    end = in.gcount();
+    return end > 0;
+}
+
+bool RunReader::next(uint64_t& key) {
+    if (remaining == 0) return false;
+    uint64_t delta = 0;
+    for (int shift = 0;; shift += 7) {
+        if (pos == end && !refill()) {
+            remaining = 0; // truncated file
+            return false;
+        }
+        uint8_t b = buffer[pos++];
+        delta |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    last += delta;
+    key = last;
+    --remaining;
+    return true;
+}
+
+ExternalBfs::ExternalBfs(const TilePuzzle& puzzle, const string& dir, size_t memory_bytes)
+    : puzzle(puzzle), dir(dir), memory_bytes(memory_bytes), indexer(puzzle.size, puzzle.size) {}
+
+string ExternalBfs::layer_path(int depth) const {
+    return dir + "/layer_" + to_string(depth) + ".run";
+}
+
+string ExternalBfs::run_path(int depth, int pass, int index) const {
+    return dir + "/tmp_" + to_string(depth) + "_" + to_string(pass) + "_" + to_string(index) + ".run";
+}
+
+string ExternalBfs::manifest_path() const {
+    return dir + "/manifest";
+}
+
+uint64_t ExternalBfs::total_states() const {
+    uint64_t total = 0;
+    for (uint64_t n : histogram) total += n;
+    return total;
+}
+
+// Text manifest: "rows cols complete", then one layer size per line.
+bool ExternalBfs::load_manifest() {
+    ifstream in(manifest_path());
+    int rows, cols, done;
+    if (!(in >> rows >> cols >> done) || rows != puzzle.rows || cols != puzzle.cols) return false;
+    histogram.clear();
+    uint64_t n;
+    while (in >> n) histogram.push_back(n);
+    complete = done != 0;
+    return !histogram.empty();
+}
+
+bool ExternalBfs::save_manifest() const {
+    string tmp = manifest_path() + ".tmp";
+    {
+        ofstream out(tmp);
+        out << puzzle.rows << " " << puzzle.cols << " " << (complete ? 1 : 0) << "\n";
+        for (uint64_t n : histogram) out << n << "\n";
+        if (!out) {
+            cerr << "Failed to write manifest: " << tmp << endl;
+            return false;
+        }
+    }
+    if (rename(tmp.c_str(), manifest_path().c_str()) != 0) {
+        cerr << "Failed to rename manifest: " << tmp << endl;
+        return false;
+    }
+    return true;
+}
+
+// K-way merge of sorted runs into `output`, dropping duplicates and every
+// key that occurs in one of the `subtract` runs.
+bool ExternalBfs::merge(const vector<string>& inputs, const vector<string>& subtract, const string& output,
+                        uint64_t* written, uint64_t* bytes) const {
+    vector<RunReader> readers(inputs.size());
+    using Head = pair<uint64_t, size_t>;
+    priority_queue<Head, vector<Head>, greater<Head>> heap;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!readers[i].open(inputs[i])) return false;
+        uint64_t key;
+        if (readers[i].next(key)) heap.push({key, i});
+    }
+
+    vector<RunReader> old(subtract.size());
+    vector<uint64_t> old_key(subtract.size());
+    vector<bool> old_live(subtract.size());
+    for (size_t j = 0; j < subtract.size(); ++j) {
+        if (!old[j].open(subtract[j])) return false;
+        old_live[j] = old[j].next(old_key[j]);
+    }
+
+    RunWriter out;
+    if (!out.open(output)) return false;
+    bool have_last = false;
+    uint64_t last = 0;
+    while (!heap.empty()) {
+        auto [key, i] = heap.top();
+        heap.pop();
+        uint64_t next;
+        if (readers[i].next(next)) heap.push({next, i});
+        if (have_last && key == last) continue;
+        have_last = true;
+        last = key;
+
+        bool seen = false;
+        for (size_t j = 0; j < old.size(); ++j) {
+            while (old_live[j] && old_key[j] < key) old_live[j] = old[j].next(old_key[j]);
+            seen |= old_live[j] && old_key[j] == key;
+        }
+        if (!seen) out.push(key);
+    }
+    if (written) *written = out.count;
+    if (!out.close()) return false;
+    if (bytes) *bytes = out.bytes;
+    return true;
+}
+
+bool ExternalBfs::expand(int depth) {
+    auto t0 = chrono::steady_clock::now();
+    RunReader layer;
+    if (!layer.open(layer_path(depth))) return false;
+
+    // 1. Expand into sorted runs of at most memory_bytes
+    size_t capacity = max<size_t>(1024, memory_bytes / sizeof(uint64_t));
+    vector<uint64_t> buffer;
+    buffer.reserve(capacity);
+    vector<string> runs;
+    uint64_t generated = 0;
+    auto spill = [&]() {
+        sort(buffer.begin(), buffer.end());
+        buffer.erase(unique(buffer.begin(), buffer.end()), buffer.end());
+        RunWriter run;
+        string path = run_path(depth + 1, 0, runs.size());
+        if (!run.open(path)) return false;
+        for (uint64_t key : buffer) run.push(key);
+        buffer.clear();
+        runs.push_back(path);
+        return run.close();
+    };
+
+    uint8_t tiles[MAX_CELLS];
+    uint64_t key;
+    while (layer.next(key)) {
+        indexer.unrank(key, tiles);
+        int blank = find(tiles, tiles + puzzle.size, 0) - tiles;
+        for (int k = 0; k < puzzle.num_moves[blank]; ++k) {
+            int to = puzzle.moves[blank][k];
+            swap(tiles[blank], tiles[to]);
+            buffer.push_back(indexer.rank(tiles));
+            swap(tiles[blank], tiles[to]);
+            ++generated;
+            if (buffer.size() == capacity && !spill()) return false;
+        }
+    }
+    if (!buffer.empty() && !spill()) return false;
+    vector<uint64_t>().swap(buffer);
+
+    // 2. Cut the number of runs down to one merge's fan-in
+    int spilled = runs.size();
+    for (int pass = 1; runs.size() > (size_t)MERGE_FAN_IN; ++pass) {
+        vector<string> merged;
+        for (size_t i = 0; i < runs.size(); i += MERGE_FAN_IN) {
+            vector<string> group(runs.begin() + i, runs.begin() + min(runs.size(), i + MERGE_FAN_IN));
+            string path = run_path(depth + 1, pass, merged.size());
+            if (!merge(group, {}, path, nullptr, nullptr)) return false;
+            for (const string& p : group) remove(p.c_str());
+            merged.push_back(path);
+        }
+        runs.swap(merged);
+    }
+
+    // 3. Final merge minus the two previous layers
+    vector<string> subtract = {layer_path(depth)};
+    if (depth > 0) subtract.push_back(layer_path(depth - 1));
+    string tmp = layer_path(depth + 1) + ".tmp";
+    uint64_t states = 0, bytes = 0;
+    if (!merge(runs, subtract, tmp, &states, &bytes)) return false;
+    for (const string& p : runs) remove(p.c_str());
+    if (rename(tmp.c_str(), layer_path(depth + 1).c_str()) != 0) {
+        cerr << "Failed to rename layer file: " << tmp << endl;
+        return false;
+    }
+
+    if (states == 0) complete = true;
+    else histogram.push_back(states);
+    if (!save_manifest()) return false;
+    if (!keep_layers && depth > 0) remove(layer_path(depth - 1).c_str());
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    reports.push_back({depth + 1, states, generated, spilled, bytes, seconds});
+    return true;
+}
+
+bool ExternalBfs::run(int max_depth) {
+    if (puzzle.size > MAX_CELLS) {
+        cerr << "External BFS supports boards of up to " << MAX_CELLS << " cells" << endl;
+        return false;
+    }
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        cerr << "Failed to create directory: " << dir << endl;
+        return false;
+    }
+
+    reports.clear();
+    if (ifstream(manifest_path()).is_open()) {
+        if (!load_manifest()) {
+            cerr << "Manifest in " << dir << " is not for a " << puzzle.rows << "x" << puzzle.cols << " board"
+                 << endl;
+            return false;
+        }
+        resumed = true;
+        // A crash after the manifest was saved can leave the layer before last behind
+        int depth = histogram.size() - 1;
+        if (!keep_layers && depth >= 2) remove(layer_path(depth - 2).c_str());
+    } else {
+        TileBoard goal = puzzle.goal_board();
+        RunWriter root;
+        if (!root.open(layer_path(0))) return false;
+        root.push(indexer.rank(goal.tiles.data()));
+        if (!root.close()) return false;
+        histogram = {1};
+        complete = false;
+        if (!save_manifest()) return false;
+    }
+
+    start_depth = histogram.size() - 1;
+    while (!complete && (int)histogram.size() - 1 < max_depth) {
+        if (!expand(histogram.size() - 1)) return false;
+    }
+    return true;
+}
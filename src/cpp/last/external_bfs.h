@@ -0,0 +1,116 @@
+#ifndef EXTERNAL_BFS_H
+#define EXTERNAL_BFS_H
+
+#include "tile_puzzle.h"
+#include "perm_index.h"
+#include <climits>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Sorted, duplicate-free sequence of uint64 keys on disk. Keys are stored as
+// LEB128 varints of the gap to the previous key, so a dense BFS layer of
+// permutation ranks takes one to three bytes per state.
+//
+// Layout: "RUN1", uint64 count, then the varints.
+class RunWriter {
+public:
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+
+    bool open(const string& path);
+    // Keys must be pushed in strictly increasing order.
+    void push(uint64_t key);
+    bool close(); // writes the count into the header
+
+private:
+    ofstream out;
+    string path;
+    uint64_t last = 0;
+    vector<char> buffer;
+    void flush();
+};
+
+class RunReader {
+public:
+    uint64_t count = 0;
+
+    bool open(const string& path);
+    bool next(uint64_t& key);
+
+private:
+    ifstream in;
+    uint64_t remaining = 0;
+    uint64_t last = 0;
+    vector<char> buffer;
+    size_t pos = 0, end = 0;
+    bool refill();
+};
+
+// Breadth-first enumeration of a sliding-tile state space from the goal
+// with delayed duplicate detection, for spaces far larger than RAM.
+//
+// Layer d + 1 is produced from the layer d file in three steps:
+//  1. expand: successors are collected in a buffer of `memory_bytes`; a full
+//     buffer is sorted, deduplicated and written out as a run file;
+//  2. merge: runs are merged (in several passes if there are more than
+//     MERGE_FAN_IN) into one sorted stream;
+//  3. subtract: the stream is merged against layers d and d - 1, and keys
+//     found there are dropped. Moves are reversible, so a successor of
+//     layer d that was seen before lies in layer d - 1 or d.
+// States are permutation ranks (boards of up to 20 cells).
+//
+// Progress is checkpointed in `dir`/manifest after each layer (written to
+// a temporary file and renamed), so an interrupted run resumes from the
+// last finished layer. Only the last two layers are kept on disk unless
+// `keep_layers` is set.
+class ExternalBfs {
+public:
+    static const int MAX_CELLS = 20;
+    static const int MERGE_FAN_IN = 256;
+
+    struct LayerReport {
+        int depth;
+        uint64_t states;
+        uint64_t generated; // successors before duplicate detection
+        int runs;
+        uint64_t bytes; // size of the layer file
+        double seconds;
+    };
+
+    const TilePuzzle& puzzle;
+    string dir;
+    size_t memory_bytes;
+    bool keep_layers = false;
+
+    vector<uint64_t> histogram; // states at each depth so far
+    bool complete = false;      // the last layer had no new successors
+    bool resumed = false;
+    int start_depth = 0;        // deepest finished layer when run() began
+    vector<LayerReport> reports; // layers built by this process
+
+    ExternalBfs(const TilePuzzle& puzzle, const string& dir, size_t memory_bytes);
+
+    // Runs (or resumes) the BFS until the space is exhausted or `max_depth`
+    // layers exist. Returns false on I/O error.
+    bool run(int max_depth = INT_MAX);
+
+    uint64_t total_states() const;
+    string layer_path(int depth) const;
+
+private:
+    PermutationIndexer indexer;
+
+    string run_path(int depth, int pass, int index) const;
+    string manifest_path() const;
+    bool load_manifest();
+    bool save_manifest() const;
+    bool expand(int depth);
+    bool merge(const vector<string>& inputs, const vector<string>& subtract, const string& output,
+               uint64_t* written, uint64_t* bytes) const;
+};
+
+#endif // EXTERNAL_BFS_H
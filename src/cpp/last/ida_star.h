@@ -0,0 +1,198 @@
+#ifndef IDA_STAR_H
+#define IDA_STAR_H
+
+#include "tile_puzzle.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Manhattan distance plus linear conflict, maintained incrementally.
+// A move changes the Manhattan term of one tile and the conflicts of only
+// two lines: the two columns for a horizontal move, the two rows for a
+// vertical one. Each line scores 2 * (tiles in it - LIS of their goal
+// positions), which stays admissible when three or more tiles conflict.
+// Line scores are precomputed for every line content, so an update is a
+// key computation and a table lookup.
+class ManhattanLC {
+public:
+    struct State {
+        int md;
+        int lc;
+        array<uint8_t, MAX_SIDE> row_lc;
+        array<uint8_t, MAX_SIDE> col_lc;
+    };
+
+    const TilePuzzle& puzzle;
+
+    explicit ManhattanLC(const TilePuzzle& puzzle) : puzzle(puzzle) {
+        // Key digit of a tile in a line: 1 + its goal offset along the line
+        // if the line is its goal line, else 0.
+        for (int t = 0; t < MAX_TILES; ++t) {
+            for (int i = 0; i < MAX_SIDE; ++i) {
+                row_digit[t][i] = col_digit[t][i] = 0;
+                if (t == 0 || t >= puzzle.size) continue;
+                int g = puzzle.goal_pos[t];
+                if (puzzle.row_of[g] == i) row_digit[t][i] = puzzle.col_of[g] + 1;
+                if (puzzle.col_of[g] == i) col_digit[t][i] = puzzle.row_of[g] + 1;
+            }
+        }
+        build_table(row_table, puzzle.cols);
+        build_table(col_table, puzzle.rows);
+    }
+
+    State init(const TileBoard& board) const {
+        State s{};
+        for (int t = 1; t < puzzle.size; ++t) s.md += puzzle.md[t][board.pos[t]];
+        for (int r = 0; r < puzzle.rows; ++r) s.lc += s.row_lc[r] = row_conflicts(board, r);
+        for (int c = 0; c < puzzle.cols; ++c) s.lc += s.col_lc[c] = col_conflicts(board, c);
+        return s;
+    }
+
+    // `board` is the position after `tile` slid from cell `from` to `to`.
+    State apply(const State& prev, const TileBoard& board, int tile, int from, int to) const {
+        State s = prev;
+        s.md += puzzle.md[tile][to] - puzzle.md[tile][from];
+        if (puzzle.row_of[from] == puzzle.row_of[to]) {
+            for (int c : {(int)puzzle.col_of[from], (int)puzzle.col_of[to]}) {
+                s.lc -= s.col_lc[c];
+                s.lc += s.col_lc[c] = col_conflicts(board, c);
+            }
+        } else {
+            for (int r : {(int)puzzle.row_of[from], (int)puzzle.row_of[to]}) {
+                s.lc -= s.row_lc[r];
+                s.lc += s.row_lc[r] = row_conflicts(board, r);
+            }
+        }
+        return s;
+    }
+
+    static int value(const State& s) { return s.md + s.lc; }
+
+private:
+    array<array<uint8_t, MAX_SIDE>, MAX_TILES> row_digit, col_digit;
+    vector<uint8_t> row_table, col_table; // indexed by base-(len+1) line key
+
+    static void build_table(vector<uint8_t>& table, int len) {
+        int keys = 1;
+        for (int i = 0; i < len; ++i) keys *= len + 1;
+        table.assign(keys, 0);
+        for (int key = 0; key < keys; ++key) {
+            // Digits are most significant first, i.e. in line order
+            int seq[MAX_SIDE], k = 0, rest = key, digits[MAX_SIDE];
+            for (int i = len - 1; i >= 0; --i) {
+                digits[i] = rest % (len + 1);
+                rest /= len + 1;
+            }
+            for (int i = 0; i < len; ++i)
+                if (digits[i]) seq[k++] = digits[i];
+            table[key] = conflicts(seq, k);
+        }
+    }
+
+    // 2 * (k - longest strictly increasing subsequence)
+    static int conflicts(const int* seq, int k) {
+        int lis[MAX_SIDE];
+        int best = 0;
+        for (int i = 0; i < k; ++i) {
+            lis[i] = 1;
+            for (int j = 0; j < i; ++j)
+                if (seq[j] < seq[i] && lis[j] + 1 > lis[i]) lis[i] = lis[j] + 1;
+            best = max(best, lis[i]);
+        }
+        return 2 * (k - best);
+    }
+
+    int row_conflicts(const TileBoard& board, int r) const {
+        int key = 0;
+        const uint8_t* line = &board.tiles[r * puzzle.cols];
+        for (int c = 0; c < puzzle.cols; ++c) key = key * (puzzle.cols + 1) + row_digit[line[c]][r];
+        return row_table[key];
+    }
+
+    int col_conflicts(const TileBoard& board, int c) const {
+        int key = 0;
+        for (int r = 0; r < puzzle.rows; ++r)
+            key = key * (puzzle.rows + 1) + col_digit[board.tiles[r * puzzle.cols + c]][c];
+        return col_table[key];
+    }
+};
+
+// IDA* over a TileBoard mutated in place (move, recurse, undo), so no
+// state is allocated per expansion. Heuristic provides State, init(),
+// apply() and value() as ManhattanLC does.
+template <class Heuristic>
+class IdaStar {
+public:
+    using HState = typename Heuristic::State;
+
+    const TilePuzzle& puzzle;
+    const Heuristic& heuristic;
+    uint64_t nodes = 0;
+    bool found = false;
+    vector<int> solution; // cell the blank moves to at each step
+    const atomic<bool>* cancel = nullptr; // set by another thread to abandon search()
+
+    IdaStar(const TilePuzzle& puzzle, const Heuristic& heuristic) : puzzle(puzzle), heuristic(heuristic) {}
+
+    // Returns the optimal number of moves.
+    int solve(TileBoard board) {
+        nodes = 0;
+        found = false;
+        solution.clear();
+        HState hs = heuristic.init(board);
+        int bound = Heuristic::value(hs);
+        while (!found) {
+            int next = search(board, hs, 0, bound, -1);
+            if (found) break;
+            if (next == INT_MAX) return -1;
+            bound = next;
+        }
+        reverse(solution.begin(), solution.end());
+        return bound;
+    }
+
+    // One cost-bounded DFS from `board` at depth g. Returns the smallest f
+    // that exceeded bound, or sets `found` and records the moves in reverse.
+    int search(TileBoard& board, const HState& hs, int g, int bound, int prev_blank) {
+        ++nodes;
+        if (cancel && cancel->load(memory_order_relaxed)) return INT_MAX;
+        int h = Heuristic::value(hs);
+        int f = g + h;
+        if (f > bound) return f;
+        if (h == 0 && puzzle.is_goal(board)) {
+            found = true;
+            return f;
+        }
+
+        int next = INT_MAX;
+        int blank = board.blank;
+        for (int k = 0; k < puzzle.num_moves[blank]; ++k) {
+            int to = puzzle.moves[blank][k];
+            if (to == prev_blank) continue;
+            int tile = board.tiles[to];
+            board.move(to);
+            HState child = heuristic.apply(hs, board, tile, to, blank);
+            int child_f = g + 1 + Heuristic::value(child);
+            if (child_f > bound) {
+                // Prune without a call frame; this is most children near the bound
+                board.move(blank);
+                next = min(next, child_f);
+                continue;
+            }
+            int t = search(board, child, g + 1, bound, blank);
+            board.move(blank);
+            if (found) {
+                solution.push_back(to);
+                return t;
+            }
+            next = min(next, t);
+        }
+        return next;
+    }
+};
+
+#endif // IDA_STAR_H
@@ -0,0 +1,85 @@
+// Work-stealing parallel IDA* on random sliding-puzzle instances, timed at
+// 1..max threads and checked against serial IDA*.
+// Usage: parallel_ida [rows] [cols] [instances] [max_threads] [partition] [split_depth]
+// partition: "lc" (Manhattan + linear conflict, default) or a PDB partition
+// as accepted by pdb_build; missing PDB files are built and saved.
+#include "tile_puzzle.h"
+#include "ida_star.h"
+#include "parallel_ida.h"
+#include "pdb.h"
+#include "../bench_util.h"
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+template <class Heuristic>
+int run(const TilePuzzle& puzzle, const Heuristic& heuristic, int instances, int max_threads, int split_depth) {
+    mt19937_64 rng(1);
+    vector<TileBoard> boards;
+    for (int i = 0; i < instances; ++i) boards.push_back(puzzle.random_board(rng));
+
+    IdaStar<Heuristic> serial(puzzle, heuristic);
+    vector<int> expected;
+    Timer timer;
+    for (const TileBoard& board : boards) expected.push_back(serial.solve(board));
+    double serial_secs = timer.seconds();
+    cout << "Serial IDA*: " << serial_secs * 1000 / instances << " ms/instance\n";
+
+    int mismatches = 0;
+    for (int threads = 1; threads <= max_threads; ++threads) {
+        ParallelIdaStar<Heuristic> ida(puzzle, heuristic, threads, split_depth);
+        uint64_t nodes = 0;
+        timer.reset();
+        for (int i = 0; i < instances; ++i) {
+            int length = ida.solve(boards[i]);
+            nodes += ida.nodes;
+            TileBoard check = boards[i];
+            for (int to : ida.solution) check.move(to);
+            if (length != expected[i] || (int)ida.solution.size() != length || !puzzle.is_goal(check)) mismatches++;
+        }
+        double secs = timer.seconds();
+        cout << threads << " threads: " << secs * 1000 / instances << " ms/instance, " << nodes / secs / 1e6
+             << " M nodes/s, speedup " << serial_secs / secs << ", efficiency " << serial_secs / secs / threads
+             << " (" << ida.units << " units)\n";
+    }
+    cout << "Mismatched solutions: " << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? stoi(argv[1]) : 4;
+    int cols = argc > 2 ? stoi(argv[2]) : 4;
+    int instances = argc > 3 ? stoi(argv[3]) : 5;
+    int max_threads = argc > 4 ? stoi(argv[4]) : max(1, (int)thread::hardware_concurrency());
+    string spec = argc > 5 ? argv[5] : "lc";
+    int split_depth = argc > 6 ? stoi(argv[6]) : 8;
+
+    TilePuzzle puzzle(rows, cols);
+    if (spec == "lc") {
+        ManhattanLC heuristic(puzzle);
+        return run(puzzle, heuristic, instances, max_threads, split_depth);
+    }
+
+    string error;
+    vector<vector<int>> partition = parse_partition(spec, rows, cols, &error);
+    if (partition.empty()) {
+        cerr << "Bad partition " << spec << ": " << error << endl;
+        return 1;
+    }
+    vector<unique_ptr<PatternDatabase>> pdbs;
+    vector<const PatternDatabase*> views;
+    for (const auto& tiles : partition) {
+        string file = pdb_file_name(puzzle, tiles);
+        unique_ptr<PatternDatabase> pdb = PatternDatabase::load(file);
+        if (!pdb) {
+            pdb = PatternDatabase::build(puzzle, tiles, max_threads);
+            if (!pdb || !pdb->save(file)) return 1;
+        }
+        views.push_back(pdb.get());
+        pdbs.push_back(move(pdb));
+    }
+    AdditivePdb heuristic(puzzle, views);
+    return run(puzzle, heuristic, instances, max_threads, split_depth);
+}
@@ -0,0 +1,168 @@
+#ifndef PARALLEL_IDA_H
+#define PARALLEL_IDA_H
+
+#include "ida_star.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Mutex-guarded deque: the owner works from the back, thieves take from the
+// front, so a thief gets the unit the owner would have reached last.
+class WorkStealingQueue {
+public:
+    void push(int item) {
+        lock_guard<mutex> lock(m);
+        items.push_back(item);
+    }
+    bool pop(int& item) {
+        lock_guard<mutex> lock(m);
+        if (items.empty()) return false;
+        item = items.back();
+        items.pop_back();
+        return true;
+    }
+    bool steal(int& item) {
+        lock_guard<mutex> lock(m);
+        if (items.empty()) return false;
+        item = items.front();
+        items.pop_front();
+        return true;
+    }
+
+private:
+    mutex m;
+    deque<int> items;
+};
+
+// Parallel IDA*: the tree is cut at a shallow split depth into work units
+// (one per non-backtracking path of that length). Every f-bound iteration
+// deals the units round-robin over per-thread deques. Idle threads steal,
+// and each unit is searched with a private IdaStar. Solutions are never
+// shorter than the root heuristic, so a split depth of at most h(root)
+// keeps every solution below some unit. Iterations run in the same bound
+// order as serial IDA*, so the first solution found is optimal. When one
+// worker finds it, the shared incumbent makes the others stop.
+template <class Heuristic>
+class ParallelIdaStar {
+public:
+    using HState = typename Heuristic::State;
+
+    struct Unit {
+        TileBoard board;
+        HState hs;
+        int g;
+        int prev_blank;
+        vector<int> moves; // blank moves from the root to this unit
+    };
+
+    const TilePuzzle& puzzle;
+    const Heuristic& heuristic;
+    int threads;
+    int split_depth;
+    uint64_t nodes = 0;
+    size_t units = 0;
+    vector<int> solution;
+
+    ParallelIdaStar(const TilePuzzle& puzzle, const Heuristic& heuristic, int threads, int split_depth = 8)
+        : puzzle(puzzle), heuristic(heuristic), threads(max(1, threads)), split_depth(split_depth) {}
+
+    // Returns the optimal number of moves, or -1.
+    int solve(const TileBoard& start) {
+        nodes = 0;
+        solution.clear();
+        HState root = heuristic.init(start);
+        int bound = Heuristic::value(root);
+
+        vector<Unit> work;
+        TileBoard board = start;
+        vector<int> path;
+        split(board, root, 0, min(split_depth, bound), -1, path, work);
+        units = work.size();
+
+        while (true) {
+            int result = iterate(work, bound);
+            if (result == FOUND) return bound;
+            if (result == INT_MAX) return -1;
+            bound = result;
+        }
+    }
+
+private:
+    static const int FOUND = -1;
+
+    void split(TileBoard& board, const HState& hs, int g, int depth, int prev_blank,
+               vector<int>& path, vector<Unit>& work) {
+        if (g == depth) {
+            work.push_back({board, hs, g, prev_blank, path});
+            return;
+        }
+        int blank = board.blank;
+        for (int k = 0; k < puzzle.num_moves[blank]; ++k) {
+            int to = puzzle.moves[blank][k];
+            if (to == prev_blank) continue;
+            int tile = board.tiles[to];
+            board.move(to);
+            path.push_back(to);
+            split(board, heuristic.apply(hs, board, tile, to, blank), g + 1, depth, blank, path, work);
+            path.pop_back();
+            board.move(blank);
+        }
+    }
+
+    // One bound: returns FOUND, or the smallest f above bound over all units.
+    int iterate(const vector<Unit>& work, int bound) {
+        vector<WorkStealingQueue> queues(threads);
+        for (size_t i = 0; i < work.size(); ++i) queues[i % threads].push(i);
+
+        atomic<bool> found{false};
+        atomic<int> next_bound{INT_MAX};
+        atomic<uint64_t> total_nodes{0};
+        mutex solution_mutex;
+
+        auto worker = [&](int id) {
+            IdaStar<Heuristic> ida(puzzle, heuristic);
+            ida.cancel = &found;
+            int local_next = INT_MAX;
+            int item;
+            while (!found.load(memory_order_relaxed)) {
+                bool have = queues[id].pop(item);
+                for (int v = 1; !have && v < threads; ++v) have = queues[(id + v) % threads].steal(item);
+                if (!have) break;
+
+                const Unit& unit = work[item];
+                TileBoard board = unit.board;
+                ida.found = false;
+                ida.solution.clear();
+                int t = ida.search(board, unit.hs, unit.g, bound, unit.prev_blank);
+                if (ida.found) {
+                    lock_guard<mutex> lock(solution_mutex);
+                    if (!found.exchange(true)) {
+                        solution = unit.moves;
+                        solution.insert(solution.end(), ida.solution.rbegin(), ida.solution.rend());
+                    }
+                    break;
+                }
+                local_next = min(local_next, t);
+            }
+            int seen = next_bound.load();
+            while (local_next < seen && !next_bound.compare_exchange_weak(seen, local_next)) {}
+            total_nodes += ida.nodes;
+        };
+
+        if (threads == 1) {
+            worker(0);
+        } else {
+            vector<thread> pool;
+            for (int id = 0; id < threads; ++id) pool.emplace_back(worker, id);
+            for (auto& t : pool) t.join();
+        }
+        nodes += total_nodes.load();
+        return found.load() ? FOUND : next_bound.load();
+    }
+};
+
+#endif // PARALLEL_IDA_H
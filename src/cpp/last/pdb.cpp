@@ -0,0 +1,345 @@
+#include "pdb.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+PatternDatabase::~PatternDatabase() {
+    if (mapping) munmap(mapping, mapping_size);
+}
+
+int PatternDatabase::lookup(const TileBoard& board, int md) const {
+    uint8_t cells[MAX_TILES];
+    for (size_t i = 0; i < tiles.size(); ++i) cells[i] = board.pos[tiles[i]];
+    int v = nibble(rank(cells));
+    return v == PDB_UNSEEN ? md : md + 2 * v;
+}
+
+// Cells reachable from `seed` through free cells, by repeated 4-way dilation.
+static uint32_t flood(const TilePuzzle& puzzle, uint32_t free_cells, int seed,
+                      uint32_t not_first_col, uint32_t not_last_col) {
+    uint32_t region = 1u << seed;
+    for (;;) {
+        uint32_t grown = region | (region << puzzle.cols) | (region >> puzzle.cols) |
+                         ((region << 1) & not_first_col) | ((region >> 1) & not_last_col);
+        grown &= free_cells;
+        if (grown == region) return region;
+        region = grown;
+    }
+}
+
+// Layered BFS over (pattern cells, blank region). Moves of non-pattern
+// tiles cost nothing, so the blank stands for its whole connected region of
+// free cells; `seen[index]` holds the blank cells already reached for each
+// pattern placement. The first layer that reaches a placement, with any
+// blank, is its compressed distance.
+template <class Mask>
+static void build_layers(PatternDatabase& pdb, const TilePuzzle& puzzle, atomic<uint8_t>* table,
+                         int threads, PatternDatabase::BuildReport* report) {
+    const vector<int>& tiles = pdb.tiles;
+    int k = tiles.size();
+    int n = puzzle.size;
+    uint32_t all_cells = n == 32 ? ~0u : (1u << n) - 1;
+    uint32_t first_col = 0, last_col = 0;
+    for (int r = 0; r < puzzle.rows; ++r) {
+        first_col |= 1u << (r * puzzle.cols);
+        last_col |= 1u << (r * puzzle.cols + puzzle.cols - 1);
+    }
+    uint32_t not_first_col = all_cells & ~first_col, not_last_col = all_cells & ~last_col;
+
+    unique_ptr<atomic<Mask>[]> seen(new atomic<Mask>[pdb.entries]);
+    for (uint64_t i = 0; i < pdb.entries; ++i) seen[i].store(0, memory_order_relaxed);
+
+    auto claim_nibble = [&](uint64_t index, uint8_t value) {
+        atomic<uint8_t>& byte = table[index >> 1];
+        int shift = (index & 1) * 4;
+        uint8_t old = byte.load(memory_order_relaxed);
+        uint8_t updated;
+        do {
+            if (((old >> shift) & 0xF) != PDB_UNSEEN) return false;
+            updated = (old & ~(0xF << shift)) | (value << shift);
+        } while (!byte.compare_exchange_weak(old, updated, memory_order_relaxed));
+        return true;
+    };
+
+    // Frontier entries pack index << 5 | a blank cell of the region
+    uint8_t cells[MAX_TILES];
+    uint32_t occupied = 0;
+    for (int i = 0; i < k; ++i) {
+        cells[i] = puzzle.goal_pos[tiles[i]];
+        occupied |= 1u << cells[i];
+    }
+    uint64_t goal = pdb.rank(cells);
+    int goal_blank = puzzle.goal_pos[0];
+    seen[goal].store(flood(puzzle, all_cells & ~occupied, goal_blank, not_first_col, not_last_col));
+    claim_nibble(goal, 0);
+
+    vector<uint64_t> frontier = {goal << 5 | goal_blank};
+    vector<vector<uint64_t>> next(threads);
+    atomic<uint64_t> saturated{0};
+    int depth = 0;
+    const size_t CHUNK = 4096;
+
+    while (!frontier.empty()) {
+        atomic<size_t> cursor{0};
+        auto worker = [&](int id) {
+            uint8_t cells[MAX_TILES];
+            size_t begin;
+            while ((begin = cursor.fetch_add(CHUNK)) < frontier.size()) {
+                size_t end = min(frontier.size(), begin + CHUNK);
+                for (size_t f = begin; f < end; ++f) {
+                    pdb.unrank(frontier[f] >> 5, cells);
+                    uint32_t occupied = 0;
+                    int md = 0;
+                    for (int i = 0; i < k; ++i) {
+                        occupied |= 1u << cells[i];
+                        md += puzzle.md[tiles[i]][cells[i]];
+                    }
+                    uint32_t free_cells = all_cells & ~occupied;
+                    uint32_t region = flood(puzzle, free_cells, frontier[f] & 31, not_first_col, not_last_col);
+
+                    // Slide pattern tile i from `from` into a blank cell `to` of the region
+                    for (int i = 0; i < k; ++i) {
+                        int from = cells[i];
+                        for (int m = 0; m < puzzle.num_moves[from]; ++m) {
+                            int to = puzzle.moves[from][m];
+                            if (!(region >> to & 1)) continue;
+                            cells[i] = to;
+                            uint64_t index = pdb.rank(cells);
+                            cells[i] = from;
+
+                            uint32_t next_free = (free_cells & ~(1u << to)) | (1u << from);
+                            Mask next_region = flood(puzzle, next_free, from, not_first_col, not_last_col);
+                            Mask before = seen[index].fetch_or(next_region, memory_order_relaxed);
+                            if (before & next_region) continue;
+                            next[id].push_back(index << 5 | from);
+
+                            int extra = (depth + 1 - (md + puzzle.md[tiles[i]][to] - puzzle.md[tiles[i]][from])) / 2;
+                            if (claim_nibble(index, min(extra, (int)PDB_MAX_NIBBLE)) && extra > PDB_MAX_NIBBLE)
+                                saturated.fetch_add(1, memory_order_relaxed);
+                        }
+                    }
+                }
+            }
+        };
+
+        if (threads == 1) {
+            worker(0);
+        } else {
+            vector<thread> pool;
+            for (int id = 0; id < threads; ++id) pool.emplace_back(worker, id);
+            for (auto& t : pool) t.join();
+        }
+
+        frontier.clear();
+        for (auto& local : next) {
+            frontier.insert(frontier.end(), local.begin(), local.end());
+            local.clear();
+            local.shrink_to_fit();
+        }
+        if (!frontier.empty()) ++depth;
+    }
+
+    if (report) {
+        report->max_depth = depth;
+        report->saturated = saturated.load();
+    }
+}
+
+unique_ptr<PatternDatabase> PatternDatabase::build(const TilePuzzle& puzzle, const vector<int>& tiles,
+                                                   int threads, BuildReport* report) {
+    auto t0 = chrono::steady_clock::now();
+    unique_ptr<PatternDatabase> pdb(new PatternDatabase());
+    pdb->rows = puzzle.rows;
+    pdb->cols = puzzle.cols;
+    pdb->size = puzzle.size;
+    pdb->tiles = tiles;
+    pdb->indexer = PermutationIndexer(puzzle.size, tiles.size());
+    pdb->entries = pdb->indexer.count;
+
+    size_t bytes = pdb->bytes();
+    unique_ptr<atomic<uint8_t>[]> table(new atomic<uint8_t>[bytes]);
+    for (size_t i = 0; i < bytes; ++i) table[i].store(0xFF, memory_order_relaxed);
+
+    threads = max(1, threads);
+    if (puzzle.size <= 16)
+        build_layers<uint16_t>(*pdb, puzzle, table.get(), threads, report);
+    else
+        build_layers<uint32_t>(*pdb, puzzle, table.get(), threads, report);
+
+    pdb->owned.resize(bytes);
+    for (size_t i = 0; i < bytes; ++i) pdb->owned[i] = table[i].load(memory_order_relaxed);
+    pdb->data = pdb->owned.data();
+
+    if (report) report->seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return pdb;
+}
+
+bool PatternDatabase::save(const string& path) const {
+    PdbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "PDB4", 4);
+    header.version = 1;
+    header.rows = rows;
+    header.cols = cols;
+    header.num_tiles = tiles.size();
+    for (size_t i = 0; i < tiles.size(); ++i) header.tiles[i] = tiles[i];
+    header.entries = entries;
+
+    ofstream fout(path, ios::binary);
+    if (!fout.is_open()) {
+        cerr << "Failed to open PDB file for writing: " << path << endl;
+        return false;
+    }
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(data), bytes());
+    return (bool)fout;
+}
+
+unique_ptr<PatternDatabase> PatternDatabase::load(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(PdbHeader)) {
+        close(fd);
+        cerr << "Invalid PDB file: " << path << endl;
+        return nullptr;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        cerr << "Failed to mmap PDB file: " << path << endl;
+        return nullptr;
+    }
+
+    unique_ptr<PatternDatabase> pdb(new PatternDatabase());
+    pdb->mapping = base;
+    pdb->mapping_size = st.st_size;
+
+    const PdbHeader* header = static_cast<const PdbHeader*>(base);
+    if (memcmp(header->magic, "PDB4", 4) != 0 || header->version != 1 ||
+        header->num_tiles == 0 || header->num_tiles > MAX_TILES || header->rows * header->cols > MAX_TILES ||
+        (size_t)st.st_size < sizeof(PdbHeader) + (header->entries + 1) / 2) {
+        cerr << "Invalid PDB file: " << path << endl;
+        return nullptr;
+    }
+    pdb->rows = header->rows;
+    pdb->cols = header->cols;
+    pdb->size = header->rows * header->cols;
+    pdb->tiles.assign(header->tiles, header->tiles + header->num_tiles);
+    pdb->entries = header->entries;
+    pdb->indexer = PermutationIndexer(pdb->size, pdb->tiles.size());
+    if (pdb->indexer.count != pdb->entries) {
+        cerr << "Invalid PDB file: " << path << endl;
+        return nullptr;
+    }
+    pdb->data = static_cast<const uint8_t*>(base) + sizeof(PdbHeader);
+    return pdb;
+}
+
+AdditivePdb::AdditivePdb(const TilePuzzle& puzzle, const vector<const PatternDatabase*>& pdbs)
+    : puzzle(puzzle), pdbs(pdbs) {
+    if (pdbs.size() > MAX_PATTERNS)
+        throw length_error("AdditivePdb: more than " + to_string(MAX_PATTERNS) + " pattern databases");
+    pattern_of.fill(-1);
+    for (size_t p = 0; p < pdbs.size(); ++p) {
+        for (int t : pdbs[p]->tiles) {
+            if (pattern_of[t] >= 0)
+                throw invalid_argument("AdditivePdb: tile " + to_string(t) + " is in two patterns");
+            pattern_of[t] = p;
+        }
+    }
+}
+
+int AdditivePdb::pattern_value(const TileBoard& board, int p) const {
+    int md = 0;
+    for (int t : pdbs[p]->tiles) md += puzzle.md[t][board.pos[t]];
+    return pdbs[p]->lookup(board, md);
+}
+
+AdditivePdb::State AdditivePdb::init(const TileBoard& board) const {
+    State s{};
+    for (size_t p = 0; p < pdbs.size() && p < MAX_PATTERNS; ++p) {
+        s.part[p] = pattern_value(board, p);
+        s.h += s.part[p];
+    }
+    for (int t = 1; t < puzzle.size; ++t) {
+        if (pattern_of[t] < 0) s.free_md += puzzle.md[t][board.pos[t]];
+    }
+    s.h += s.free_md;
+    return s;
+}
+
+AdditivePdb::State AdditivePdb::apply(const State& prev, const TileBoard& board, int tile, int from, int to) const {
+    State s = prev;
+    int p = pattern_of[tile];
+    if (p < 0) {
+        int delta = puzzle.md[tile][to] - puzzle.md[tile][from];
+        s.free_md += delta;
+        s.h += delta;
+    } else {
+        s.h -= s.part[p];
+        s.part[p] = pattern_value(board, p);
+        s.h += s.part[p];
+    }
+    return s;
+}
+
+string pdb_file_name(const TilePuzzle& puzzle, const vector<int>& tiles) {
+    string name = "pdb_" + to_string(puzzle.rows) + "x" + to_string(puzzle.cols);
+    for (size_t i = 0; i < tiles.size(); ++i) name += (i ? "-" : "_") + to_string(tiles[i]);
+    return name + ".pdb";
+}
+
+vector<vector<int>> parse_partition(const string& spec, int rows, int cols, string* error) {
+    if (rows == 4 && cols == 4 && spec == "5-5-5")
+        return {{1, 2, 3, 4, 5}, {6, 7, 8, 9, 10}, {11, 12, 13, 14, 15}};
+    if (rows == 4 && cols == 4 && spec == "7-8")
+        return {{1, 2, 3, 4, 5, 6, 7}, {8, 9, 10, 11, 12, 13, 14, 15}};
+    if (rows == 5 && cols == 5 && spec == "6-6-6-6")
+        return {{1, 2, 3, 6, 7, 8}, {4, 5, 9, 10, 14, 15}, {11, 12, 16, 17, 21, 22}, {13, 18, 19, 20, 23, 24}};
+
+    auto fail = [&](const string& message) {
+        if (error) *error = message;
+        return vector<vector<int>>();
+    };
+    int size = rows * cols;
+    vector<bool> used(max(size, 0), false);
+    vector<vector<int>> patterns;
+    stringstream groups(spec);
+    string group;
+    while (getline(groups, group, '/')) {
+        vector<int> tiles;
+        stringstream items(group);
+        string item;
+        while (getline(items, item, ',')) {
+            size_t end = 0;
+            int t = -1;
+            try {
+                t = stoi(item, &end);
+            } catch (const exception&) {
+            }
+            if (end == 0 || end != item.size()) return fail("Not a tile number: \"" + item + "\"");
+            if (t <= 0 || t >= size)
+                return fail("Tile " + to_string(t) + " is not on a " + to_string(rows) + "x" + to_string(cols) +
+                            " board");
+            if (used[t]) return fail("Tile " + to_string(t) + " appears twice");
+            used[t] = true;
+            tiles.push_back(t);
+        }
+        if (tiles.empty()) return fail("Empty pattern in " + spec);
+        patterns.push_back(tiles);
+    }
+    if (patterns.empty() || (int)patterns.size() > AdditivePdb::MAX_PATTERNS)
+        return fail("A partition needs 1 to " + to_string(AdditivePdb::MAX_PATTERNS) + " patterns");
+    return patterns;
+}
@@ -0,0 +1,120 @@
+#ifndef PDB_H
+#define PDB_H
+
+#include "tile_puzzle.h"
+#include "perm_index.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Disjoint additive pattern databases for TilePuzzle.
+//
+// A pattern is a set of tiles; its abstract state is the cells of those
+// tiles, indexed by partial-permutation rank. Only moves of pattern tiles
+// are counted, so values from disjoint patterns add up to an admissible
+// heuristic. The build tracks the blank's free region and stores the
+// minimum over blank positions.
+//
+// Each entry is 4 bits. Every counted move changes the Manhattan distance
+// of the pattern tiles by exactly one, so distance - Manhattan is even and
+// the nibble stores (distance - Manhattan) / 2; 0xF marks "not reached".
+// Values that would not fit saturate at 14, which stays admissible.
+
+// On-disk layout: this 64-byte header followed by (entries + 1) / 2 bytes
+// of nibbles, entry i in the low nibble of byte i / 2 when i is even.
+struct PdbHeader {
+    char magic[4];      // "PDB4"
+    uint32_t version;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t num_tiles;
+    uint8_t tiles[MAX_TILES];
+    uint8_t pad[3];
+    uint64_t entries;
+    uint8_t reserved[8];
+};
+static_assert(sizeof(PdbHeader) == 64, "PdbHeader must stay 64 bytes");
+
+const uint8_t PDB_UNSEEN = 0xF;
+const uint8_t PDB_MAX_NIBBLE = 14;
+
+class PatternDatabase {
+public:
+    int rows = 0, cols = 0, size = 0;
+    vector<int> tiles;
+    uint64_t entries = 0;
+    const uint8_t* data = nullptr;
+    PermutationIndexer indexer; // ranks the cells of `tiles`, in order
+
+    struct BuildReport {
+        double seconds = 0;
+        int max_depth = 0;
+        uint64_t saturated = 0;
+    };
+
+    PatternDatabase() = default;
+    PatternDatabase(const PatternDatabase&) = delete;
+    PatternDatabase& operator=(const PatternDatabase&) = delete;
+    ~PatternDatabase();
+
+    // Backward BFS from the goal pattern, one layer at a time; each layer's
+    // frontier is split across `threads` workers in chunks.
+    static unique_ptr<PatternDatabase> build(const TilePuzzle& puzzle, const vector<int>& tiles,
+                                             int threads, BuildReport* report = nullptr);
+    // Maps the file read-only; returns nullptr on error.
+    static unique_ptr<PatternDatabase> load(const string& path);
+    bool save(const string& path) const;
+
+    size_t bytes() const { return (entries + 1) / 2; }
+    uint64_t rank(const uint8_t* cells) const { return indexer.rank(cells); }
+    void unrank(uint64_t index, uint8_t* cells) const { indexer.unrank(index, cells); }
+
+    int nibble(uint64_t index) const { return (data[index >> 1] >> ((index & 1) * 4)) & 0xF; }
+    // Distance of the pattern tiles in `board`; `md` is their Manhattan sum.
+    int lookup(const TileBoard& board, int md) const;
+
+private:
+    vector<uint8_t> owned;
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+};
+
+// Heuristic adapter for IdaStar: sum of the pattern databases, plus the
+// Manhattan distance of any tile no pattern covers. A move re-ranks only the
+// pattern that owns the moved tile.
+class AdditivePdb {
+public:
+    static const int MAX_PATTERNS = 8;
+
+    struct State {
+        array<uint8_t, MAX_PATTERNS> part;
+        int free_md;
+        int h;
+    };
+
+    const TilePuzzle& puzzle;
+    vector<const PatternDatabase*> pdbs;
+    array<int8_t, MAX_TILES> pattern_of;
+
+    // Throws length_error for more than MAX_PATTERNS databases and
+    // invalid_argument if two share a tile: the sum would not be admissible
+    AdditivePdb(const TilePuzzle& puzzle, const vector<const PatternDatabase*>& pdbs);
+
+    State init(const TileBoard& board) const;
+    State apply(const State& prev, const TileBoard& board, int tile, int from, int to) const;
+    static int value(const State& s) { return s.h; }
+
+private:
+    int pattern_value(const TileBoard& board, int p) const;
+};
+
+string pdb_file_name(const TilePuzzle& puzzle, const vector<int>& tiles);
+// Preset ("5-5-5", "7-8" for 4x4, "6-6-6-6" for 5x5) or explicit tile
+// lists such as "1,2,3/4,5,6". Empty (with error set) unless it names 1 to
+// MAX_PATTERNS non-empty patterns of tiles on the board, none in two.
+vector<vector<int>> parse_partition(const string& spec, int rows, int cols, string* error = nullptr);
+
+#endif // PDB_H
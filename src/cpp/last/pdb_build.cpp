@@ -0,0 +1,74 @@
+// Builds (or mmap-loads) additive pattern databases and solves random
+// instances with IDA* using them.
+// Usage: pdb_build [rows] [cols] [partition] [instances] [threads]
+// partition: preset ("5-5-5", "7-8" for 4x4, "6-6-6-6" for 5x5) or explicit
+// tile lists such as "1,2,3,4,5/6,7,8,9,10/11,12,13,14,15".
+#include "tile_puzzle.h"
+#include "ida_star.h"
+#include "pdb.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? stoi(argv[1]) : 4;
+    int cols = argc > 2 ? stoi(argv[2]) : 4;
+    string spec = argc > 3 ? argv[3] : "5-5-5";
+    int instances = argc > 4 ? stoi(argv[4]) : 10;
+    int threads = argc > 5 ? stoi(argv[5]) : (int)thread::hardware_concurrency();
+
+    TilePuzzle puzzle(rows, cols);
+    string error;
+    vector<vector<int>> partition = parse_partition(spec, rows, cols, &error);
+    if (partition.empty()) {
+        cerr << "Bad partition " << spec << ": " << error << endl;
+        return 1;
+    }
+
+    vector<unique_ptr<PatternDatabase>> pdbs;
+    vector<const PatternDatabase*> views;
+    for (const auto& tiles : partition) {
+        string file = pdb_file_name(puzzle, tiles);
+        unique_ptr<PatternDatabase> pdb = PatternDatabase::load(file);
+        if (pdb) {
+            cout << "Loaded " << file << ": " << pdb->entries << " entries, "
+                 << pdb->bytes() / (1024.0 * 1024.0) << " MB\n";
+        } else {
+            PatternDatabase::BuildReport report;
+            pdb = PatternDatabase::build(puzzle, tiles, threads, &report);
+            if (!pdb) return 1;
+            cout << "Built " << file << ": " << pdb->entries << " entries, "
+                 << pdb->bytes() / (1024.0 * 1024.0) << " MB, " << report.seconds << " s, depth "
+                 << report.max_depth << ", " << report.saturated << " saturated, " << threads << " threads\n";
+            if (!pdb->save(file)) return 1;
+        }
+        views.push_back(pdb.get());
+        pdbs.push_back(move(pdb));
+    }
+
+    AdditivePdb heuristic(puzzle, views);
+    IdaStar<AdditivePdb> ida(puzzle, heuristic);
+    mt19937_64 rng(1);
+
+    double total_ms = 0;
+    uint64_t total_nodes = 0;
+    for (int i = 0; i < instances; ++i) {
+        TileBoard board = puzzle.random_board(rng);
+        auto t0 = chrono::steady_clock::now();
+        int length = ida.solve(board);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        total_ms += ms;
+        total_nodes += ida.nodes;
+        cout << "Instance " << i << ": " << length << " moves, " << ida.nodes << " nodes, " << ms << " ms\n";
+    }
+
+    if (instances > 0) {
+        cout << "\n=== Summary ===\n";
+        cout << "Average time: " << total_ms / instances << " ms\n";
+        cout << "Average nodes: " << total_nodes / instances << "\n";
+    }
+    return 0;
+}
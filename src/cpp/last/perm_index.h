@@ -0,0 +1,130 @@
+#ifndef PERM_INDEX_H
+#define PERM_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Perfect hashing of (partial) permutations for puzzle search.
+//
+// A partial permutation is k distinct items from [0, n); k == n gives a
+// full permutation. Ranks are lexicographic: digit i is items[i] minus the
+// number of smaller items already used, found with one popcount over a
+// bitmask of used items. Unranking picks the digit-th unused item with a
+// bit select (pdep under BMI2, a byte-wise popcount scan otherwise), so
+// rank and unrank are O(k).
+
+const int MAX_PERM_ITEMS = 25;
+
+// falling_factorial(n, k) = n! / (n - k)!, or 0 if it overflows 64 bits.
+inline uint64_t falling_factorial(int n, int k) {
+    struct Table {
+        uint64_t v[MAX_PERM_ITEMS + 1][MAX_PERM_ITEMS + 1] = {};
+        Table() {
+            for (int a = 0; a <= MAX_PERM_ITEMS; ++a) {
+                v[a][0] = 1;
+                for (int b = 1; b <= a; ++b) {
+                    uint64_t prev = v[a][b - 1];
+                    uint64_t mul = a - b + 1;
+                    v[a][b] = (prev == 0 || prev > UINT64_MAX / mul) ? 0 : prev * mul;
+                }
+            }
+        }
+    };
+    static const Table table;
+    return table.v[n][k];
+}
+
+inline uint64_t factorial(int n) {
+    return falling_factorial(n, n);
+}
+
+// Position of the j-th (from 0) set bit of mask, which must have more than
+// j bits set
+inline int select_bit(uint32_t mask, int j) {
+#ifdef __BMI2__
+    return __builtin_ctz(_pdep_u32(1u << j, mask));
+#else
+    int base = 0;
+    for (int c; j >= (c = __builtin_popcount(mask & 0xff)); j -= c) {
+        mask >>= 8;
+        base += 8;
+    }
+    while (j--) mask &= mask - 1; // at most 7 steps inside the byte
+    return base + __builtin_ctz(mask);
+#endif
+}
+
+class PermutationIndexer {
+public:
+    int n = 0, k = 0;
+    uint64_t count = 0; // number of ranks, n! / (n - k)!
+    array<uint64_t, MAX_PERM_ITEMS> weight{};
+
+    PermutationIndexer() = default;
+    PermutationIndexer(int n, int k) : n(n), k(k), count(falling_factorial(n, k)) {
+        for (int i = 0; i < k; ++i) weight[i] = falling_factorial(n - 1 - i, k - 1 - i);
+    }
+
+    template <class T>
+    uint64_t rank(const T* items) const {
+        uint32_t used = 0;
+        uint64_t r = 0;
+        for (int i = 0; i < k; ++i) {
+            uint32_t p = items[i];
+            r += (p - __builtin_popcount(used & ((1u << p) - 1))) * weight[i];
+            used |= 1u << p;
+        }
+        return r;
+    }
+
+    template <class T>
+    void unrank(uint64_t r, T* items) const {
+        uint32_t unused = n == 32 ? ~0u : (1u << n) - 1;
+        for (int i = 0; i < k; ++i) {
+            uint64_t digit = r / weight[i];
+            r -= digit * weight[i];
+            int p = select_bit(unused, (int)digit);
+            items[i] = p;
+            unused &= ~(1u << p);
+        }
+    }
+};
+
+// Visited set and parent links for search over ranked states, one flat
+// array indexed by rank. The root is its own parent. Word holds one parent
+// rank; the largest value marks unvisited, so every rank must be below it
+// (use uint64_t past 2^32 - 1 states).
+template <class Word = uint32_t>
+struct RankParentTable {
+    static constexpr Word UNVISITED = numeric_limits<Word>::max();
+
+    vector<Word> parent;
+
+    explicit RankParentTable(uint64_t states) {
+        if (states > UNVISITED) throw length_error("RankParentTable: too many states for the parent word");
+        parent.assign(states, UNVISITED);
+    }
+
+    bool visited(uint64_t r) const { return parent[r] != UNVISITED; }
+    void set(uint64_t r, uint64_t from) { parent[r] = from; }
+
+    // Ranks from the root down to r.
+    vector<uint64_t> path_to(uint64_t r) const {
+        vector<uint64_t> path = {r};
+        while (parent[r] != r) {
+            r = parent[r];
+            path.push_back(r);
+        }
+        return vector<uint64_t>(path.rbegin(), path.rend());
+    }
+};
+
+#endif // PERM_INDEX_H
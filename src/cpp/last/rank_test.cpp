@@ -1,58 +1,91 @@
-#include <queue>
+// Pattern-key check: ranks the cells of a pattern's tiles on random boards
+// with PermutationIndexer and compares against the textbook factorial rank
+// it replaced (the key the .pdb files were built with), and checks that
+// unrank gives the cells back. Prints the time per key for both.
+// Usage: rank_test [rows] [cols] [pattern_size] [boards] [seed]
+// The pattern is tiles 1..pattern_size. Exits 1 on any mismatch.
+#include "tile_puzzle.h"
+#include "perm_index.h"
+#include <chrono>
 #include <iostream>
-#include <fstream>
-#include <cassert>
-#include <set>
-#include <filesystem>
+#include <string>
 #include <vector>
-#include <algorithm>
 
+using namespace std;
 
-// Factorial function for computing pattern sizes
-size_t factorial(int n) {
-    size_t result = 1;
-    for (int i = 2; i <= n; i++) {
-        result *= i;
-    }
-    return result;
+// Partial-permutation rank of the tiles' cells. TileBoard keeps the cell of
+// each tile, so this is O(count).
+uint64_t pattern_key(const PermutationIndexer& indexer, const TileBoard& board, const int* tiles, int count) {
+    uint8_t positions[MAX_TILES];
+    for (int i = 0; i < count; i++) positions[i] = board.pos[tiles[i]];
+    return indexer.rank(positions);
 }
 
-// Compute a pattern key using bitwise packing
-uint64_t computePatternKeyInternal(const Puzzle &puzzle, const int *tiles, int count) {
+// Reference: lexicographic rank from factorials, O(count^2)
+uint64_t pattern_key_reference(const TileBoard& board, int size, const int* tiles, int count) {
+    auto falling = [](int n, int k) {
+        uint64_t result = 1;
+        for (int i = 0; i < k; i++) result *= n - i;
+        return result;
+    };
+    vector<int> positions(count);
+    for (int i = 0; i < count; i++) positions[i] = board.pos[tiles[i]];
     uint64_t key = 0;
-    std::vector<int> positions;
-
-    // Extract positions of relevant tiles in the puzzle
-    for (int i = 0; i < count; i++) {
-        for (int idx = 0; idx < Puzzle::SIZE; idx++) {
-            if (puzzle.tiles[idx] == tiles[i]) {
-                positions.push_back(idx);
-                break;
-            }
-        }
-    }
-    // cout << "Positions: ";
-    // for (int i = 0; i < count; i++) {
-    //     cout << positions[i] << " ";
-    // }
-    // cout << endl;
-    
-    // Compute lexicographic rank
     for (int i = 0; i < count; i++) {
         for (int j = i + 1; j < count; j++) {
-            if (positions[j] > positions[i]) {
-                positions[j]--;
-            }
+            if (positions[j] > positions[i]) positions[j]--;
         }
-        key += positions[i] * factorial(Puzzle::SIZE - i - 1) / factorial(Puzzle::SIZE - count);
-        // cout << "Key_"<<i<<": " << key << endl;
+        key += positions[i] * falling(size - 1 - i, count - 1 - i);
+    }
+    return key;
+}
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? stoi(argv[1]) : 4;
+    int cols = argc > 2 ? stoi(argv[2]) : 4;
+    int pattern_size = argc > 3 ? stoi(argv[3]) : 7;
+    int boards = argc > 4 ? stoi(argv[4]) : 100000;
+    uint64_t seed = argc > 5 ? stoull(argv[5]) : 1;
+
+    TilePuzzle puzzle(rows, cols);
+    if (pattern_size <= 0 || pattern_size >= puzzle.size) {
+        cerr << "pattern_size must be 1 to " << puzzle.size - 1 << endl;
+        return 1;
     }
+    vector<int> tiles(pattern_size);
+    for (int i = 0; i < pattern_size; i++) tiles[i] = i + 1;
+    PermutationIndexer indexer(puzzle.size, pattern_size);
 
-    // Validate key before returning
-    uint64_t max_key = factorial(16) / factorial(16 - count);
-    if (key >= max_key) {
-        std::cerr << "Error: computePatternKeyInternal() produced an out-of-bounds key! key=" << key << ", max=" << max_key << "\n";
-        return 0;
+    mt19937_64 rng(seed);
+    vector<TileBoard> sample(boards);
+    for (TileBoard& board : sample) board = puzzle.random_board(rng);
+
+    auto time_ns = [&](auto&& key, uint64_t& checksum) {
+        auto t0 = chrono::steady_clock::now();
+        for (const TileBoard& board : sample) checksum += key(board);
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count() / max(boards, 1);
+    };
+    uint64_t sum_fast = 0, sum_reference = 0;
+    double fast_ns = time_ns([&](const TileBoard& b) { return pattern_key(indexer, b, tiles.data(), pattern_size); },
+                             sum_fast);
+    double reference_ns = time_ns(
+        [&](const TileBoard& b) { return pattern_key_reference(b, puzzle.size, tiles.data(), pattern_size); },
+        sum_reference);
+
+    int mismatches = 0;
+    for (const TileBoard& board : sample) {
+        uint64_t key = pattern_key(indexer, board, tiles.data(), pattern_size);
+        uint8_t cells[MAX_TILES];
+        indexer.unrank(key, cells);
+        bool ok = key < indexer.count && key == pattern_key_reference(board, puzzle.size, tiles.data(), pattern_size);
+        for (int i = 0; i < pattern_size; i++) ok &= cells[i] == board.pos[tiles[i]];
+        if (!ok && ++mismatches <= 5) cerr << "Mismatch: key " << key << endl;
     }
 
-    return key;
\ No newline at end of file
+    cout << rows << "x" << cols << ", tiles 1-" << pattern_size << ", " << indexer.count << " keys, " << boards
+         << " boards\n";
+    cout << "PermutationIndexer: " << fast_ns << " ns/key, reference: " << reference_ns << " ns/key"
+         << (sum_fast == sum_reference ? "" : " (checksums differ)") << "\n";
+    cout << "Mismatches: " << mismatches << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
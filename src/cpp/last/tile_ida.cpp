@@ -0,0 +1,62 @@
+// IDA* with incremental Manhattan + linear conflict on random N x M puzzles.
+// Usage: tile_ida [rows] [cols] [instances] [walk] [seed]
+// walk = 0 draws uniformly random solvable boards; otherwise boards are
+// random walks of that many moves from the goal.
+#include "tile_puzzle.h"
+#include "ida_star.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Replays the blank moves and checks that they reach the goal.
+bool verify_solution(const TilePuzzle& puzzle, TileBoard board, const vector<int>& solution) {
+    for (int to : solution) {
+        bool legal = false;
+        for (int k = 0; k < puzzle.num_moves[board.blank]; ++k)
+            legal |= puzzle.moves[board.blank][k] == to;
+        if (!legal) return false;
+        board.move(to);
+    }
+    return puzzle.is_goal(board);
+}
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? stoi(argv[1]) : 4;
+    int cols = argc > 2 ? stoi(argv[2]) : 4;
+    int instances = argc > 3 ? stoi(argv[3]) : 10;
+    int walk = argc > 4 ? stoi(argv[4]) : 0;
+    uint64_t seed = argc > 5 ? stoull(argv[5]) : 1;
+
+    if (rows < 2 || cols < 2 || rows > MAX_SIDE || cols > MAX_SIDE) {
+        cerr << "Board sides must be between 2 and " << MAX_SIDE << endl;
+        return 1;
+    }
+
+    TilePuzzle puzzle(rows, cols);
+    ManhattanLC heuristic(puzzle);
+    IdaStar<ManhattanLC> ida(puzzle, heuristic);
+    mt19937_64 rng(seed);
+
+    uint64_t total_nodes = 0;
+    double total_ms = 0;
+    for (int i = 0; i < instances; ++i) {
+        TileBoard board = walk > 0 ? puzzle.random_walk(rng, walk) : puzzle.random_board(rng);
+
+        auto t0 = chrono::steady_clock::now();
+        int length = ida.solve(board);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+        total_nodes += ida.nodes;
+        total_ms += ms;
+        cout << "Instance " << i << ": " << length << " moves, " << ida.nodes << " nodes, "
+             << ms << " ms" << (verify_solution(puzzle, board, ida.solution) ? "" : "  INVALID SOLUTION") << "\n";
+    }
+
+    cout << "\n=== Summary ===\n";
+    cout << "Instances: " << instances << "\n";
+    cout << "Average time: " << total_ms / instances << " ms\n";
+    cout << "Nodes/s: " << (total_ms > 0 ? total_nodes / (total_ms / 1000.0) : 0) << "\n";
+    return 0;
+}
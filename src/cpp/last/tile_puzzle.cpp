@@ -0,0 +1,115 @@
+#include "tile_puzzle.h"
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+TilePuzzle::TilePuzzle(int rows, int cols) : rows(rows), cols(cols), size(rows * cols) {
+    const int DR[4] = {-1, 0, 0, 1};
+    const int DC[4] = {0, -1, 1, 0};
+    for (int p = 0; p < size; ++p) {
+        int r = p / cols, c = p % cols;
+        row_of[p] = r;
+        col_of[p] = c;
+        num_moves[p] = 0;
+        for (int k = 0; k < 4; ++k) {
+            int nr = r + DR[k], nc = c + DC[k];
+            if (nr >= 0 && nr < rows && nc >= 0 && nc < cols)
+                moves[p][num_moves[p]++] = nr * cols + nc;
+        }
+    }
+    goal_pos[0] = size - 1;
+    for (int t = 1; t < size; ++t) goal_pos[t] = t - 1;
+    for (int t = 0; t < size; ++t) {
+        for (int p = 0; p < size; ++p) {
+            md[t][p] = t == 0 ? 0 : abs(row_of[p] - row_of[goal_pos[t]]) + abs(col_of[p] - col_of[goal_pos[t]]);
+        }
+    }
+}
+
+PackedTiles TilePuzzle::pack(const TileBoard& board) const {
+    PackedTiles state = 0;
+    for (int p = 0; p < size; ++p) state |= (PackedTiles)board.tiles[p] << (4 * p);
+    return state;
+}
+
+TileBoard TilePuzzle::unpack(PackedTiles state) const {
+    TileBoard board;
+    for (int p = 0; p < size; ++p) {
+        board.tiles[p] = tile_at(state, p);
+        board.pos[board.tiles[p]] = p;
+    }
+    board.blank = board.pos[0];
+    return board;
+}
+
+PackedTiles TilePuzzle::goal_packed() const {
+    return pack(goal_board());
+}
+
+TileBoard TilePuzzle::make_board(const vector<int>& tiles) const {
+    TileBoard board;
+    for (int p = 0; p < size; ++p) {
+        board.tiles[p] = tiles[p];
+        board.pos[tiles[p]] = p;
+    }
+    board.blank = board.pos[0];
+    return board;
+}
+
+TileBoard TilePuzzle::goal_board() const {
+    vector<int> tiles(size);
+    for (int t = 0; t < size; ++t) tiles[goal_pos[t]] = t;
+    return make_board(tiles);
+}
+
+bool TilePuzzle::is_goal(const TileBoard& board) const {
+    for (int t = 0; t < size; ++t)
+        if (board.pos[t] != goal_pos[t]) return false;
+    return true;
+}
+
+// Solvable iff the parity of the cell->goal-cell permutation matches the
+// parity of the blank's Manhattan distance to its goal cell.
+bool TilePuzzle::is_solvable(const TileBoard& board) const {
+    array<bool, MAX_TILES> seen{};
+    int transpositions = 0;
+    for (int p = 0; p < size; ++p) {
+        if (seen[p]) continue;
+        int len = 0;
+        for (int q = p; !seen[q]; q = goal_pos[board.tiles[q]]) {
+            seen[q] = true;
+            ++len;
+        }
+        transpositions += len - 1;
+    }
+    int blank_dist = abs(row_of[board.blank] - row_of[size - 1]) + abs(col_of[board.blank] - col_of[size - 1]);
+    return transpositions % 2 == blank_dist % 2;
+}
+
+TileBoard TilePuzzle::random_board(mt19937_64& rng) const {
+    vector<int> tiles(size);
+    iota(tiles.begin(), tiles.end(), 0);
+    shuffle(tiles.begin(), tiles.end(), rng);
+    TileBoard board = make_board(tiles);
+    if (!is_solvable(board)) {
+        // Swapping two non-blank tiles flips the permutation parity
+        int a = board.tiles[0] ? 0 : 2, b = board.tiles[1] ? 1 : 2;
+        swap(tiles[a], tiles[b]);
+        board = make_board(tiles);
+    }
+    return board;
+}
+
+TileBoard TilePuzzle::random_walk(mt19937_64& rng, int walk) const {
+    TileBoard board = goal_board();
+    int prev = -1;
+    for (int i = 0; i < walk; ++i) {
+        int to;
+        do {
+            to = moves[board.blank][rng() % num_moves[board.blank]];
+        } while (to == prev);
+        prev = board.blank;
+        board.move(to);
+    }
+    return board;
+}
@@ -0,0 +1,81 @@
+#ifndef TILE_PUZZLE_H
+#define TILE_PUZZLE_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Generalized rows x cols sliding-tile puzzle (3x3, 4x4, 5x5, ...).
+// Goal layout follows SlidingPuzzle: tiles 1..n-1 in order, blank (0) last.
+//
+// Boards of up to 16 cells pack into one uint64_t at 4 bits per tile
+// (cell i in bits [4i, 4i+4)). Larger boards (5x5) use TileBoard only.
+
+const int MAX_TILES = 25;
+const int MAX_SIDE = 5;
+
+using PackedTiles = uint64_t;
+
+// Mutable board for in-place search: tile at each cell and cell of each tile.
+struct TileBoard {
+    array<uint8_t, MAX_TILES> tiles;
+    array<uint8_t, MAX_TILES> pos;
+    int blank;
+
+    // Slide the tile at `from` into the blank.
+    void move(int from) {
+        uint8_t tile = tiles[from];
+        tiles[blank] = tile;
+        pos[tile] = blank;
+        tiles[from] = 0;
+        pos[0] = from;
+        blank = from;
+    }
+};
+
+class TilePuzzle {
+public:
+    int rows, cols, size;
+
+    // Precomputed move table: cells the blank can move to from each cell.
+    array<array<int8_t, 4>, MAX_TILES> moves;
+    array<int8_t, MAX_TILES> num_moves;
+    array<int8_t, MAX_TILES> row_of, col_of;
+    // Goal cell of each tile and Manhattan distance of tile t at cell p.
+    array<int8_t, MAX_TILES> goal_pos;
+    array<array<int8_t, MAX_TILES>, MAX_TILES> md;
+
+    TilePuzzle(int rows, int cols);
+
+    bool fits_packed() const { return size <= 16; }
+    PackedTiles pack(const TileBoard& board) const;
+    TileBoard unpack(PackedTiles state) const;
+    PackedTiles goal_packed() const;
+
+    static int tile_at(PackedTiles state, int cell) { return (state >> (4 * cell)) & 0xF; }
+
+    // Allocation-free successor generation on a packed state: calls
+    // f(next_state, next_blank) for each legal blank move.
+    template <class F>
+    void for_each_successor(PackedTiles state, int blank, F&& f) const {
+        for (int k = 0; k < num_moves[blank]; ++k) {
+            int to = moves[blank][k];
+            uint64_t tile = (state >> (4 * to)) & 0xF;
+            f(state ^ (tile << (4 * to)) ^ (tile << (4 * blank)), to);
+        }
+    }
+
+    TileBoard make_board(const vector<int>& tiles) const;
+    TileBoard goal_board() const;
+    bool is_goal(const TileBoard& board) const;
+    bool is_solvable(const TileBoard& board) const;
+
+    // Uniformly random solvable board, or a random walk of `walk` moves from the goal.
+    TileBoard random_board(mt19937_64& rng) const;
+    TileBoard random_walk(mt19937_64& rng, int walk) const;
+};
+
+#endif // TILE_PUZZLE_H
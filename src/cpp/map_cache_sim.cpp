@@ -0,0 +1,86 @@
+// Map cache sizing: replays a skewed stream of queries over many maps
+// through a MapRegistry for each memory budget and reports hit rate, waits
+// on loads already in flight, loads, evictions and query throughput, so the
+// budget can be picked from the knee of the curve.
+// Usage: map_cache_sim [budgets_mb] [threads] [queries] [zipf_s] [fastmap_dims] map_file...
+// budgets_mb: comma-separated, 0 = unlimited. Map k (in the order given) is
+// asked for with probability proportional to 1 / (k + 1)^zipf_s.
+#include "map_registry.h"
+#include "grid_astar.h"
+#include "node_store.h"
+#include "bench_util.h"
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    string budgets = argc > 1 ? argv[1] : "16,64,256,0";
+    int threads = argc > 2 ? stoi(argv[2]) : (int)max(1u, thread::hardware_concurrency());
+    int queries = argc > 3 ? stoi(argv[3]) : 2000;
+    double zipf_s = argc > 4 ? stod(argv[4]) : 1.0;
+    int fastmap_dims = argc > 5 ? stoi(argv[5]) : 0;
+    vector<string> map_files(argv + min(argc, 6), argv + argc);
+    if (map_files.empty()) {
+        cerr << "No map files given" << endl;
+        return 1;
+    }
+
+    vector<double> cumulative;
+    double total = 0;
+    for (size_t k = 0; k < map_files.size(); ++k) cumulative.push_back(total += pow(k + 1.0, -zipf_s));
+
+    cout << map_files.size() << " maps, " << queries << " queries, " << threads << " threads, zipf s = " << zipf_s
+         << "\n";
+    cout << setw(10) << "budget_mb" << setw(10) << "hit_rate" << setw(8) << "waits" << setw(8) << "loads"
+         << setw(11) << "evictions"
+         << setw(12) << "peak_mb" << setw(10) << "load_s" << setw(10) << "q/s" << "\n";
+    stringstream list(budgets);
+    for (string item; getline(list, item, ',');) {
+        MapRegistryOptions options;
+        options.memory_budget = (size_t)(stod(item) * 1048576);
+        options.fastmap_dims = fastmap_dims;
+        MapRegistry registry(options);
+
+        atomic<int> next{0}, failures{0};
+        atomic<size_t> peak_bytes{0};
+        auto worker = [&](int seed) {
+            mt19937_64 rng(seed);
+            FlatNodeStore store;
+            while (next.fetch_add(1) < queries) {
+                double u = (rng() >> 11) * 0x1.0p-53 * total;
+                size_t k = lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+                MapHandle map = registry.acquire(map_files[min(k, map_files.size() - 1)]);
+                if (!map) {
+                    ++failures;
+                    continue;
+                }
+                const GridMap& grid = map->grid;
+                pii start = grid.cell(rng() % grid.size()), goal = grid.cell(rng() % grid.size());
+                if (map->components.connected(start, goal)) grid_a_star(grid, start, goal, store);
+                size_t resident = registry.stats().resident_bytes;
+                for (size_t seen = peak_bytes; resident > seen && !peak_bytes.compare_exchange_weak(seen, resident);) {
+                }
+            }
+        };
+        Timer timer;
+        vector<thread> pool;
+        for (int t = 0; t < threads; ++t) pool.emplace_back(worker, t + 1);
+        for (thread& t : pool) t.join();
+        double seconds = timer.seconds();
+
+        MapRegistryStats s = registry.stats();
+        cout << setw(10) << item << setw(10) << fixed << setprecision(3) << s.hit_rate() << setw(8) << s.waits
+             << setw(8) << s.loads << setw(11) << s.evictions
+             << setw(12) << setprecision(1) << peak_bytes / 1048576.0 << setw(10) << setprecision(2)
+             << s.load_seconds << setw(10) << setprecision(0) << queries / seconds << "\n";
+        if (failures > 0) cout << "  " << failures << " queries on maps that failed to load\n";
+    }
+    return 0;
+}
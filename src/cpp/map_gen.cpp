@@ -0,0 +1,235 @@
+#include "map_gen.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <random>
+
+// Portable draws: the std distributions are implementation-defined, so maps
+// would differ between standard libraries.
+static double uniform(mt19937_64& rng) {
+    return (rng() >> 11) * 0x1.0p-53;
+}
+
+static int below(mt19937_64& rng, int n) {
+    return n > 0 ? (int)(rng() % (uint64_t)n) : 0;
+}
+
+static void fill_rect(GridMap& map, int r0, int c0, int r1, int c1, uint8_t value) {
+    r0 = max(r0, 0), c0 = max(c0, 0), r1 = min(r1, map.rows), c1 = min(c1, map.cols);
+    if (c1 <= c0) return;
+    for (int r = r0; r < r1; ++r) {
+        uint8_t* row = &map.passable[map.index(r, c0)];
+        fill(row, row + (c1 - c0), value);
+    }
+}
+
+static void generate_random(GridMap& map, const MapGenOptions& o, mt19937_64& rng) {
+    for (uint8_t& cell : map.passable) cell = uniform(rng) >= o.density;
+}
+
+// Randomized depth-first spanning tree over a grid of n_rows x n_cols nodes;
+// calls link(a, b) for every tree edge (node = i * n_cols + j). Iterative, so
+// 16k-wide mazes do not overflow the call stack.
+template <class Link>
+static void spanning_tree(int n_rows, int n_cols, mt19937_64& rng, Link link) {
+    if (n_rows <= 0 || n_cols <= 0) return;
+    vector<uint8_t> visited((size_t)n_rows * n_cols, 0);
+    vector<int> stack = {below(rng, n_rows * n_cols)};
+    visited[stack[0]] = 1;
+    while (!stack.empty()) {
+        int node = stack.back();
+        int i = node / n_cols, j = node % n_cols;
+        int options[4], k = 0;
+        if (i > 0 && !visited[node - n_cols]) options[k++] = node - n_cols;
+        if (i + 1 < n_rows && !visited[node + n_cols]) options[k++] = node + n_cols;
+        if (j > 0 && !visited[node - 1]) options[k++] = node - 1;
+        if (j + 1 < n_cols && !visited[node + 1]) options[k++] = node + 1;
+        if (k == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int next = options[below(rng, k)];
+        visited[next] = 1;
+        link(node, next);
+        stack.push_back(next);
+    }
+}
+
+static void generate_rooms(GridMap& map, const MapGenOptions& o, mt19937_64& rng) {
+    int size = max(1, o.room_size);
+    int pitch = size + 1;
+    for (int r = size; r < map.rows; r += pitch) fill_rect(map, r, 0, r + 1, map.cols, 0);
+    for (int c = size; c < map.cols; c += pitch) fill_rect(map, 0, c, map.rows, c + 1, 0);
+
+    int n_rows = (map.rows + pitch - 1) / pitch;
+    int n_cols = (map.cols + pitch - 1) / pitch;
+    // Door in the wall between room a and its right or lower neighbour b
+    auto door = [&](int a, int b) {
+        int i = a / n_cols, j = a % n_cols;
+        int width = max(1, min(o.door_width, size));
+        if (b == a + 1) {
+            int extent = min(size, map.rows - i * pitch);
+            int r = i * pitch + below(rng, max(1, extent - width + 1));
+            fill_rect(map, r, j * pitch + size, r + width, j * pitch + size + 1, 1);
+        } else {
+            int extent = min(size, map.cols - j * pitch);
+            int c = j * pitch + below(rng, max(1, extent - width + 1));
+            fill_rect(map, i * pitch + size, c, i * pitch + size + 1, c + width, 1);
+        }
+    };
+    vector<uint8_t> tree_edge((size_t)n_rows * n_cols * 2, 0); // [room][right, down]
+    spanning_tree(n_rows, n_cols, rng, [&](int a, int b) {
+        int lo = min(a, b), hi = max(a, b);
+        tree_edge[(size_t)lo * 2 + (hi == lo + 1 ? 0 : 1)] = 1;
+    });
+    for (int a = 0; a < n_rows * n_cols; ++a) {
+        int i = a / n_cols, j = a % n_cols;
+        if (j + 1 < n_cols && (tree_edge[(size_t)a * 2] || uniform(rng) < o.extra_doors)) door(a, a + 1);
+        if (i + 1 < n_rows && (tree_edge[(size_t)a * 2 + 1] || uniform(rng) < o.extra_doors)) door(a, a + n_cols);
+    }
+}
+
+static void generate_maze(GridMap& map, const MapGenOptions& o, mt19937_64& rng) {
+    int w = max(1, o.corridor_width);
+    fill(map.passable.begin(), map.passable.end(), 0);
+    int n_rows = map.rows >= w ? (map.rows - w) / (2 * w) + 1 : 0;
+    int n_cols = map.cols >= w ? (map.cols - w) / (2 * w) + 1 : 0;
+    for (int i = 0; i < n_rows; ++i)
+        for (int j = 0; j < n_cols; ++j) fill_rect(map, i * 2 * w, j * 2 * w, i * 2 * w + w, j * 2 * w + w, 1);
+    spanning_tree(n_rows, n_cols, rng, [&](int a, int b) {
+        int lo = min(a, b), hi = max(a, b);
+        int i = lo / n_cols, j = lo % n_cols;
+        if (hi == lo + 1) fill_rect(map, i * 2 * w, j * 2 * w + w, i * 2 * w + w, j * 2 * w + 2 * w, 1);
+        else fill_rect(map, i * 2 * w + w, j * 2 * w, i * 2 * w + 2 * w, j * 2 * w + w, 1);
+    });
+}
+
+static void generate_islands(GridMap& map, const MapGenOptions& o, mt19937_64& rng) {
+    size_t target = min(map.size(), (size_t)(max(0.0, o.density) * map.size()));
+    int max_radius = max(1, o.island_radius);
+    for (size_t blocked = 0; blocked < target;) {
+        int cr = below(rng, map.rows), cc = below(rng, map.cols);
+        int ry = 1 + below(rng, max_radius);
+        int rx = max(1, (int)(ry * (0.5 + uniform(rng)))); // aspect ratio 1:2 .. 3:2
+        for (int r = max(0, cr - ry); r <= min(map.rows - 1, cr + ry); ++r) {
+            double dy = (double)(r - cr) / ry;
+            int half = (int)(rx * sqrt(max(0.0, 1 - dy * dy)));
+            for (int c = max(0, cc - half); c <= min(map.cols - 1, cc + half); ++c) {
+                uint8_t& cell = map.passable[map.index(r, c)];
+                blocked += cell;
+                cell = 0;
+            }
+        }
+    }
+}
+
+GridMap generate_map(const MapGenOptions& options) {
+    GridMap map;
+    map.rows = options.rows;
+    map.cols = options.cols;
+    map.passable.assign(map.size(), 1);
+    mt19937_64 rng(options.seed);
+    switch (options.family) {
+    case MapFamily::Random: generate_random(map, options, rng); break;
+    case MapFamily::Rooms: generate_rooms(map, options, rng); break;
+    case MapFamily::Maze: generate_maze(map, options, rng); break;
+    case MapFamily::Islands: generate_islands(map, options, rng); break;
+    }
+    return map;
+}
+
+bool parse_map_family(const string& spec, MapGenOptions& options) {
+    size_t colon = spec.find(':');
+    string name = spec.substr(0, colon);
+    bool has_param = colon != string::npos;
+    string param = has_param ? spec.substr(colon + 1) : "";
+    if (name == "random") {
+        options.family = MapFamily::Random;
+        if (has_param) options.density = stod(param);
+    } else if (name == "rooms") {
+        options.family = MapFamily::Rooms;
+        if (has_param) options.room_size = stoi(param);
+    } else if (name == "maze") {
+        options.family = MapFamily::Maze;
+        if (has_param) options.corridor_width = stoi(param);
+    } else if (name == "islands") {
+        options.family = MapFamily::Islands;
+        if (has_param) options.density = stod(param);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+string map_family_tag(const MapGenOptions& options) {
+    switch (options.family) {
+    case MapFamily::Random: return "random" + to_string((int)lround(options.density * 100));
+    case MapFamily::Rooms: return "rooms" + to_string(options.room_size);
+    case MapFamily::Maze: return "maze" + to_string(options.corridor_width);
+    case MapFamily::Islands: return "islands" + to_string((int)lround(options.density * 100));
+    }
+    return "";
+}
+
+vector<Scenario> generate_scenarios(const GridMap& map, const ScenarioOptions& options) {
+    size_t free_count = count(map.passable.begin(), map.passable.end(), 1);
+    vector<vector<Scenario>> buckets;
+    if (free_count < 2 || options.per_bucket <= 0) return {};
+
+    mt19937_64 rng(options.seed);
+    int max_starts = options.max_starts > 0 ? options.max_starts : 4 * options.per_bucket;
+    // Path length as counts of straight and diagonal moves, so costs come
+    // out exact rather than as a float sum
+    const uint32_t UNSEEN = UINT32_MAX;
+    vector<uint32_t> straight(map.size()), diagonal(map.size());
+    auto length = [&](int cell) { return straight[cell] + diagonal[cell] * sqrt(2.0); };
+    using QueueElement = pair<double, int>;
+    for (int s = 0; s < max_starts; ++s) {
+        int start;
+        do start = rng() % map.size();
+        while (!map.passable[start]);
+        fill(straight.begin(), straight.end(), UNSEEN);
+        priority_queue<QueueElement, vector<QueueElement>, greater<>> open_list;
+        straight[start] = diagonal[start] = 0;
+        open_list.emplace(0.0, start);
+        // One goal per bucket, reservoir-sampled over the cells settled in it
+        vector<int> chosen, seen;
+        while (!open_list.empty()) {
+            auto [d, cell] = open_list.top();
+            open_list.pop();
+            if (d > length(cell)) continue;
+            if (cell != start) {
+                size_t b = (size_t)(d / 4);
+                if (b >= seen.size()) seen.resize(b + 1, 0), chosen.resize(b + 1, -1);
+                if (below(rng, ++seen[b]) == 0) chosen[b] = cell;
+            }
+            int r = cell / map.cols, c = cell % map.cols;
+            for (int dir = 0; dir < 8; ++dir) {
+                if (!map.can_move(r, c, dir)) continue;
+                int nb = cell + map.dir_offset(dir);
+                uint32_t ns = straight[cell] + !is_diagonal(dir);
+                uint32_t nd = diagonal[cell] + is_diagonal(dir);
+                double candidate = ns + nd * sqrt(2.0);
+                if (straight[nb] == UNSEEN || candidate < length(nb)) {
+                    straight[nb] = ns;
+                    diagonal[nb] = nd;
+                    open_list.emplace(candidate, nb);
+                }
+            }
+        }
+
+        if (buckets.size() < chosen.size()) buckets.resize(chosen.size());
+        for (size_t b = 0; b < chosen.size(); ++b) {
+            if (chosen[b] >= 0 && (int)buckets[b].size() < options.per_bucket)
+                buckets[b].push_back({map.cell(start), map.cell(chosen[b]), length(chosen[b])});
+        }
+
+        bool full = true;
+        for (const auto& bucket : buckets) full &= (int)bucket.size() >= options.per_bucket;
+        if (full && s + 1 >= options.per_bucket) break;
+    }
+
+    vector<Scenario> scenarios;
+    for (const auto& bucket : buckets) scenarios.insert(scenarios.end(), bucket.begin(), bucket.end());
+    return scenarios;
+}
@@ -0,0 +1,55 @@
+#ifndef MAP_GEN_H
+#define MAP_GEN_H
+
+#include "grid_map.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Seeded synthetic .map generators for scaling benchmarks. The same options
+// and seed give the same map on every machine (mt19937_64, no time() or
+// rand()), from 64x64 up to 16k x 16k.
+enum class MapFamily {
+    Random,  // each cell blocked with probability `density`
+    Rooms,   // room_size x room_size rooms, 1-cell walls, doors of door_width
+    Maze,    // perfect maze, corridors and walls corridor_width cells wide
+    Islands, // open map with round islands covering about `density` of it
+};
+
+struct MapGenOptions {
+    MapFamily family = MapFamily::Random;
+    int rows = 512;
+    int cols = 512;
+    uint64_t seed = 1;
+    double density = 0.2;    // Random, Islands
+    int room_size = 16;      // Rooms
+    int door_width = 2;      // Rooms
+    double extra_doors = 0.3; // Rooms: chance of a door beyond the spanning tree
+    int corridor_width = 1;  // Maze
+    int island_radius = 16;  // Islands: largest radius
+};
+
+GridMap generate_map(const MapGenOptions& options);
+
+// Parses "random[:density]", "rooms[:room_size]", "maze[:corridor_width]"
+// or "islands[:density]" into options; false for an unknown family.
+bool parse_map_family(const string& spec, MapGenOptions& options);
+// Short name for file names, e.g. "maze4" or "random20"
+string map_family_tag(const MapGenOptions& options);
+
+// Scenario sampling in the style of the MovingAI benchmarks: problems are
+// grouped into buckets of 4 units of optimal cost, and every bucket that
+// occurs gets up to per_bucket problems. Each sampled start runs one full
+// Dijkstra and contributes at most one goal per bucket, picked uniformly;
+// costs are exact octile path lengths. Every problem is solvable.
+struct ScenarioOptions {
+    int per_bucket = 10;
+    int max_starts = 0; // 0 = 4 * per_bucket
+    uint64_t seed = 1;
+};
+
+vector<Scenario> generate_scenarios(const GridMap& map, const ScenarioOptions& options);
+
+#endif // MAP_GEN_H
@@ -0,0 +1,125 @@
+#include "map_registry.h"
+#include "bench_util.h"
+#include <sstream>
+
+MapRegistry::LoadResult MapRegistry::load(const string& path) const {
+    LoadResult result;
+    // A failure here must reach the promise, or the slot stays loading
+    try {
+        auto map = make_shared<LoadedMap>();
+        map->name = path;
+        if (!load_grid_map(path, map->grid, &result.error)) return result;
+        map->components.build(map->grid);
+        if (options.fastmap_dims > 0) map->embedding = build_fastmap(map->grid, options.fastmap_dims, 1);
+        result.map = move(map);
+    } catch (const exception& e) {
+        result.map = nullptr;
+        result.error = "cannot load map " + path + ": " + e.what();
+    }
+    return result;
+}
+
+MapHandle MapRegistry::acquire(const string& path, string* error) {
+    unique_lock<mutex> lock(registry_mutex);
+    auto it = slots.find(path);
+    if (it != slots.end()) {
+        Slot& slot = it->second;
+        lru.splice(lru.begin(), lru, slot.lru);
+        shared_future<LoadResult> result = slot.result;
+        if (slot.ready) {
+            ++counters.hits;
+            return pin(result.get().map);
+        }
+        // Another thread is loading it
+        ++counters.waits;
+        lock.unlock();
+        const LoadResult& loaded = result.get();
+        if (!loaded.map && error) *error = loaded.error;
+        return pin(loaded.map);
+    }
+
+    promise<LoadResult> loading;
+    Slot& slot = slots[path];
+    slot.result = loading.get_future().share();
+    slot.lru = lru.insert(lru.begin(), path);
+    lock.unlock();
+
+    Timer timer;
+    LoadResult loaded = load(path);
+    double seconds = timer.seconds();
+
+    lock.lock();
+    counters.load_seconds += seconds;
+    Slot& done = slots[path];
+    if (loaded.map) {
+        ++counters.loads;
+        done.ready = true;
+        done.bytes = loaded.map->bytes();
+        counters.resident_bytes += done.bytes;
+    } else {
+        ++counters.load_failures;
+        lru.erase(done.lru);
+        slots.erase(path); // a later acquire retries
+    }
+    MapHandle map = pin(loaded.map);
+    if (!map && error) *error = loaded.error;
+    loading.set_value(move(loaded));
+    evict_locked();
+    return map;
+}
+
+MapHandle MapRegistry::pin(const MapHandle& map) {
+    if (!map) return nullptr;
+    // The handle owns a copy of the registry's reference, which is what
+    // evict_locked counts; it is dropped before released() looks
+    struct Unpin {
+        MapRegistry* registry;
+        mutable MapHandle map;
+        void operator()(const LoadedMap*) const {
+            map.reset();
+            registry->released();
+        }
+    };
+    return MapHandle(map.get(), Unpin{this, map});
+}
+
+void MapRegistry::released() {
+    lock_guard<mutex> lock(registry_mutex);
+    if (options.memory_budget != 0 && counters.resident_bytes > options.memory_budget) evict_locked();
+}
+
+void MapRegistry::evict_locked() {
+    if (options.memory_budget == 0) return;
+    for (auto it = lru.end(); it != lru.begin() && counters.resident_bytes > options.memory_budget;) {
+        --it;
+        Slot& slot = slots[*it];
+        // Loading, or held by a caller besides the registry
+        if (!slot.ready || slot.result.get().map.use_count() > 1) continue;
+        counters.resident_bytes -= slot.bytes;
+        ++counters.evictions;
+        slots.erase(*it);
+        it = lru.erase(it);
+    }
+}
+
+MapRegistryStats MapRegistry::stats() const {
+    lock_guard<mutex> lock(registry_mutex);
+    MapRegistryStats s = counters;
+    s.budget = options.memory_budget;
+    for (const auto& [path, slot] : slots) {
+        if (!slot.ready) continue;
+        ++s.entries;
+        if (slot.result.get().map.use_count() > 1) s.pinned_bytes += slot.bytes;
+    }
+    return s;
+}
+
+string MapRegistry::stats_line() const {
+    MapRegistryStats s = stats();
+    ostringstream out;
+    out << "maps " << s.entries << " resident_mb " << s.resident_bytes / 1048576.0 << " pinned_mb "
+        << s.pinned_bytes / 1048576.0 << " budget_mb " << s.budget / 1048576.0 << " hits " << s.hits << " loads "
+        << s.loads << " waits " << s.waits << " failures " << s.load_failures << " evictions " << s.evictions
+        << " hit_rate " << s.hit_rate() << " load_s " << s.load_seconds;
+    return out.str();
+}
@@ -0,0 +1,103 @@
+#ifndef MAP_REGISTRY_H
+#define MAP_REGISTRY_H
+
+#include "fastmap_embedding.h"
+#include "grid_components.h"
+#include "grid_map.h"
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+// A map plus the data built for it at load time; read-only once loaded and
+// shared by every thread that holds a handle to it.
+struct LoadedMap {
+    string name;
+    GridMap grid;
+    ComponentIndex components;
+    FastMapEmbedding embedding;
+
+    size_t bytes() const {
+        return sizeof(LoadedMap) + grid.passable.capacity() + components.bytes() +
+               embedding.coords.capacity() * sizeof(float);
+    }
+};
+
+// Handles are reference counts: a map evicted from the registry stays alive
+// until the last query holding it drops its handle. Dropping the last handle
+// from an acquire() tells the registry, so handles must not outlive it.
+using MapHandle = shared_ptr<const LoadedMap>;
+
+struct MapRegistryOptions {
+    size_t memory_budget = 0; // bytes of resident maps; 0 = unlimited
+    int fastmap_dims = 0;     // FastMap dimensions built at load (0 = none)
+};
+
+struct MapRegistryStats {
+    uint64_t hits = 0;          // acquire() found the map resident
+    uint64_t loads = 0;         // maps loaded from disk
+    uint64_t waits = 0;         // acquire() waited for another thread's load (not a hit)
+    uint64_t load_failures = 0;
+    uint64_t evictions = 0;
+    double load_seconds = 0;    // total time spent loading
+    size_t entries = 0;         // resident maps
+    size_t resident_bytes = 0;
+    size_t pinned_bytes = 0;    // resident maps held by callers, not evictable
+    size_t budget = 0;
+
+    // Share of acquire() calls that found the map resident and loaded
+    double hit_rate() const {
+        uint64_t lookups = hits + waits + loads + load_failures;
+        return lookups ? (double)hits / lookups : 0;
+    }
+};
+
+// Map cache keyed by file path. acquire() loads a map on first use (once,
+// however many threads ask for it at the same time) and returns a shared
+// read-only handle. After each load, and whenever a caller drops its last
+// handle to a map while the total is over the memory budget, least-recently-
+// used maps are evicted until the resident total fits; maps that some caller
+// still holds are skipped, so the total runs over the budget only while they
+// are in use.
+class MapRegistry {
+public:
+    explicit MapRegistry(const MapRegistryOptions& options) : options(options) {}
+
+    // The map at `path`, or nullptr (with *error set) if it cannot be read
+    MapHandle acquire(const string& path, string* error = nullptr);
+
+    MapRegistryStats stats() const;
+    // One-line summary: "maps <n> resident_mb ... hit_rate ..."
+    string stats_line() const;
+
+private:
+    struct LoadResult {
+        MapHandle map;
+        string error;
+    };
+    struct Slot {
+        shared_future<LoadResult> result;
+        bool ready = false;
+        size_t bytes = 0;
+        list<string>::iterator lru;
+    };
+
+    LoadResult load(const string& path) const;
+    // Caller's handle to a resident map; dropping it calls released()
+    MapHandle pin(const MapHandle& map);
+    void released();
+    void evict_locked();
+
+    MapRegistryOptions options;
+    mutable mutex registry_mutex;
+    unordered_map<string, Slot> slots;
+    list<string> lru; // most recently used first
+    MapRegistryStats counters;
+};
+
+#endif // MAP_REGISTRY_H
@@ -0,0 +1,500 @@
+#include "mapf.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <queue>
+
+static inline uint64_t mix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    return k;
+}
+
+int move_dir(const pii& a, const pii& b) {
+    int dr = b.first - a.first, dc = b.second - a.second;
+    if (dr == 0 && dc == 0) return -1;
+    for (int dir = 0; dir < 8; ++dir)
+        if (DIR_DR[dir] == dr && DIR_DC[dir] == dc) return dir;
+    return -1;
+}
+
+// KeySet
+
+void KeySet::grow() {
+    vector<uint64_t> old;
+    old.swap(slots);
+    size_t size = max<size_t>(1024, old.size() * 2);
+    slots.assign(size, EMPTY);
+    filter.assign(size / 64, 0);
+    mask = size - 1;
+    count = 0;
+    for (uint64_t key : old)
+        if (key != EMPTY) insert(key);
+}
+
+void KeySet::insert(uint64_t key) {
+    if ((count + 1) * 2 > slots.size()) grow();
+    uint64_t h = hash(key);
+    filter[(h >> 32 & mask) >> 6] |= 1ull << (h >> 32 & 63);
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        if (slots[i] == key) return;
+        if (slots[i] == EMPTY) {
+            slots[i] = key;
+            ++count;
+            return;
+        }
+    }
+}
+
+void KeySet::clear() {
+    fill(slots.begin(), slots.end(), EMPTY);
+    fill(filter.begin(), filter.end(), 0);
+    count = 0;
+}
+
+// ReservationTable
+
+void ReservationTable::cover(int cell) {
+    if (cell >= (int)parked.size()) {
+        size_t size = max<size_t>(cell + 1, parked.size() * 2);
+        parked.resize(size, NOT_PARKED);
+        last_vertex.resize(size, -1);
+    }
+    if (parked[cell] == NOT_PARKED && last_vertex[cell] < 0) touched.push_back(cell);
+}
+
+void ReservationTable::add_vertex(int cell, int t) {
+    keys.insert(vertex_key(cell, t));
+    cover(cell);
+    last_vertex[cell] = max(last_vertex[cell], t);
+    horizon = max(horizon, t + 1);
+}
+
+void ReservationTable::add_edge(int from, int dir, int t) {
+    keys.insert(edge_key(from, dir, t));
+    horizon = max(horizon, t + 1);
+}
+
+void ReservationTable::park(int cell, int t) {
+    cover(cell);
+    parked[cell] = min(parked[cell], t);
+    horizon = max(horizon, t + 1);
+}
+
+void ReservationTable::reserve_path(const GridMap& map, const vector<pii>& path) {
+    for (size_t t = 0; t < path.size(); ++t) {
+        int cell = map.index(path[t]);
+        add_vertex(cell, t);
+        if (t == 0) continue;
+        int dir = move_dir(path[t - 1], path[t]);
+        if (dir >= 0) add_edge(cell, OPPOSITE_DIR[dir], t);
+    }
+    if (!path.empty()) park(map.index(path.back()), path.size() - 1);
+}
+
+void ReservationTable::clear() {
+    keys.clear();
+    // CBS clears the table for every child; leave the arrays allocated
+    for (int cell : touched) {
+        parked[cell] = NOT_PARKED;
+        last_vertex[cell] = -1;
+    }
+    touched.clear();
+    horizon = 0;
+}
+
+size_t ReservationTable::bytes() const {
+    return keys.bytes() + (parked.capacity() + last_vertex.capacity() + touched.capacity()) * sizeof(int);
+}
+
+// SpaceTimeAStar
+
+void SpaceTimeAStar::grow_index() {
+    vector<uint64_t> old_key;
+    vector<int> old_node;
+    vector<uint32_t> old_gen;
+    old_key.swap(slot_key);
+    old_node.swap(slot_node);
+    old_gen.swap(slot_gen);
+    size_t size = max<size_t>(1 << 12, old_key.size() * 2);
+    slot_key.assign(size, 0);
+    slot_node.assign(size, 0);
+    slot_gen.assign(size, 0);
+    used = 0;
+    bool added;
+    for (size_t i = 0; i < old_key.size(); ++i)
+        if (old_gen[i] == generation) lookup(old_key[i], added) = old_node[i];
+}
+
+int& SpaceTimeAStar::lookup(uint64_t key, bool& added) {
+    if ((used + 1) * 2 > slot_key.size()) grow_index();
+    size_t mask = slot_key.size() - 1;
+    for (size_t i = mix64(key) & mask;; i = (i + 1) & mask) {
+        if (slot_gen[i] != generation) {
+            slot_gen[i] = generation;
+            slot_key[i] = key;
+            ++used;
+            added = true;
+            return slot_node[i];
+        }
+        if (slot_key[i] == key) {
+            added = false;
+            return slot_node[i];
+        }
+    }
+}
+
+void SpaceTimeAStar::start_reverse(int goal, int start) {
+    if (reverse_nodes.size() != map.size()) reverse_nodes.assign(map.size(), ReverseNode{0, 0, false});
+    reverse_open = {};
+    reverse_target = map.cell(start);
+    reverse_goal = map.cell(goal);
+    reverse_nodes[goal] = {0, generation, false};
+    reverse_open.emplace(Cost::heuristic(map.cell(goal), reverse_target), 0, goal);
+}
+
+uint32_t SpaceTimeAStar::reverse_search(int cell) {
+    // Moves are symmetric, so the reverse search uses the forward rules
+    while (!reverse_open.empty()) {
+        int cur = get<2>(reverse_open.top());
+        reverse_open.pop();
+        ReverseNode& n = reverse_nodes[cur];
+        if (n.closed) continue;
+        n.closed = true;
+        ++reverse_expansions;
+
+        int r = cur / map.cols, c = cur % map.cols;
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!map.can_move(r, c, dir)) continue;
+            int nb = cur + map.dir_offset(dir);
+            ReverseNode& m = reverse_nodes[nb];
+            uint32_t ng = n.g + Cost::step_cost(dir);
+            if (m.generation != generation) m = {ng, generation, false};
+            else if (m.closed || ng >= m.g) continue;
+            else m.g = ng;
+            reverse_open.emplace(ng + Cost::heuristic({r + DIR_DR[dir], c + DIR_DC[dir]}, reverse_target), ~ng, nb);
+        }
+        if (cur == cell) return n.g;
+    }
+    return UNREACHABLE;
+}
+
+uint32_t SpaceTimeAStar::distance_bound(int cell) const {
+    const ReverseNode& n = reverse_nodes[cell];
+    if (n.generation == generation && n.closed) return n.g;
+    if (reverse_open.empty()) return UNREACHABLE;
+    // A cell the reverse search has not closed has g + h(cell, start) >= the
+    // smallest f in its queue
+    pii p = map.cell(cell);
+    uint32_t fmin = get<0>(reverse_open.top());
+    uint32_t to_start = Cost::heuristic(p, reverse_target);
+    return max(Cost::heuristic(p, reverse_goal), fmin > to_start ? fmin - to_start : 0);
+}
+
+bool SpaceTimeAStar::search(int start, int goal, const ReservationTable& table, vector<pii>& path, float* cost) {
+    path.clear();
+    nodes.clear();
+    if (++generation == 0) {
+        fill(slot_gen.begin(), slot_gen.end(), 0);
+        for (ReverseNode& n : reverse_nodes) n.generation = 0;
+        generation = 1;
+    }
+    used = 0;
+
+    // Ties on f go to the node closer to the goal. When the agent has to
+    // wait for the goal to clear, all short waiting plans share one f, and
+    // this keeps the search waiting next to the goal instead of wandering.
+    struct Entry {
+        uint32_t f, h, g;
+        int node;
+        bool operator>(const Entry& o) const { return f > o.f || (f == o.f && h > o.h); }
+    };
+    priority_queue<Entry, vector<Entry>, greater<Entry>> open_list;
+
+    int horizon = table.static_time();
+    int last_on_goal = table.latest(goal);
+
+    // Every step costs at least 1 and the agent cannot stop on its goal
+    // before last_on_goal + 1
+    auto goal_wait = [&](uint32_t h, int t) {
+        return last_on_goal >= t ? max(h, (uint32_t)(last_on_goal + 1 - t) * Cost::G_SCALE) : h;
+    };
+    start_reverse(goal, start);
+    uint32_t h0 = reverse_search(start);
+    if (h0 == UNREACHABLE) return false;
+    h0 = goal_wait(h0, 0);
+
+    bool added;
+    lookup((uint64_t)start, added) = 0;
+    nodes.push_back({start, 0, 0, -1, false});
+    open_list.push({h0, h0, 0, 0});
+
+    uint64_t local = 0;
+    while (!open_list.empty()) {
+        Entry e = open_list.top();
+        open_list.pop();
+        Node& n = nodes[e.node];
+        if (n.closed || e.g != n.g) continue; // stale entry
+        n.closed = true;
+        ++local;
+
+        int cell = n.cell, t = n.t;
+        uint32_t g = n.g;
+        if (cell == goal && t > last_on_goal) {
+            for (int i = e.node; i >= 0; i = nodes[i].parent) path.push_back(map.cell(nodes[i].cell));
+            reverse(path.begin(), path.end());
+            if (cost) *cost = Cost::to_float(g);
+            expansions += local;
+            return true;
+        }
+        if (max_expansions && local >= max_expansions) break;
+
+        int r = cell / map.cols, c = cell % map.cols;
+        int nt = t + 1;
+        uint64_t key_t = (uint64_t)min(nt, horizon) << 32;
+        for (int dir = -1; dir < 8; ++dir) {
+            int next = cell;
+            uint32_t step = Cost::G_SCALE; // wait
+            if (dir >= 0) {
+                if (!map.can_move(r, c, dir) || table.edge_blocked(cell, dir, nt)) continue;
+                next = cell + map.dir_offset(dir);
+                step = Cost::step_cost(dir);
+            }
+            if (table.vertex_blocked(next, nt)) continue;
+
+            uint32_t h = distance_bound(next);
+            if (h == UNREACHABLE) continue;
+            h = goal_wait(h, nt);
+            uint32_t ng = g + step;
+            int& slot = lookup(key_t | (uint32_t)next, added);
+            if (added) {
+                slot = nodes.size();
+                nodes.push_back({next, nt, ng, e.node, false});
+            } else {
+                Node& m = nodes[slot];
+                if (ng >= m.g) continue;
+                m.closed = false; // reopen
+                m.g = ng;
+                m.t = nt;
+                m.parent = e.node;
+            }
+            open_list.push({ng + h, h, ng, slot});
+        }
+    }
+    expansions += local;
+    return false;
+}
+
+// MultiAgentPlanner
+
+MultiAgentPlanner::MultiAgentPlanner(const GridMap& map) : map(map), component(map.size(), -1), search(map) {
+    // Moves are symmetric, so BFS labels are connected components
+    vector<int> queue;
+    int label = 0;
+    for (int s = 0; s < (int)map.size(); ++s) {
+        if (!map.passable[s] || component[s] >= 0) continue;
+        component[s] = label;
+        queue.assign(1, s);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int cur = queue[head];
+            int r = cur / map.cols, c = cur % map.cols;
+            for (int dir = 0; dir < 8; ++dir) {
+                if (!map.can_move(r, c, dir)) continue;
+                int nb = cur + map.dir_offset(dir);
+                if (component[nb] < 0) {
+                    component[nb] = label;
+                    queue.push_back(nb);
+                }
+            }
+        }
+        ++label;
+    }
+}
+
+bool MultiAgentPlanner::reachable(const Agent& agent) const {
+    if (!map.is_passable(agent.start.first, agent.start.second) ||
+        !map.is_passable(agent.goal.first, agent.goal.second))
+        return false;
+    return component[map.index(agent.start)] == component[map.index(agent.goal)];
+}
+
+MapfStats MultiAgentPlanner::plan(const vector<Agent>& agents, vector<vector<pii>>& paths) {
+    Timer timer;
+    MapfStats stats;
+    uint64_t before = search.expansions;
+    search.max_expansions = max_expansions;
+    table.clear();
+    paths.assign(agents.size(), {});
+
+    for (size_t i = 0; i < agents.size(); ++i) {
+        float cost;
+        if (reachable(agents[i]) &&
+            search.search(map.index(agents[i].start), map.index(agents[i].goal), table, paths[i], &cost)) {
+            table.reserve_path(map, paths[i]);
+            stats.planned++;
+            stats.sum_of_costs += cost;
+        } else {
+            paths[i].clear();
+            stats.failed++;
+        }
+    }
+
+    stats.expansions = search.expansions - before;
+    stats.reservation_bytes = table.bytes();
+    stats.seconds = timer.seconds();
+    return stats;
+}
+
+namespace {
+
+struct CbsConstraint {
+    int agent;
+    int cell;
+    int dir; // -1: vertex constraint
+    int t;
+};
+
+struct CbsNode {
+    vector<CbsConstraint> constraints;
+    vector<vector<pii>> paths;
+    vector<float> costs;
+    double cost = 0;
+};
+
+// One side of a conflict: the entry that would forbid this agent's part.
+struct CbsConflict {
+    CbsConstraint side[2];
+};
+
+inline const pii& position(const vector<pii>& path, size_t t) {
+    return path[min(t, path.size() - 1)];
+}
+
+// Earliest conflict between any two paths.
+bool find_conflict(const GridMap& map, const vector<vector<pii>>& paths, CbsConflict& out) {
+    size_t steps = 0;
+    for (const auto& p : paths) steps = max(steps, p.size());
+    for (size_t t = 0; t < steps; ++t) {
+        for (size_t a = 0; a < paths.size(); ++a) {
+            const pii& pa = position(paths[a], t);
+            for (size_t b = a + 1; b < paths.size(); ++b) {
+                const pii& pb = position(paths[b], t);
+                if (pa == pb) {
+                    out.side[0] = {(int)a, map.index(pa), -1, (int)t};
+                    out.side[1] = {(int)b, map.index(pb), -1, (int)t};
+                    return true;
+                }
+                if (t == 0) continue;
+                const pii& qa = position(paths[a], t - 1);
+                const pii& qb = position(paths[b], t - 1);
+                if (pa == qb && pb == qa) {
+                    out.side[0] = {(int)a, map.index(qa), move_dir(qa, pa), (int)t};
+                    out.side[1] = {(int)b, map.index(qb), move_dir(qb, pb), (int)t};
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool MultiAgentPlanner::plan_cbs(const vector<Agent>& agents, vector<vector<pii>>& paths, MapfStats* stats,
+                                 uint64_t max_nodes) {
+    Timer timer;
+    uint64_t before = search.expansions;
+    search.max_expansions = max_expansions;
+    auto finish = [&](bool ok, uint64_t expanded, const CbsNode* node) {
+        if (stats) {
+            *stats = MapfStats();
+            stats->seconds = timer.seconds();
+            stats->expansions = search.expansions - before;
+            stats->cbs_nodes = expanded;
+            stats->planned = ok ? agents.size() : 0;
+            stats->failed = ok ? 0 : agents.size();
+            if (node) stats->sum_of_costs = node->cost;
+        }
+        if (node) paths = node->paths;
+        else paths.assign(agents.size(), {});
+        return ok;
+    };
+
+    // Root: every agent on its own
+    vector<CbsNode> nodes(1);
+    CbsNode& root = nodes[0];
+    root.paths.resize(agents.size());
+    root.costs.resize(agents.size());
+    table.clear();
+    for (size_t i = 0; i < agents.size(); ++i) {
+        if (!reachable(agents[i]) ||
+            !search.search(map.index(agents[i].start), map.index(agents[i].goal), table, root.paths[i],
+                           &root.costs[i]))
+            return finish(false, 0, nullptr);
+        root.cost += root.costs[i];
+    }
+
+    using QueueElement = pair<double, size_t>;
+    priority_queue<QueueElement, vector<QueueElement>, greater<>> open_list;
+    open_list.emplace(root.cost, 0);
+    uint64_t expanded = 0;
+
+    while (!open_list.empty() && expanded < max_nodes) {
+        size_t id = open_list.top().second;
+        open_list.pop();
+        ++expanded;
+
+        CbsConflict conflict;
+        if (!find_conflict(map, nodes[id].paths, conflict)) return finish(true, expanded, &nodes[id]);
+
+        for (const CbsConstraint& c : conflict.side) {
+            CbsNode child = nodes[id];
+            child.constraints.push_back(c);
+
+            table.clear();
+            for (const CbsConstraint& k : child.constraints) {
+                if (k.agent != c.agent) continue;
+                if (k.dir < 0) table.add_vertex(k.cell, k.t);
+                else table.add_edge(k.cell, k.dir, k.t);
+            }
+            const Agent& agent = agents[c.agent];
+            float cost;
+            if (!search.search(map.index(agent.start), map.index(agent.goal), table, child.paths[c.agent], &cost))
+                continue;
+            child.cost += cost - child.costs[c.agent];
+            child.costs[c.agent] = cost;
+            open_list.emplace(child.cost, nodes.size());
+            nodes.push_back(move(child));
+        }
+    }
+    return finish(false, expanded, nullptr);
+}
+
+int count_conflicts(const GridMap& map, const vector<vector<pii>>& paths) {
+    size_t steps = 0;
+    for (const auto& p : paths) steps = max(steps, p.size());
+    vector<int> occupant(map.size(), -1);
+    int conflicts = 0;
+    for (size_t t = 0; t < steps; ++t) {
+        for (size_t a = 0; a < paths.size(); ++a) {
+            if (paths[a].empty()) continue;
+            int cell = map.index(position(paths[a], t));
+            if (occupant[cell] >= 0) conflicts++;
+            else occupant[cell] = a;
+        }
+        // Swaps: b now sits where a was, and a where b was
+        if (t > 0) {
+            for (size_t a = 0; a < paths.size(); ++a) {
+                if (paths[a].empty()) continue;
+                const pii& from = position(paths[a], t - 1);
+                const pii& to = position(paths[a], t);
+                if (from == to) continue;
+                int b = occupant[map.index(from)];
+                if (b > (int)a && position(paths[b], t - 1) == to) conflicts++;
+            }
+        }
+        for (size_t a = 0; a < paths.size(); ++a)
+            if (!paths[a].empty()) occupant[map.index(position(paths[a], t))] = -1;
+    }
+    return conflicts;
+}
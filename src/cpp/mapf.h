@@ -0,0 +1,231 @@
+#ifndef MAPF_H
+#define MAPF_H
+
+#include "grid_map.h"
+#include "node_store.h"
+#include <climits>
+#include <cstdint>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+// Cooperative multi-agent pathfinding on a GridMap.
+//
+// Time is discrete: every action (one of the 8 moves of get_neighbors_8 or a
+// wait) takes one step. Costs follow the octile model: 1 per straight move,
+// sqrt(2) per diagonal, 1 per wait. An agent that reaches its goal stays
+// there. Two agents conflict when they occupy the same cell at the same step
+// (vertex conflict) or swap cells during one step (edge conflict).
+//
+// Paths are indexed by step: path[t] is the agent's cell at time t, from the
+// start at t = 0 to the step it stops at the goal.
+
+struct Agent {
+    pii start;
+    pii goal;
+};
+
+// Open-addressing set of 64-bit keys, linear probing, load factor <= 1/2.
+// A one-bit-per-slot filter in front of the slots answers most misses from
+// a table 1/64 the size of the keys.
+class KeySet {
+public:
+    void insert(uint64_t key);
+    bool contains(uint64_t key) const {
+        if (count == 0) return false;
+        uint64_t h = hash(key);
+        if (!(filter[(h >> 32 & mask) >> 6] >> (h >> 32 & 63) & 1)) return false;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            if (slots[i] == key) return true;
+            if (slots[i] == EMPTY) return false;
+        }
+    }
+    void clear();
+    size_t size() const { return count; }
+    size_t bytes() const { return slots.capacity() * sizeof(uint64_t) + filter.capacity() * sizeof(uint64_t); }
+
+private:
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+    vector<uint64_t> slots;
+    vector<uint64_t> filter;
+    size_t count = 0;
+    size_t mask = 0;
+
+    static uint64_t hash(uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+    void grow();
+};
+
+// Cells and moves that are off limits at given time steps: the paths of
+// agents already planned (prioritized planning) or one agent's constraints
+// (CBS). A vertex entry (cell, t) forbids being at cell at step t; an edge
+// entry (cell, dir, t) forbids the move from cell in direction dir that
+// arrives at step t. A parked cell is blocked from its park time on.
+// Vertex and edge entries share one KeySet of packed (t, cell, dir) keys;
+// park steps and the last reserved step of each cell are dense per-cell
+// arrays, grown to the largest cell seen.
+class ReservationTable {
+public:
+    void add_vertex(int cell, int t);
+    void add_edge(int from, int dir, int t);
+    void park(int cell, int t);
+    // Reserves a planned path: its cells, the reverse of each move (so that
+    // a later agent cannot swap with it) and its goal from arrival on.
+    void reserve_path(const GridMap& map, const vector<pii>& path);
+    void clear();
+
+    bool vertex_blocked(int cell, int t) const {
+        if (cell < (int)parked.size() && parked[cell] <= t) return true;
+        return keys.contains(vertex_key(cell, t));
+    }
+    bool edge_blocked(int from, int dir, int t) const {
+        return keys.contains(edge_key(from, dir, t));
+    }
+    // Last step with a vertex entry on cell, or -1: an agent may only stop
+    // on its goal after that.
+    int latest(int cell) const { return cell < (int)last_vertex.size() ? last_vertex[cell] : -1; }
+    // From this step on the table no longer changes with time.
+    int static_time() const { return horizon; }
+    size_t bytes() const;
+
+private:
+    static constexpr int NOT_PARKED = INT_MAX;
+    KeySet keys;
+    vector<int> parked;      // first blocked step, NOT_PARKED if never
+    vector<int> last_vertex; // last reserved step, -1 if none
+    vector<int> touched;     // cells with an entry in either, for clear()
+    int horizon = 0;
+
+    void cover(int cell);
+
+    static uint64_t vertex_key(int cell, int t) { return (uint64_t)t << 32 | (uint32_t)cell; }
+    static uint64_t edge_key(int from, int dir, int t) {
+        return 1ull << 63 | (uint64_t)t << 32 | (uint32_t)(from << 3 | dir);
+    }
+};
+
+// A* over (cell, time) that respects a ReservationTable. Once past the
+// table's static_time the step no longer matters, so states are keyed by
+// min(t, static_time) and the search space stays finite. Node pool and
+// state index are reused across searches.
+//
+// The heuristic comes from a reverse A* from the goal to the start, run
+// once per search with reservations ignored. Cells it closed get their
+// exact distance to the goal. For any other cell, the smallest f left in its
+// queue gives the bound d(cell) >= f_min - octile(cell, start), and octile
+// is used when that is larger. Octile alone lets the search flood every
+// (cell, t) pair in front of a wall. Forcing exact values for every cell
+// the search touches (full RRA*) costs more in reverse expansions than it
+// saves. The mixed heuristic is admissible but not consistent, so closed
+// nodes are reopened when a cheaper path reaches them.
+//
+// Costs are fixed point, as in PackedNodeStore. With floats, rounding noise
+// breaks the many exact f ties of an open grid, and the search fans out over
+// every equally short path.
+class SpaceTimeAStar {
+public:
+    using Cost = PackedNodeStore;
+
+    uint64_t expansions = 0;         // over all searches
+    uint64_t reverse_expansions = 0; // heuristic search, over all searches
+    uint64_t max_expansions = 0;     // per search; 0 = unlimited
+
+    explicit SpaceTimeAStar(const GridMap& map) : map(map) {}
+
+    // Cheapest path from start to goal that stops on goal for good, or
+    // false if none exists (or max_expansions ran out).
+    bool search(int start, int goal, const ReservationTable& table, vector<pii>& path, float* cost = nullptr);
+
+private:
+    struct Node {
+        int cell;
+        int t;
+        uint32_t g;
+        int parent;
+        bool closed;
+    };
+
+    const GridMap& map;
+    vector<Node> nodes;
+    // State index: (min(t, static_time), cell) -> node, stamped with the
+    // search generation so it is never cleared.
+    vector<uint64_t> slot_key;
+    vector<int> slot_node;
+    vector<uint32_t> slot_gen;
+    uint32_t generation = 0;
+    size_t used = 0;
+
+    int& lookup(uint64_t key, bool& added);
+    void grow_index();
+
+    // Reverse search state, per cell, stamped with the search generation
+    struct ReverseNode {
+        uint32_t g;
+        uint32_t generation;
+        bool closed;
+    };
+    vector<ReverseNode> reverse_nodes;
+    // (f, ~g, cell): ties on f go to the deeper node
+    using ReverseEntry = tuple<uint32_t, uint32_t, int>;
+    priority_queue<ReverseEntry, vector<ReverseEntry>, greater<>> reverse_open;
+    pii reverse_target, reverse_goal;
+
+    void start_reverse(int goal, int start);
+    static const uint32_t UNREACHABLE = UINT32_MAX;
+    uint32_t reverse_search(int cell); // distance to cell, or UNREACHABLE
+    uint32_t distance_bound(int cell) const;
+};
+
+struct MapfStats {
+    double seconds = 0;
+    uint64_t expansions = 0;
+    int planned = 0;
+    int failed = 0;
+    double sum_of_costs = 0;
+    size_t reservation_bytes = 0;
+    uint64_t cbs_nodes = 0;
+};
+
+class MultiAgentPlanner {
+public:
+    uint64_t max_expansions = 0; // per low-level search; 0 = unlimited
+
+    explicit MultiAgentPlanner(const GridMap& map);
+
+    // Prioritized planning (cooperative A*): agents are planned in order,
+    // each around the reserved paths of all earlier ones. Agents that cannot
+    // be planned get an empty path and reserve nothing. Starts and goals
+    // should be pairwise distinct.
+    MapfStats plan(const vector<Agent>& agents, vector<vector<pii>>& paths);
+
+    // Conflict-based search: optimal sum of costs. Returns false if no
+    // solution was found within max_nodes high-level nodes.
+    bool plan_cbs(const vector<Agent>& agents, vector<vector<pii>>& paths, MapfStats* stats = nullptr,
+                  uint64_t max_nodes = 10000);
+
+    // Start and goal are free and in the same connected component.
+    bool reachable(const Agent& agent) const;
+
+private:
+    const GridMap& map;
+    vector<int> component;
+    SpaceTimeAStar search;
+    ReservationTable table;
+};
+
+// Number of vertex and edge conflicts between non-empty paths, with
+// finished agents waiting at their goal.
+int count_conflicts(const GridMap& map, const vector<vector<pii>>& paths);
+
+// Direction of the move a -> b, or -1 if a == b.
+int move_dir(const pii& a, const pii& b);
+
+#endif // MAPF_H
@@ -0,0 +1,349 @@
+// Microbenchmarks for the search inner loop: neighbor generation, open-list
+// push/pop, heuristics, path reconstruction and encoding, .map/.scen parsing and
+// pattern-key ranking. Each row is ns per operation (one cell, one queue
+// operation, one heuristic call, one path cell, one parsed cell or line,
+// one ranked board).
+// Usage: microbench [filter] [map_file] [scen_file] [repetitions]
+// Without a map file a seeded 1024x1024 rooms map and its scenarios are
+// generated and written to microbench.map(.scen) in the working directory.
+#include "grid_map.h"
+#include "map_gen.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "fastmap_embedding.h"
+#include "path_codec.h"
+#include "microbench.h"
+#include "last/perm_index.h"
+#include "last/tile_puzzle.h"
+#include <cstring>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+const int SAMPLE = 4096;
+
+// ---- Reference copies of the original a_star_map.cpp kernels ----
+
+struct pair_hash {
+    size_t operator()(const pii& p) const {
+        return hash<int>()(p.first) ^ (hash<int>()(p.second) << 1);
+    }
+};
+
+vector<pii> legacy_neighbors_8(const pii& current, const pii& grid_size, const unordered_set<pii, pair_hash>& obstacles) {
+    vector<pii> neighbors;
+    int r = current.first, c = current.second;
+    auto in_bounds = [&](int nr, int nc) { return nr >= 0 && nr < grid_size.first && nc >= 0 && nc < grid_size.second; };
+    for (int i = 0; i < 8; ++i) {
+        int nr = r + DIR_DR[i], nc = c + DIR_DC[i];
+        if (!in_bounds(nr, nc) || obstacles.count({nr, nc})) continue;
+        neighbors.emplace_back(nr, nc);
+    }
+    const int DX_d[4] = {-1, -1, 1, 1};
+    const int DY_d[4] = {-1, 1, -1, 1};
+    for (int i = 0; i < 4; ++i) {
+        int nr = r + DX_d[i], nc = c + DY_d[i];
+        if (!in_bounds(nr, nc)) continue;
+        if (obstacles.count({r, nc}) || obstacles.count({nr, c})) {
+            auto it = find(neighbors.begin(), neighbors.end(), make_pair(nr, nc));
+            if (it != neighbors.end()) neighbors.erase(it);
+        }
+    }
+    return neighbors;
+}
+
+vector<pii> legacy_reconstruct_path(unordered_map<pii, pii, pair_hash>& came_from, pii current) {
+    vector<pii> path = {current};
+    while (came_from.count(current)) {
+        current = came_from[current];
+        path.push_back(current);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+// rank_test.cpp's computePatternKeyInternal on a TileBoard: a board scan
+// for the tiles' cells and an indexer built per call
+uint64_t pattern_key_per_call(const TileBoard& board, int size, const int* tiles, int count) {
+    uint8_t cell_of[MAX_TILES];
+    for (int idx = 0; idx < size; idx++) cell_of[board.tiles[idx]] = idx;
+    uint8_t positions[MAX_TILES];
+    for (int i = 0; i < count; i++) positions[i] = cell_of[tiles[i]];
+    return PermutationIndexer(size, count).rank(positions);
+}
+
+// ---- Open-list traces ----
+
+// Push/pop sequence for a binary-heap open list. Astar keys drift upward
+// the way f-values do in A* (a pushed key is the last popped key plus 0 to
+// ~3, about 2.5 pushes per pop, mostly small steps); Uniform keys are
+// unordered. A negative cell marks a pop.
+enum class KeyDistribution { Astar, Uniform };
+
+vector<pair<float, int>> open_list_trace(KeyDistribution distribution, int ops, uint64_t seed) {
+    mt19937_64 rng(seed);
+    auto unit = [&]() { return (rng() >> 11) * 0x1.0p-53; };
+    vector<pair<float, int>> trace;
+    float last_popped = 0;
+    // Replays pops against a shadow heap to know which key was popped
+    priority_queue<float, vector<float>, greater<>> shadow;
+    while ((int)trace.size() < ops) {
+        bool push = shadow.empty() || unit() < 0.71;
+        if (push) {
+            float key = distribution == KeyDistribution::Astar
+                            ? last_popped + (float)(unit() < 0.6 ? 0.6 * unit() : 0.6 + 2.2 * unit())
+                            : (float)(1000 * unit());
+            int cell = rng() % (1 << 20);
+            trace.push_back({key, cell});
+            shadow.push(key);
+        } else {
+            last_popped = shadow.top();
+            shadow.pop();
+            trace.push_back({0.0f, -1});
+        }
+    }
+    return trace;
+}
+
+template <class Queue, class Encode, class Decode>
+uint64_t replay(const vector<pair<float, int>>& trace, Encode encode, Decode decode) {
+    Queue open_list;
+    uint64_t sum = 0;
+    for (const auto& op : trace) {
+        if (op.second >= 0) {
+            open_list.push(encode(op.first, op.second));
+        } else {
+            sum += decode(open_list.top());
+            open_list.pop();
+        }
+    }
+    return sum + open_list.size();
+}
+
+int main(int argc, char** argv) {
+    MicroBenchOptions options;
+    options.filter = argc > 1 && string(argv[1]) != "all" ? argv[1] : "";
+    string map_file = argc > 2 ? argv[2] : "";
+    string scen_file = argc > 3 ? argv[3] : map_file + ".scen";
+    if (argc > 4) options.repetitions = stoi(argv[4]);
+
+    if (map_file.empty()) {
+        MapGenOptions gen;
+        parse_map_family("rooms:16", gen);
+        gen.rows = gen.cols = 1024;
+        GridMap generated = generate_map(gen);
+        ScenarioOptions scen_options;
+        scen_options.per_bucket = 5;
+        map_file = "microbench.map";
+        scen_file = "microbench.map.scen";
+        if (!write_grid_map(generated, map_file) ||
+            !write_scenarios(generate_scenarios(generated, scen_options), generated, map_file, scen_file))
+            return 1;
+    }
+    GridMap map = read_grid_map(map_file);
+    vector<Scenario> scenarios = read_scenarios(scen_file);
+    cout << "Map " << map_file << " " << map.rows << "x" << map.cols << ", " << scenarios.size()
+         << " scenarios; median of " << options.repetitions << " repetitions\n";
+
+    mt19937_64 rng(1);
+    vector<int> cells;
+    while (cells.size() < SAMPLE) {
+        int i = rng() % map.size();
+        if (map.passable[i]) cells.push_back(i);
+    }
+
+    MicroBench bench(options);
+    MicroBench::print_header();
+
+    bench.section("neighbors (per expanded cell)");
+    if (bench.selected("neighbors/legacy")) {
+        unordered_set<pii, pair_hash> obstacles;
+        for (size_t i = 0; i < map.size(); ++i)
+            if (!map.passable[i]) obstacles.insert(map.cell(i));
+        bench.run("neighbors/legacy hash set + vector", cells.size(), [&]() {
+            uint64_t sum = 0;
+            for (int i : cells)
+                for (const pii& nb : legacy_neighbors_8(map.cell(i), {map.rows, map.cols}, obstacles))
+                    sum += nb.first + nb.second;
+            return sum;
+        });
+    }
+    bench.run("neighbors/GridMap::can_move", cells.size(), [&]() {
+        uint64_t sum = 0;
+        for (int i : cells) {
+            int r = i / map.cols, c = i % map.cols;
+            for (int dir = 0; dir < 8; ++dir)
+                if (map.can_move(r, c, dir)) sum += i + map.dir_offset(dir);
+        }
+        return sum;
+    });
+    if (bench.selected("neighbors/move mask")) {
+        // Candidate replacement: the 8 can_move bits precomputed per cell
+        vector<uint8_t> masks(map.size(), 0);
+        for (size_t i = 0; i < map.size(); ++i) {
+            pii p = map.cell(i);
+            for (int dir = 0; dir < 8; ++dir)
+                if (map.passable[i] && map.can_move(p.first, p.second, dir)) masks[i] |= 1 << dir;
+        }
+        int offsets[8];
+        for (int dir = 0; dir < 8; ++dir) offsets[dir] = map.dir_offset(dir);
+        bench.run("neighbors/move mask", cells.size(), [&]() {
+            uint64_t sum = 0;
+            for (int i : cells)
+                for (unsigned m = masks[i]; m; m &= m - 1) sum += i + offsets[__builtin_ctz(m)];
+            return sum;
+        });
+    }
+
+    bench.section("open list (per push or pop)");
+    for (auto distribution : {KeyDistribution::Astar, KeyDistribution::Uniform}) {
+        string keys = distribution == KeyDistribution::Astar ? "A* keys" : "uniform keys";
+        vector<pair<float, int>> trace = open_list_trace(distribution, 1 << 16, 7);
+        using Element = pair<float, int>;
+        bench.run("open/pair<float,int> heap, " + keys, trace.size(), [&]() {
+            return replay<priority_queue<Element, vector<Element>, greater<>>>(
+                trace, [](float key, int cell) { return Element(key, cell); },
+                [](const Element& e) { return (uint64_t)e.second; });
+        });
+        // Non-negative floats order like their bit patterns, so key and cell
+        // pack into one integer compare
+        bench.run("open/packed uint64 heap, " + keys, trace.size(), [&]() {
+            return replay<priority_queue<uint64_t, vector<uint64_t>, greater<>>>(
+                trace,
+                [](float key, int cell) {
+                    uint32_t bits;
+                    memcpy(&bits, &key, sizeof bits);
+                    return (uint64_t)bits << 32 | (uint32_t)cell;
+                },
+                [](uint64_t e) { return e & 0xffffffffu; });
+        });
+    }
+
+    bench.section("heuristics (per call)");
+    vector<pii> goals;
+    for (int k = 0; k < 16; ++k) goals.push_back(map.cell(cells[rng() % cells.size()]));
+    auto over_goals = [&](auto h_for_goal) {
+        double sum = 0;
+        for (size_t k = 0; k < goals.size(); ++k) {
+            auto h = h_for_goal(goals[k]);
+            for (size_t j = k; j < cells.size(); j += goals.size()) sum += h(map.cell(cells[j]), goals[k]);
+        }
+        return (uint64_t)sum;
+    };
+    bench.run("heuristic/octile float", cells.size(), [&]() {
+        return over_goals([](const pii&) { return [](const pii& a, const pii& b) { return octile(a, b); }; });
+    });
+    bench.run("heuristic/octile fixed point", cells.size(), [&]() {
+        return over_goals([](const pii&) { return PackedNodeStore::heuristic; });
+    });
+    for (int dims : {4, 8}) {
+        string name = "heuristic/max(octile, FastMap L1) K=" + to_string(dims);
+        if (!bench.selected(name)) continue;
+        FastMapEmbedding embedding = build_fastmap(map, dims, 1);
+        bench.run(name, cells.size(), [&]() {
+            double sum = 0;
+            for (size_t k = 0; k < goals.size(); ++k) {
+                sum += with_fastmap_heuristic(map, embedding, goals[k], [&](const auto& h) {
+                    double s = 0;
+                    for (size_t j = k; j < cells.size(); j += goals.size()) s += h(map.cell(cells[j]), goals[k]);
+                    return s;
+                });
+            }
+            return (uint64_t)sum;
+        });
+    }
+    if (bench.selected("heuristic/landmark")) {
+        // Differential heuristic: exact distances from L landmarks, placed by
+        // farthest-point selection, h = max_l |d(l, a) - d(l, goal)|
+        constexpr int L = 4;
+        vector<float> dist(map.size() * L), from(map.size());
+        auto unit = [](int, int dir) { return dir_cost(dir); };
+        int landmark = cells[0];
+        vector<float> nearest(map.size(), INFINITY);
+        for (int l = 0; l < L; ++l) {
+            grid_dijkstra(map, landmark, unit, from.data());
+            for (size_t i = 0; i < map.size(); ++i) {
+                dist[i * L + l] = from[i] < INFINITY ? from[i] : 0.0f;
+                if (from[i] < nearest[i]) nearest[i] = from[i];
+            }
+            for (int i : cells)
+                if (nearest[i] < INFINITY && nearest[i] > nearest[landmark]) landmark = i;
+        }
+        bench.run("heuristic/max(octile, landmark) L=4", cells.size(), [&]() {
+            return over_goals([&](const pii& goal) {
+                const float* g = &dist[(size_t)map.index(goal) * L];
+                return [&, g](const pii& a, const pii& b) {
+                    const float* d = &dist[(size_t)map.index(a) * L];
+                    float h = octile(a, b);
+                    for (int l = 0; l < L; ++l) h = max(h, fabs(d[l] - g[l]));
+                    return h;
+                };
+            });
+        });
+    }
+
+    bench.section("reconstruct_path / encode_path (per path cell)");
+    const Scenario& longest = *max_element(scenarios.begin(), scenarios.end(),
+                                           [](const Scenario& a, const Scenario& b) { return a.cost < b.cost; });
+    int s = map.index(longest.start), t = map.index(longest.goal);
+    FlatNodeStore flat;
+    PackedNodeStore packed;
+    vector<pii> path = grid_a_star(map, longest.start, longest.goal, flat);
+    grid_a_star(map, longest.start, longest.goal, packed);
+    cout << "(path of " << path.size() << " cells, cost " << longest.cost << ")\n";
+    if (bench.selected("reconstruct/legacy")) {
+        unordered_map<pii, pii, pair_hash> came_from;
+        for (size_t i = 1; i < path.size(); ++i) came_from[path[i]] = path[i - 1];
+        bench.run("reconstruct/legacy unordered_map", path.size(),
+                  [&]() { return (uint64_t)legacy_reconstruct_path(came_from, longest.goal).size(); });
+    }
+    bench.run("reconstruct/FlatNodeStore", path.size(),
+              [&]() { return (uint64_t)reconstruct_path(map, flat, s, t).size(); });
+    bench.run("reconstruct/PackedNodeStore", path.size(),
+              [&]() { return (uint64_t)reconstruct_path(map, packed, s, t).size(); });
+    EncodedPath encoded;
+    bench.run("encode_path/FlatNodeStore", path.size(), [&]() {
+        encode_path(map, flat, s, t, encoded);
+        return (uint64_t)encoded.runs.size();
+    });
+    bench.run("encode_path/PackedNodeStore", path.size(), [&]() {
+        encode_path(map, packed, s, t, encoded);
+        return (uint64_t)encoded.runs.size();
+    });
+
+    bench.section("parsing (per map cell / scenario line)");
+    bench.run("parse/read_grid_map", map.size(), [&]() { return (uint64_t)read_grid_map(map_file).rows; });
+    bench.run("parse/read_scenarios", scenarios.size(),
+              [&]() { return (uint64_t)read_scenarios(scen_file).size(); });
+
+    bench.section("pattern keys, 15-puzzle (per board)");
+    TilePuzzle puzzle(4, 4);
+    vector<TileBoard> boards;
+    mt19937_64 board_rng(3);
+    for (int i = 0; i < SAMPLE; ++i) boards.push_back(puzzle.random_board(board_rng));
+    const int pattern[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    for (int k : {7, 8}) {
+        string suffix = " k=" + to_string(k);
+        bench.run("pattern_key/computePatternKeyInternal" + suffix, boards.size(), [&]() {
+            uint64_t sum = 0;
+            for (const TileBoard& b : boards) sum += pattern_key_per_call(b, puzzle.size, pattern, k);
+            return sum;
+        });
+        PermutationIndexer indexer(puzzle.size, k);
+        bench.run("pattern_key/pos[] + shared indexer" + suffix, boards.size(), [&]() {
+            uint64_t sum = 0;
+            uint8_t positions[MAX_TILES];
+            for (const TileBoard& b : boards) {
+                for (int i = 0; i < k; ++i) positions[i] = b.pos[pattern[i]];
+                sum += indexer.rank(positions);
+            }
+            return sum;
+        });
+    }
+
+    cout << "\n" << bench.results.size() << " cases (checksum " << bench.sink() << ")\n";
+    return 0;
+}
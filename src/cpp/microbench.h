@@ -0,0 +1,100 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include "bench_util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Minimal microbenchmark harness for the search kernels.
+//
+// A case is a callable doing `ops` operations per call and returning a
+// checksum; checksums are summed into a sink that is printed at the end,
+// so the optimizer cannot drop the work. Each case is warmed up for
+// warmup_seconds, which also calibrates how many calls one repetition
+// makes (at least min_rep_seconds of work), then timed `repetitions`
+// times. The median ns/op is reported with the fastest repetition and the
+// spread (median absolute deviation over the median): a spread of more
+// than a few percent means the machine was busy and the row is noisy.
+struct MicroBenchOptions {
+    double warmup_seconds = 0.05;
+    double min_rep_seconds = 0.01;
+    int repetitions = 15;
+    string filter; // only cases whose name contains this
+};
+
+struct MicroBenchResult {
+    string name;
+    double ns_per_op = 0; // median over repetitions
+    double min_ns_per_op = 0;
+    double spread = 0;
+};
+
+class MicroBench {
+public:
+    explicit MicroBench(const MicroBenchOptions& options) : options(options) {}
+
+    bool selected(const string& name) const {
+        return options.filter.empty() || name.find(options.filter) != string::npos;
+    }
+
+    template <class F>
+    void run(const string& name, uint64_t ops, F&& f) {
+        if (!selected(name) || ops == 0) return;
+        Timer timer;
+        uint64_t calls = 0;
+        do {
+            checksum += f();
+            ++calls;
+        } while (timer.seconds() < options.warmup_seconds);
+        double per_call = timer.seconds() / calls;
+        uint64_t batch = max<uint64_t>(1, (uint64_t)ceil(options.min_rep_seconds / max(per_call, 1e-9)));
+
+        vector<double> ns(max(1, options.repetitions));
+        for (double& t : ns) {
+            timer.reset();
+            for (uint64_t i = 0; i < batch; ++i) checksum += f();
+            t = timer.seconds() * 1e9 / (batch * ops);
+        }
+        sort(ns.begin(), ns.end());
+        MicroBenchResult result;
+        result.name = name;
+        result.ns_per_op = ns[ns.size() / 2];
+        result.min_ns_per_op = ns[0];
+        vector<double> deviation;
+        for (double t : ns) deviation.push_back(fabs(t - result.ns_per_op));
+        sort(deviation.begin(), deviation.end());
+        result.spread = deviation[deviation.size() / 2] / result.ns_per_op;
+        print(result);
+        results.push_back(result);
+    }
+
+    void section(const string& title) const { cout << "\n--- " << title << " ---\n"; }
+
+    static void print_header() {
+        cout << left << setw(40) << "case" << right << setw(12) << "ns/op" << setw(12) << "min" << setw(9)
+             << "spread" << setw(14) << "Mop/s" << "\n";
+    }
+
+    static void print(const MicroBenchResult& r) {
+        cout << left << setw(40) << r.name << right << fixed << setprecision(2) << setw(12) << r.ns_per_op
+             << setw(12) << r.min_ns_per_op << setw(8) << setprecision(1) << 100 * r.spread << "%" << setw(14)
+             << setprecision(2) << 1e3 / r.ns_per_op << "\n";
+    }
+
+    uint64_t sink() const { return checksum; }
+
+    vector<MicroBenchResult> results;
+
+private:
+    MicroBenchOptions options;
+    uint64_t checksum = 0;
+};
+
+#endif // MICROBENCH_H
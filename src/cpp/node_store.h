@@ -0,0 +1,132 @@
+#ifndef NODE_STORE_H
+#define NODE_STORE_H
+
+#include "grid_map.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// Per-cell search state for grid A*, indexed by flat cell index.
+// Both stores are reused across queries: a generation counter marks which
+// cells belong to the current query so nothing is cleared between runs.
+//
+// The start cell is stored as its own parent; path reconstruction stops there.
+
+// Straightforward layout: float g, parent coordinates, closed flag + generation.
+// 16 bytes per cell.
+struct FlatNodeStore {
+    using cost_t = float;
+
+    struct Node {
+        float g;
+        pii parent;
+        uint32_t flags; // generation << 1 | closed
+    };
+
+    vector<Node> nodes;
+    uint32_t generation = 0;
+    int cols = 0;
+
+    template <class Map>
+    void reset(const Map& map) {
+        cols = map.cols;
+        if (nodes.size() != map.size()) {
+            nodes.assign(map.size(), Node{0.0f, {0, 0}, 0});
+            generation = 0;
+        }
+        if (++generation >= (1u << 31)) {
+            for (Node& n : nodes) n.flags = 0;
+            generation = 1;
+        }
+    }
+
+    bool generated(int i) const { return (nodes[i].flags >> 1) == generation; }
+    bool closed(int i) const { return nodes[i].flags == (generation << 1 | 1u); }
+    cost_t g(int i) const { return nodes[i].g; }
+    int parent(int i) const { return nodes[i].parent.first * cols + nodes[i].parent.second; }
+
+    void set(int i, cost_t g, int from, int /*dir*/) {
+        nodes[i] = Node{g, {from / cols, from % cols}, generation << 1};
+    }
+    void close(int i) { nodes[i].flags |= 1u; }
+
+    static constexpr cost_t MAX_G = numeric_limits<float>::max(); // no limit
+    static cost_t step_cost(int dir) { return dir_cost(dir); }
+    static cost_t heuristic(const pii& a, const pii& b) { return octile(a, b); }
+    static float to_float(cost_t g) { return g; }
+
+    size_t bytes() const { return nodes.capacity() * sizeof(Node); }
+};
+
+// Memory-lean layout, 8 bytes per cell:
+//   g_fixed: g in fixed point (G_SCALE units per unit step)
+//   meta:    [31..5] generation | [4] closed | [3] open | [2..0] parent direction
+// The parent is recovered by stepping back along the stored direction.
+// g is capped at MAX_G (about 2.1M unit steps) so that g + h stays inside
+// 32 bits: h is at most DIAG_COST per cell of the longer side, which keeps
+// it under 2^31 for maps up to 1.48M cells on a side. grid_a_star_search
+// never generates a node above the cap, and reports a goal past it as
+// unreachable with SearchStats::cost_overflow set. Use FlatNodeStore for
+// longer paths or longer maps.
+struct PackedNodeStore {
+    using cost_t = uint32_t;
+
+    static const uint32_t G_SCALE = 1024;
+    static const uint32_t DIAG_COST = 1448; // round(sqrt(2) * G_SCALE)
+    static const uint32_t DIR_MASK = 0x7;
+    static const uint32_t OPEN_BIT = 1u << 3;
+    static const uint32_t CLOSED_BIT = 1u << 4;
+    static const int GEN_SHIFT = 5;
+    static const uint32_t MAX_GENERATION = (1u << (32 - GEN_SHIFT)) - 1;
+    static const cost_t MAX_G = UINT32_MAX / 2;
+
+    vector<uint32_t> g_fixed;
+    vector<uint32_t> meta;
+    uint32_t generation = 0;
+    int offsets[8] = {};
+
+    template <class Map>
+    void reset(const Map& map) {
+        for (int d = 0; d < 8; ++d) offsets[d] = map.dir_offset(d);
+        if (meta.size() != map.size()) {
+            g_fixed.assign(map.size(), 0);
+            meta.assign(map.size(), 0);
+            generation = 0;
+        }
+        if (++generation > MAX_GENERATION) {
+            fill(meta.begin(), meta.end(), 0);
+            generation = 1;
+        }
+    }
+
+    bool generated(int i) const { return (meta[i] >> GEN_SHIFT) == generation; }
+    bool closed(int i) const { return (meta[i] & ~(DIR_MASK | OPEN_BIT)) == (generation << GEN_SHIFT | CLOSED_BIT); }
+    cost_t g(int i) const { return g_fixed[i]; }
+    int direction(int i) const { return meta[i] & DIR_MASK; }
+    int parent(int i) const { return i - offsets[meta[i] & DIR_MASK]; }
+
+    void set(int i, cost_t g, int /*from*/, int dir) {
+        g_fixed[i] = g;
+        meta[i] = generation << GEN_SHIFT | OPEN_BIT | (uint32_t)dir;
+    }
+    void close(int i) { meta[i] = (meta[i] & ~OPEN_BIT) | CLOSED_BIT; }
+
+    static cost_t step_cost(int dir) { return is_diagonal(dir) ? DIAG_COST : G_SCALE; }
+    static cost_t heuristic(const pii& a, const pii& b) {
+        uint32_t dr = abs(a.first - b.first);
+        uint32_t dc = abs(a.second - b.second);
+        uint32_t lo = dr < dc ? dr : dc;
+        uint32_t hi = dr < dc ? dc : dr;
+        return hi * G_SCALE + lo * (DIAG_COST - G_SCALE);
+    }
+    static float to_float(cost_t g) { return (float)g / G_SCALE; }
+
+    size_t bytes() const {
+        return g_fixed.capacity() * sizeof(uint32_t) + meta.capacity() * sizeof(uint32_t);
+    }
+};
+
+#endif // NODE_STORE_H
@@ -0,0 +1,140 @@
+#include "path_codec.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+const char PATH_STREAM_MAGIC[8] = {'S', 'A', 'P', 'A', 'T', 'H', '1', '\n'};
+
+bool encode_path(const vector<pii>& path, EncodedPath& out) {
+    out.clear();
+    if (path.empty()) return true;
+    out.start = path[0];
+    out.cells = (uint32_t)path.size();
+    int dir = -1, length = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        int d = move_direction(path[i - 1], path[i]);
+        if (d < 0) {
+            out.clear();
+            return false;
+        }
+        if (d != dir || length == EncodedPath::MAX_RUN) {
+            if (length > 0) out.runs.push_back((uint8_t)((length - 1) << 3 | dir));
+            dir = d;
+            length = 0;
+        }
+        ++length;
+    }
+    if (length > 0) out.runs.push_back((uint8_t)((length - 1) << 3 | dir));
+    return true;
+}
+
+vector<pii> decode_path(const EncodedPath& path) {
+    vector<pii> cells;
+    cells.reserve(path.cells);
+    for_each_path_cell(path, [&](const pii& cell) { cells.push_back(cell); });
+    return cells;
+}
+
+double path_cost(const EncodedPath& path) {
+    double cost = 0;
+    for (uint8_t run : path.runs) cost += run_length(run) * (double)dir_cost(run_direction(run));
+    return cost;
+}
+
+static void put_u32(vector<uint8_t>& out, uint32_t v) {
+    for (int k = 0; k < 4; ++k) out.push_back((uint8_t)(v >> (8 * k)));
+}
+
+static void put_u64(vector<uint8_t>& out, uint64_t v) {
+    for (int k = 0; k < 8; ++k) out.push_back((uint8_t)(v >> (8 * k)));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_u64(const uint8_t* p) { return (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32; }
+
+PathWriter::PathWriter(int fd, size_t buffer_size) : fd(fd), buffer_size(max<size_t>(buffer_size, 64)) {
+    buffer.reserve(this->buffer_size);
+    buffer.insert(buffer.end(), PATH_STREAM_MAGIC, PATH_STREAM_MAGIC + 8);
+}
+
+PathWriter::~PathWriter() { flush(); }
+
+bool PathWriter::write(uint64_t id, float cost, const EncodedPath& path) {
+    if (failed) return false;
+    uint32_t cost_bits;
+    memcpy(&cost_bits, &cost, sizeof(cost_bits));
+    put_u64(buffer, id);
+    put_u32(buffer, cost_bits);
+    put_u32(buffer, (uint32_t)path.start.first);
+    put_u32(buffer, (uint32_t)path.start.second);
+    put_u32(buffer, path.cells);
+    put_u32(buffer, (uint32_t)path.runs.size());
+    buffer.insert(buffer.end(), path.runs.begin(), path.runs.end());
+    ++records;
+    return buffer.size() < buffer_size || flush();
+}
+
+bool PathWriter::flush() {
+    if (failed) return false;
+    for (size_t done = 0; done < buffer.size();) {
+        ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            failed = true;
+            error = n < 0 ? strerror(errno) : "short write";
+            return false;
+        }
+        done += n;
+        bytes_written += n;
+    }
+    buffer.clear();
+    return true;
+}
+
+bool PathReader::read_exact(void* data, size_t size, bool eof_ok) {
+    uint8_t* p = (uint8_t*)data;
+    for (size_t done = 0; done < size;) {
+        ssize_t n = ::read(fd, p + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            error = strerror(errno);
+            return false;
+        }
+        if (n == 0) {
+            if (!(eof_ok && done == 0)) error = "truncated path stream";
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+bool PathReader::next(PathRecord& record) {
+    if (!started) {
+        char magic[8];
+        if (!read_exact(magic, sizeof(magic), false)) return false;
+        if (memcmp(magic, PATH_STREAM_MAGIC, sizeof(magic)) != 0) {
+            error = "not a path stream";
+            return false;
+        }
+        started = true;
+    }
+    uint8_t header[28];
+    if (!read_exact(header, sizeof(header), true)) return false;
+    record.id = get_u64(header);
+    uint32_t cost_bits = get_u32(header + 8);
+    memcpy(&record.cost, &cost_bits, sizeof(cost_bits));
+    record.path.start = {(int)get_u32(header + 12), (int)get_u32(header + 16)};
+    record.path.cells = get_u32(header + 20);
+    uint32_t run_bytes = get_u32(header + 24);
+    // Every run byte is at least one move
+    if (run_bytes > record.path.cells) {
+        error = "malformed path record";
+        return false;
+    }
+    record.path.runs.resize(run_bytes);
+    return read_exact(record.path.runs.data(), run_bytes, false);
+}
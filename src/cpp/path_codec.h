@@ -0,0 +1,154 @@
+#ifndef PATH_CODEC_H
+#define PATH_CODEC_H
+
+#include "grid_map.h"
+#include "node_store.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Compact grid paths: the start cell plus the moves, run-length encoded.
+// Every byte is one run of up to MAX_RUN moves in the same direction:
+//   [7..3] run length - 1   [2..0] direction (DIR_DR / DIR_DC order)
+// A straight corridor of 32 cells is one byte where vector<pii> spends 256.
+// Runs longer than MAX_RUN take several bytes.
+struct EncodedPath {
+    static const int MAX_RUN = 32;
+
+    pii start = {-1, -1};
+    uint32_t cells = 0; // start included; 0 for "no path"
+    vector<uint8_t> runs;
+
+    void clear() {
+        start = {-1, -1};
+        cells = 0;
+        runs.clear();
+    }
+    size_t bytes() const { return sizeof(start) + sizeof(cells) + runs.size(); }
+};
+
+inline int run_direction(uint8_t run) { return run & 0x7; }
+inline int run_length(uint8_t run) { return (run >> 3) + 1; }
+
+// Direction of the single move from -> to, -1 if the cells are not adjacent
+inline int move_direction(const pii& from, const pii& to) {
+    // (dr + 1) * 3 + (dc + 1) -> direction; the centre is not a move
+    static const int FROM_DELTA[9] = {0, 1, 2, 3, -1, 4, 5, 6, 7};
+    int dr = to.first - from.first, dc = to.second - from.second;
+    if (dr < -1 || dr > 1 || dc < -1 || dc > 1) return -1;
+    return FROM_DELTA[(dr + 1) * 3 + (dc + 1)];
+}
+
+// Direction of the move into cell i from its parent. PackedNodeStore keeps
+// it in the cell's metadata; other stores recover it from the coordinates.
+template <class Store>
+int parent_direction(const GridMap& map, const Store& store, int i) {
+    return move_direction(map.cell(store.parent(i)), map.cell(i));
+}
+inline int parent_direction(const GridMap&, const PackedNodeStore& store, int i) { return store.direction(i); }
+
+// Encodes the path start -> goal straight from the store's parent links
+// (after grid_a_star_search), without building the cell list. Reuses out's
+// buffer, so encoding a batch into one EncodedPath does not allocate.
+template <class Store>
+void encode_path(const GridMap& map, const Store& store, int start, int goal, EncodedPath& out) {
+    out.clear();
+    out.start = map.cell(start);
+    out.cells = 1;
+    // Parent links run goal -> start: runs come out last-first, and the
+    // (much shorter) run list is reversed at the end
+    int dir = -1, length = 0;
+    for (int i = goal; i != start; i = store.parent(i)) {
+        int d = parent_direction(map, store, i);
+        if (d != dir || length == EncodedPath::MAX_RUN) {
+            if (length > 0) out.runs.push_back((uint8_t)((length - 1) << 3 | dir));
+            dir = d;
+            length = 0;
+        }
+        ++length;
+        ++out.cells;
+    }
+    if (length > 0) out.runs.push_back((uint8_t)((length - 1) << 3 | dir));
+    reverse(out.runs.begin(), out.runs.end());
+}
+
+// Same encoding from a list of cells; false if two consecutive cells are
+// not adjacent
+bool encode_path(const vector<pii>& path, EncodedPath& out);
+
+// Calls f(cell) for every cell of the path, start first
+template <class F>
+void for_each_path_cell(const EncodedPath& path, F f) {
+    if (path.cells == 0) return;
+    pii at = path.start;
+    f(at);
+    for (uint8_t run : path.runs) {
+        int dir = run_direction(run);
+        for (int k = run_length(run); k > 0; --k) {
+            at.first += DIR_DR[dir];
+            at.second += DIR_DC[dir];
+            f(at);
+        }
+    }
+}
+
+vector<pii> decode_path(const EncodedPath& path);
+// Path cost (unit / sqrt(2) moves) without decoding the cells
+double path_cost(const EncodedPath& path);
+
+// Binary path stream for batches, written to any file descriptor (file,
+// pipe or socket). The stream starts with the 8-byte magic PATH_STREAM_MAGIC,
+// then one record per path, little-endian:
+//   u64 id | f32 cost | i32 start_row | i32 start_col | u32 cells | u32 run_bytes | runs
+// A query without a path is a record with cells = 0 and no runs. Records
+// are buffered and go out in large writes.
+extern const char PATH_STREAM_MAGIC[8];
+
+class PathWriter {
+public:
+    // Does not take ownership of fd
+    explicit PathWriter(int fd, size_t buffer_size = 1 << 16);
+    ~PathWriter(); // flushes
+
+    // false once a write to fd has failed (error says why); later records
+    // are dropped
+    bool write(uint64_t id, float cost, const EncodedPath& path);
+    bool flush();
+
+    uint64_t records = 0;
+    uint64_t bytes_written = 0; // handed to fd, magic included
+    string error;
+
+private:
+    int fd;
+    size_t buffer_size;
+    vector<uint8_t> buffer;
+    bool failed = false;
+};
+
+struct PathRecord {
+    uint64_t id = 0;
+    float cost = 0;
+    EncodedPath path;
+};
+
+// Reads a stream written by PathWriter
+class PathReader {
+public:
+    explicit PathReader(int fd) : fd(fd) {}
+
+    // false at the end of the stream or on a malformed one (error set)
+    bool next(PathRecord& record);
+
+    string error;
+
+private:
+    int fd;
+    bool started = false;
+    bool read_exact(void* data, size_t size, bool eof_ok);
+};
+
+#endif // PATH_CODEC_H
@@ -0,0 +1,129 @@
+// Path output cost: solves a scenario file and writes every path twice, as
+// text coordinates (one "row col" line per cell, as a_star_grid_8_con.cpp
+// does) and as the run-length binary stream of path_codec.h, timing the
+// search and each serialization separately. The binary file is read back
+// and checked cell by cell against the searched paths.
+// Usage: path_output [map_file] [scen_file] [out_prefix] [flat|packed] [repeat]
+// Writes <out_prefix>.txt and <out_prefix>.bin; repeat runs the scenario
+// list that many times to make a larger batch.
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "path_codec.h"
+#include "bench_util.h"
+#include <cmath>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace std;
+
+template <class Store>
+int run(const GridMap& map, const vector<Scenario>& scenarios, const string& prefix, int repeat) {
+    ComponentIndex components(map);
+    Store store;
+    double search_s = 0, text_s = 0, binary_s = 0;
+    uint64_t cells = 0, queries = 0;
+
+    ofstream text(prefix + ".txt");
+    int fd = open((prefix + ".bin").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (!text.is_open() || fd < 0) {
+        cerr << "Cannot write " << prefix << ".txt / .bin" << endl;
+        return 1;
+    }
+    PathWriter writer(fd);
+    vector<vector<pii>> expected;
+    EncodedPath encoded;
+    for (int r = 0; r < repeat; ++r) {
+        for (const Scenario& s : scenarios) {
+            uint64_t id = queries++;
+            SearchStats stats;
+            Timer timer;
+            bool found = components.connected(s.start, s.goal) &&
+                         grid_a_star_search(map, s.start, s.goal, store, Store::heuristic, &stats);
+            search_s += timer.seconds();
+
+            // Text: cell list from the parent links, then one line per cell
+            timer.reset();
+            vector<pii> path;
+            if (found) path = reconstruct_path(map, store, map.index(s.start), map.index(s.goal));
+            text << id << " " << path.size() << "\n";
+            for (const pii& p : path) text << p.first << " " << p.second << "\n";
+            text_s += timer.seconds();
+
+            // Binary: runs straight from the parent links into the stream
+            timer.reset();
+            if (found) encode_path(map, store, map.index(s.start), map.index(s.goal), encoded);
+            else encoded.clear();
+            writer.write(id, found ? stats.cost : 0.0f, encoded);
+            binary_s += timer.seconds();
+
+            cells += path.size();
+            if (r == 0) expected.push_back(move(path));
+        }
+    }
+    {
+        Timer timer;
+        text.flush();
+        writer.flush();
+        binary_s += timer.seconds();
+    }
+    text.close();
+    close(fd);
+    if (!writer.error.empty()) {
+        cerr << "Binary write failed: " << writer.error << endl;
+        return 1;
+    }
+    size_t text_bytes = ifstream(prefix + ".txt", ios::binary | ios::ate).tellg();
+
+    // Read the stream back and compare
+    int in = open((prefix + ".bin").c_str(), O_RDONLY);
+    PathReader reader(in);
+    PathRecord record;
+    uint64_t read = 0, mismatches = 0;
+    while (reader.next(record)) {
+        const vector<pii>& want = expected[record.id % scenarios.size()];
+        if (decode_path(record.path) != want ||
+            (!want.empty() && fabs(path_cost(record.path) - record.cost) > 1e-3 * (1 + record.cost)))
+            ++mismatches;
+        ++read;
+    }
+    close(in);
+    if (!reader.error.empty()) cerr << "Read back failed: " << reader.error << endl;
+
+    cout << queries << " paths, " << cells << " cells, search " << fixed << setprecision(3) << search_s << " s\n";
+    cout << setw(8) << "format" << setw(12) << "bytes" << setw(12) << "bytes/cell" << setw(12) << "serial_s"
+         << setw(14) << "us/path" << setw(14) << "vs search" << "\n";
+    auto row = [&](const string& name, size_t bytes, double seconds) {
+        cout << setw(8) << name << setw(12) << bytes << setw(12) << setprecision(3)
+             << (double)bytes / max<uint64_t>(cells, 1) << setw(12) << seconds << setw(14) << setprecision(2)
+             << seconds * 1e6 / max<uint64_t>(queries, 1)
+             << setw(14) << setprecision(3) << seconds / max(search_s, 1e-9) << "\n";
+    };
+    row("text", text_bytes, text_s);
+    row("binary", writer.bytes_written, binary_s);
+    cout << "Read back " << read << " records, " << mismatches << " mismatches\n";
+    return read == queries && mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    string scen_file = argc > 2 ? argv[2] : "AcrosstheCape.map.scen";
+    string prefix = argc > 3 ? argv[3] : "paths";
+    string mode = argc > 4 ? argv[4] : "packed";
+    int repeat = argc > 5 ? max(1, stoi(argv[5])) : 1;
+
+    GridMap map = read_grid_map(map_file);
+    vector<Scenario> scenarios = read_scenarios(scen_file);
+    if (scenarios.empty()) {
+        cerr << "No scenarios in " << scen_file << endl;
+        return 1;
+    }
+    cout << "Map " << map.rows << "x" << map.cols << ", " << mode << " store\n";
+    if (mode == "flat") return run<FlatNodeStore>(map, scenarios, prefix, repeat);
+    return run<PackedNodeStore>(map, scenarios, prefix, repeat);
+}
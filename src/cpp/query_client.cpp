@@ -0,0 +1,206 @@
+// Client and load generator for serve_queries.
+// Usage: query_client [socket_path] [map_file] [queries] [connections] [pipeline] [map_index] [shutdown]
+//
+// Sends `queries` random start/goal pairs (free cells of map_file, which
+// must be map `map_index` on the server; a negative map_index names the
+// file by its path instead, which must be relative to the server's map root) over `connections` sockets, each
+// keeping up to `pipeline` requests in flight, and reports throughput and
+// client- and server-side latency percentiles. With queries = 0 it is a
+// plain line client: stdin goes to the server, replies to stdout.
+// shutdown = 1 stops the server afterwards.
+#include "grid_map.h"
+#include "query_server.h"
+#include "bench_util.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+int connect_to(const string& path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    path.copy(addr.sun_path, min(path.size(), sizeof(addr.sun_path) - 1));
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        cerr << "Failed to connect to " << path << ": " << strerror(errno) << endl;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool send_all(int fd, const string& data) {
+    for (size_t done = 0; done < data.size();) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += n;
+    }
+    return true;
+}
+
+// Reads one reply line into line; false at EOF
+bool read_line(int fd, string& buffer, string& line) {
+    char chunk[1 << 16];
+    for (;;) {
+        size_t end = buffer.find('\n');
+        if (end != string::npos) {
+            line = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            return true;
+        }
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer.append(chunk, n);
+    }
+}
+
+struct ClientResult {
+    uint64_t ok = 0, nopath = 0, errors = 0;
+    vector<double> round_trip_us;
+    vector<double> server_us;
+};
+
+// One connection's share of the load: keeps up to `pipeline` requests out
+void run_connection(const string& socket_path, const vector<QueryRequest>& requests, int pipeline,
+                    ClientResult& result) {
+    int fd = connect_to(socket_path);
+    if (fd < 0) {
+        result.errors += requests.size();
+        return;
+    }
+    // Request ids are positions in `requests`
+    vector<chrono::steady_clock::time_point> sent_at(requests.size());
+    size_t next = 0, done = 0;
+    string buffer, line;
+    while (done < requests.size()) {
+        string out;
+        auto now = chrono::steady_clock::now();
+        for (; next < requests.size() && (int)(next - done) < pipeline; ++next) {
+            out += format_request(requests[next]);
+            sent_at[next] = now;
+        }
+        if (!out.empty() && !send_all(fd, out)) break;
+        if (!read_line(fd, buffer, line)) break;
+        auto received = chrono::steady_clock::now();
+        ++done;
+
+        istringstream in(line);
+        uint64_t id;
+        string status;
+        in >> id >> status;
+        if (status == "error" || id >= requests.size()) {
+            ++result.errors;
+            continue;
+        }
+        // ok: cost cells expansions latency; nopath: expansions latency
+        string field, last;
+        while (in >> field) last = field;
+        (status == "ok" ? result.ok : result.nopath)++;
+        result.round_trip_us.push_back(chrono::duration<double, micro>(received - sent_at[id]).count());
+        result.server_us.push_back(stod(last));
+    }
+    result.errors += requests.size() - done;
+    close(fd);
+}
+
+// Forwards stdin to the server and replies to stdout
+int interactive(const string& socket_path) {
+    int fd = connect_to(socket_path);
+    if (fd < 0) return 1;
+    thread printer([fd]() {
+        string buffer, line;
+        while (read_line(fd, buffer, line)) cout << line << endl;
+    });
+    for (string line; getline(cin, line);) {
+        if (!send_all(fd, line + "\n")) break;
+    }
+    shutdown(fd, SHUT_WR);
+    printer.join();
+    close(fd);
+    return 0;
+}
+
+void print_latency(const string& name, const vector<double>& samples) {
+    LatencySummary s = summarize(samples);
+    cout << name << " latency (us): mean " << s.mean << "  p50 " << s.p50 << "  p90 " << s.p90 << "  p99 " << s.p99
+         << "  max " << s.max << "\n";
+}
+
+int main(int argc, char** argv) {
+    string socket_path = argc > 1 ? argv[1] : "/tmp/search.sock";
+    string map_file = argc > 2 ? argv[2] : "AcrosstheCape.map";
+    int queries = argc > 3 ? stoi(argv[3]) : 10000;
+    int connections = argc > 4 ? stoi(argv[4]) : 8;
+    int pipeline = argc > 5 ? stoi(argv[5]) : 4;
+    int map_index = argc > 6 ? stoi(argv[6]) : 0;
+    bool stop_server = argc > 7 && stoi(argv[7]) != 0;
+
+    if (queries == 0) return interactive(socket_path);
+
+    GridMap map = read_grid_map(map_file);
+    vector<int> free_cells;
+    for (size_t i = 0; i < map.size(); ++i)
+        if (map.passable[i]) free_cells.push_back(i);
+    if (free_cells.empty()) {
+        cerr << "No free cells in " << map_file << endl;
+        return 1;
+    }
+
+    string map_path = map_index < 0 ? map_file : "";
+
+    connections = max(1, min(connections, queries));
+    mt19937 rng(1);
+    vector<vector<QueryRequest>> shares(connections);
+    for (int i = 0; i < queries; ++i) {
+        vector<QueryRequest>& share = shares[i % connections];
+        QueryRequest request;
+        request.id = share.size();
+        request.map = map_index;
+        request.map_path = map_path;
+        request.start = map.cell(free_cells[rng() % free_cells.size()]);
+        request.goal = map.cell(free_cells[rng() % free_cells.size()]);
+        share.push_back(request);
+    }
+
+    vector<ClientResult> results(connections);
+    Timer timer;
+    vector<thread> pool;
+    for (int c = 0; c < connections; ++c)
+        pool.emplace_back(run_connection, socket_path, cref(shares[c]), pipeline, ref(results[c]));
+    for (thread& t : pool) t.join();
+    double seconds = timer.seconds();
+
+    ClientResult total;
+    for (const ClientResult& r : results) {
+        total.ok += r.ok;
+        total.nopath += r.nopath;
+        total.errors += r.errors;
+        total.round_trip_us.insert(total.round_trip_us.end(), r.round_trip_us.begin(), r.round_trip_us.end());
+        total.server_us.insert(total.server_us.end(), r.server_us.begin(), r.server_us.end());
+    }
+    cout << queries << " queries over " << connections << " connections, pipeline " << pipeline << "\n";
+    cout << "Found: " << total.ok << "  No path: " << total.nopath << "  Errors: " << total.errors << "\n";
+    cout << "Throughput: " << (total.ok + total.nopath) / seconds << " queries/s (" << seconds << " s)\n";
+    print_latency("Round-trip", total.round_trip_us);
+    print_latency("Server", total.server_us);
+
+    int fd = connect_to(socket_path);
+    if (fd >= 0) {
+        string buffer, line;
+        if (send_all(fd, "stats\n") && read_line(fd, buffer, line)) cout << "Server " << line << "\n";
+        if (stop_server) send_all(fd, "shutdown\n");
+        close(fd);
+    }
+    return total.errors == 0 ? 0 : 1;
+}
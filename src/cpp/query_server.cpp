@@ -0,0 +1,402 @@
+#include "query_server.h"
+#include "grid_astar.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char* HEURISTIC_NAMES[] = {"", "zero", "octile", "fastmap"};
+
+bool parse_request(const string& line, QueryRequest& request, string& error) {
+    istringstream in(line);
+    string map;
+    if (!(in >> request.id >> map >> request.start.first >> request.start.second >> request.goal.first >>
+          request.goal.second)) {
+        error = "malformed request";
+        return false;
+    }
+    bool is_index = map.size() <= 9 && map.find_first_not_of("0123456789") == string::npos;
+    request.map = is_index ? stoi(map) : -1;
+    request.map_path = is_index ? "" : map;
+    request.heuristic = QueryHeuristic::Default;
+    string name;
+    if (in >> name) {
+        if (name == "zero") request.heuristic = QueryHeuristic::Zero;
+        else if (name == "octile") request.heuristic = QueryHeuristic::Octile;
+        else if (name == "fastmap") request.heuristic = QueryHeuristic::FastMap;
+        else {
+            error = "unknown heuristic " + name;
+            return false;
+        }
+    }
+    return true;
+}
+
+string format_request(const QueryRequest& request) {
+    ostringstream out;
+    out << request.id << " ";
+    if (request.map_path.empty()) out << request.map;
+    else out << request.map_path;
+    out << " " << request.start.first << " " << request.start.second << " "
+        << request.goal.first << " " << request.goal.second;
+    if (request.heuristic != QueryHeuristic::Default) out << " " << HEURISTIC_NAMES[(int)request.heuristic];
+    out << "\n";
+    return out.str();
+}
+
+LatencySummary summarize(vector<double> samples) {
+    LatencySummary s;
+    s.count = samples.size();
+    if (samples.empty()) return s;
+    sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double x : samples) total += x;
+    auto at = [&](double q) { return samples[min(samples.size() - 1, (size_t)(q * samples.size()))]; };
+    s.mean = total / samples.size();
+    s.p50 = at(0.50);
+    s.p90 = at(0.90);
+    s.p99 = at(0.99);
+    s.max = samples.back();
+    return s;
+}
+
+QueryServer::Connection::~Connection() {
+    if (!owns_fd) return;
+    close(in_fd);
+}
+
+void QueryServer::Connection::write_all(const string& data) {
+    lock_guard<mutex> lock(write_mutex);
+    for (size_t done = 0; done < data.size();) {
+        ssize_t n = write(out_fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return; // client went away; its replies are dropped
+        done += n;
+    }
+}
+
+QueryServer::QueryServer(const vector<string>& map_files, const MapRegistryOptions& options)
+    : files(map_files), registry(options) {
+    for (const string& file : files) {
+        string error;
+        if (!registry.acquire(file, &error)) cerr << error << endl;
+    }
+}
+
+QueryServer::~QueryServer() {
+    stop_workers();
+}
+
+void QueryServer::start_workers() {
+    started = chrono::steady_clock::now();
+    draining = false;
+    for (int t = 0; t < max(1, threads); ++t) workers.emplace_back(&QueryServer::worker, this);
+}
+
+void QueryServer::stop_workers() {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        draining = true;
+    }
+    queue_ready.notify_all();
+    for (thread& t : workers) t.join();
+    workers.clear();
+}
+
+void QueryServer::request_stop() {
+    stop_requested = true;
+    if (listen_fd >= 0) shutdown(listen_fd, SHUT_RDWR); // wakes accept()
+}
+
+string QueryServer::map_path(const QueryRequest& request, string& error) const {
+    if (request.map_path.empty()) {
+        if (request.map >= 0 && request.map < (int)files.size()) return files[request.map];
+        error = "unknown map " + to_string(request.map);
+        return "";
+    }
+    const string& path = request.map_path;
+    if (map_root.empty()) {
+        error = "maps can only be named by position";
+        return "";
+    }
+    bool dotdot = false;
+    for (size_t begin = 0, end; begin <= path.size(); begin = end + 1) {
+        end = min(path.find('/', begin), path.size());
+        if (path.compare(begin, end - begin, "..") == 0) dotdot = true;
+    }
+    if (path[0] == '/' || dotdot || path.size() < 4 || path.compare(path.size() - 4, 4, ".map") != 0) {
+        error = "map path must be a relative .map path without ..";
+        return "";
+    }
+    return map_root + "/" + path;
+}
+
+string QueryServer::answer(const QueryRequest& request, const LoadedMap* loaded, const string& map_error,
+                           FlatNodeStore& store, bool& timed) {
+    ostringstream out;
+    out << request.id << " ";
+    timed = false;
+    if (!loaded) {
+        out << "error " << map_error;
+        return out.str();
+    }
+    const LoadedMap& m = *loaded;
+    if (!m.grid.in_bounds(request.start.first, request.start.second) ||
+        !m.grid.in_bounds(request.goal.first, request.goal.second)) {
+        out << "error cell outside the " << m.grid.rows << "x" << m.grid.cols << " map";
+        return out.str();
+    }
+    QueryHeuristic heuristic = request.heuristic;
+    if (heuristic == QueryHeuristic::Default)
+        heuristic = m.embedding.dims > 0 ? QueryHeuristic::FastMap : QueryHeuristic::Octile;
+    if (heuristic == QueryHeuristic::FastMap && m.embedding.dims == 0) {
+        out << "error map " << m.name << " has no FastMap embedding";
+        return out.str();
+    }
+
+    timed = true;
+    SearchStats stats;
+    vector<pii> path;
+    // Blocked endpoints and different components: "nopath 0" without a search
+    if (m.components.connected(request.start, request.goal)) {
+        if (heuristic == QueryHeuristic::Zero) {
+            auto zero = [](const pii&, const pii&) { return 0.0f; };
+            path = grid_a_star_with_heuristic(m.grid, request.start, request.goal, store, zero, &stats);
+        } else if (heuristic == QueryHeuristic::FastMap) {
+            path = with_fastmap_heuristic(m.grid, m.embedding, request.goal, [&](const auto& fastmap) {
+                return grid_a_star_with_heuristic(m.grid, request.start, request.goal, store, fastmap, &stats);
+            });
+        } else {
+            path = grid_a_star(m.grid, request.start, request.goal, store, &stats);
+        }
+    }
+    if (path.empty()) out << "nopath " << stats.expansions;
+    else out << "ok " << stats.cost << " " << path.size() << " " << stats.expansions;
+    return out.str();
+}
+
+void QueryServer::worker() {
+    FlatNodeStore store;
+    vector<Pending> batch;
+    vector<double> batch_latencies;
+    for (;;) {
+        {
+            unique_lock<mutex> lock(queue_mutex);
+            queue_ready.wait(lock, [&] { return !queue.empty() || draining; });
+            if (queue.empty()) return;
+            // Give the batch until batch_window after its oldest request to fill
+            auto deadline = queue.front().received + batch_window;
+            while (queue.size() < batch_size && !draining &&
+                   queue_ready.wait_until(lock, deadline) == cv_status::no_timeout) {
+            }
+            if (queue.empty()) continue; // another worker took them
+            size_t n = min(batch_size, queue.size());
+            batch.assign(make_move_iterator(queue.begin()), make_move_iterator(queue.begin() + n));
+            queue.erase(queue.begin(), queue.begin() + n);
+        }
+
+        vector<string> paths(batch.size()), path_errors(batch.size());
+        vector<size_t> order(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            paths[i] = map_path(batch[i].request, path_errors[i]);
+            order[i] = i;
+        }
+        stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return paths[a] < paths[b]; });
+        vector<string> replies(batch.size());
+        vector<bool> timed(batch.size());
+        // The handle keeps the map alive for the group even if it is evicted
+        MapHandle current;
+        string current_path, map_error;
+        for (size_t n = 0; n < order.size(); ++n) {
+            size_t i = order[n];
+            bool t;
+            if (paths[i].empty()) {
+                replies[i] = answer(batch[i].request, nullptr, path_errors[i], store, t);
+                timed[i] = t;
+                continue;
+            }
+            if (paths[i] != current_path) {
+                current_path = paths[i];
+                map_error.clear();
+                current.reset(); // evictable while the next map loads
+                current = registry.acquire(current_path, &map_error);
+            }
+            replies[i] = answer(batch[i].request, current.get(), map_error, store, t);
+            timed[i] = t;
+        }
+        current.reset();
+
+        // One write per connection; latency is taken as the replies go out
+        map<Connection*, vector<size_t>> by_connection;
+        for (size_t i = 0; i < batch.size(); ++i) by_connection[batch[i].connection.get()].push_back(i);
+        batch_latencies.clear();
+        uint64_t batch_errors = 0;
+        for (auto& [connection, items] : by_connection) {
+            auto now = chrono::steady_clock::now();
+            string data;
+            for (size_t i : items) {
+                data += replies[i];
+                if (timed[i]) {
+                    double us = chrono::duration<double, micro>(now - batch[i].received).count();
+                    data += " " + to_string((long long)us);
+                    batch_latencies.push_back(us);
+                } else {
+                    ++batch_errors;
+                }
+                data += "\n";
+            }
+            connection->write_all(data);
+        }
+
+        lock_guard<mutex> lock(stats_mutex);
+        latencies.insert(latencies.end(), batch_latencies.begin(), batch_latencies.end());
+        errors += batch_errors;
+        batched += batch.size();
+        ++batches;
+        batch.clear();
+    }
+}
+
+string QueryServer::stats_line() {
+    lock_guard<mutex> lock(stats_mutex);
+    LatencySummary s = summarize(latencies);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    ostringstream out;
+    out << "requests " << s.count << " errors " << errors << " batches " << batches << " mean_batch "
+        << (batches ? (double)batched / batches : 0) << " avg_qps " << (seconds > 0 ? s.count / seconds : 0)
+        << " latency_us mean " << (long long)s.mean << " p50 " << (long long)s.p50 << " p90 " << (long long)s.p90
+        << " p99 " << (long long)s.p99 << " max " << (long long)s.max << " " << registry.stats_line();
+    return out.str();
+}
+
+void QueryServer::read_requests(shared_ptr<Connection> connection) {
+    string buffer;
+    char chunk[1 << 16];
+    for (;;) {
+        ssize_t n = read(connection->in_fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        auto received = chrono::steady_clock::now();
+        buffer.append(chunk, n);
+
+        vector<Pending> parsed;
+        size_t begin = 0;
+        for (size_t end; (end = buffer.find('\n', begin)) != string::npos; begin = end + 1) {
+            string line = buffer.substr(begin, end - begin);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            if (line == "stats") {
+                connection->write_all("stats " + stats_line() + "\n");
+                continue;
+            }
+            if (line == "shutdown") {
+                request_stop();
+                break;
+            }
+            Pending pending;
+            string error;
+            if (!parse_request(line, pending.request, error)) {
+                connection->write_all(line.substr(0, line.find(' ')) + " error " + error + "\n");
+                lock_guard<mutex> lock(stats_mutex);
+                ++errors;
+                continue;
+            }
+            pending.connection = connection;
+            pending.received = received;
+            parsed.push_back(move(pending));
+        }
+        buffer.erase(0, begin);
+
+        if (!parsed.empty()) {
+            {
+                lock_guard<mutex> lock(queue_mutex);
+                for (Pending& p : parsed) queue.push_back(move(p));
+            }
+            if (parsed.size() == 1) queue_ready.notify_one();
+            else queue_ready.notify_all();
+        }
+        if (stop_requested) return;
+    }
+}
+
+void QueryServer::serve_stdio() {
+    signal(SIGPIPE, SIG_IGN);
+    start_workers();
+    read_requests(make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false));
+    stop_workers();
+}
+
+bool QueryServer::serve_socket(const string& path) {
+    signal(SIGPIPE, SIG_IGN);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        cerr << "Socket path too long: " << path << endl;
+        return false;
+    }
+    path.copy(addr.sun_path, path.size());
+    // Replace a stale socket from an earlier run, but nothing else
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            cerr << "Not a socket, refusing to replace: " << path << endl;
+            return false;
+        }
+        unlink(path.c_str());
+    }
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+        cerr << "Failed to listen on " << path << ": " << strerror(errno) << endl;
+        if (listen_fd >= 0) close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    start_workers();
+    // One reader thread per client; finished ones are joined and dropped on
+    // the next accept so a resident server does not grow per client
+    struct Reader {
+        thread t;
+        shared_ptr<atomic<bool>> done;
+        weak_ptr<Connection> connection;
+    };
+    vector<Reader> readers;
+    auto reap = [&]() {
+        auto finished = partition(readers.begin(), readers.end(), [](const Reader& r) { return !*r.done; });
+        for (auto it = finished; it != readers.end(); ++it) it->t.join();
+        readers.erase(finished, readers.end());
+    };
+    while (!stop_requested) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break; // listening socket shut down
+        }
+        reap();
+        auto connection = make_shared<Connection>(fd, fd, true);
+        auto done = make_shared<atomic<bool>>(false);
+        thread t([this, connection, done]() {
+            read_requests(connection);
+            *done = true;
+        });
+        readers.push_back({move(t), done, connection});
+    }
+
+    // Stop reading; queued requests are still answered
+    for (Reader& r : readers) {
+        if (auto connection = r.connection.lock()) shutdown(connection->in_fd, SHUT_RD);
+    }
+    for (Reader& r : readers) r.t.join();
+    stop_workers();
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(path.c_str());
+    return true;
+}
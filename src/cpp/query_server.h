@@ -0,0 +1,146 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include "grid_map.h"
+#include "map_registry.h"
+#include "node_store.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Line protocol shared by serve_queries and query_client. One request or
+// reply per line, fields separated by spaces:
+//
+//   request:  <id> <map> <start_row> <start_col> <goal_row> <goal_col> [zero|octile|fastmap]
+//   reply:    <id> ok <cost> <cells> <expansions> <latency_us>
+//             <id> nopath <expansions> <latency_us>
+//             <id> error <message>
+//
+// <map> is the position of a map on the server's command line, or, if the
+// server was given a map root, the path of a .map file relative to it, which
+// is loaded on first use and cached (see MapRegistry). Absolute paths and
+// paths with ".." components are refused, so clients can only open files
+// under the root (symlinks inside it are followed). Without a heuristic the
+// best one loaded is used (fastmap if the map was embedded).
+// latency_us runs from the moment the server read the request to the moment
+// its reply was handed to the socket. Replies on one connection can come
+// back out of order; match them by id.
+//
+// Two control lines: "stats" replies with "stats <summary>", "shutdown"
+// stops the server once queued requests are answered. The stats summary
+// includes the map cache counters (MapRegistry::stats_line).
+
+enum class QueryHeuristic { Default, Zero, Octile, FastMap };
+
+struct QueryRequest {
+    uint64_t id = 0;
+    int map = 0;
+    string map_path; // set instead of map when the request names a file
+    pii start, goal;
+    QueryHeuristic heuristic = QueryHeuristic::Default;
+};
+
+// false (with error set) if line is not a well-formed request
+bool parse_request(const string& line, QueryRequest& request, string& error);
+string format_request(const QueryRequest& request);
+
+// Latency samples in microseconds and the percentiles of them
+struct LatencySummary {
+    size_t count = 0;
+    double mean = 0, p50 = 0, p90 = 0, p99 = 0, max = 0;
+};
+LatencySummary summarize(vector<double> samples);
+
+// Resident query server. Readers turn request lines into queue entries;
+// a pool of workers takes them off the queue in micro-batches (up to
+// batch_size requests, waiting at most batch_window for the batch to fill
+// once the first request is in). A batch costs one queue lock, is run
+// grouped by map so each map is acquired from the registry once per batch
+// and the worker's node store stays warm, and its replies go out with one
+// write per connection.
+class QueryServer {
+public:
+    int threads = 1;
+    size_t batch_size = 32;
+    chrono::microseconds batch_window{200};
+    // Directory requests may load maps from by relative path; empty allows
+    // only the preloaded maps
+    string map_root;
+
+    // Preloads map_files (addressable by position) into a registry with the
+    // given memory budget and FastMap dimensions; other maps load on demand
+    QueryServer(const vector<string>& map_files, const MapRegistryOptions& options);
+    ~QueryServer();
+
+    const vector<string>& map_files() const { return files; }
+    MapRegistry& maps() { return registry; }
+
+    // Serves one client on stdin/stdout until EOF or "shutdown"
+    void serve_stdio();
+    // Accepts clients on a Unix domain socket until "shutdown". Returns false
+    // if the socket cannot be set up.
+    bool serve_socket(const string& path);
+
+    string stats_line();
+
+private:
+    // One client: requests are read from in_fd, replies written to out_fd
+    struct Connection {
+        int in_fd, out_fd;
+        bool owns_fd;
+        mutex write_mutex;
+        Connection(int in_fd, int out_fd, bool owns_fd) : in_fd(in_fd), out_fd(out_fd), owns_fd(owns_fd) {}
+        ~Connection();
+        void write_all(const string& data);
+    };
+
+    struct Pending {
+        QueryRequest request;
+        shared_ptr<Connection> connection;
+        chrono::steady_clock::time_point received;
+    };
+
+    vector<string> files;
+    MapRegistry registry;
+
+    mutex queue_mutex;
+    condition_variable queue_ready;
+    deque<Pending> queue;
+    bool draining = false; // no more requests; workers exit once the queue is empty
+    vector<thread> workers;
+
+    atomic<bool> stop_requested{false};
+    int listen_fd = -1;
+
+    mutex stats_mutex;
+    vector<double> latencies;
+    uint64_t batches = 0;
+    uint64_t batched = 0; // requests that went through a batch
+    uint64_t errors = 0;
+    chrono::steady_clock::time_point started;
+
+    void start_workers();
+    void stop_workers();
+    void worker();
+    void read_requests(shared_ptr<Connection> connection);
+    void request_stop();
+    // Map file a request refers to; "" (with error set) for an unknown
+    // position or a path outside map_root
+    string map_path(const QueryRequest& request, string& error) const;
+    // Reply line for one request on map m (nullptr if it failed to load with
+    // map_error), up to (not including) the latency field; timed is false
+    // for error replies, which carry none
+    string answer(const QueryRequest& request, const LoadedMap* m, const string& map_error, FlatNodeStore& store,
+                  bool& timed);
+};
+
+#endif // QUERY_SERVER_H
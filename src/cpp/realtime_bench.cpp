@@ -0,0 +1,138 @@
+// Real-time search (LRTA* / RTAA*) against full A*: solution cost relative
+// to optimal and per-step latency for each lookahead size.
+// Usage: realtime_bench [map_file] [scen_file] [lookaheads] [rules] [max_scenarios] [trials] [octile|fastmap]
+// lookaheads: comma-separated expansions per step; rules: lrta, rtaa or both.
+// Each scenario is driven to the goal `trials` times in a row with the
+// learned values kept; the first and last trial are reported.
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "fastmap_embedding.h"
+#include "realtime_search.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+double mean_of(const vector<double>& v) {
+    double total = 0;
+    for (double x : v) total += x;
+    return v.empty() ? 0 : total / v.size();
+}
+
+struct TrialTotals {
+    double cost = 0, optimal = 0;
+    uint64_t steps = 0, expansions = 0;
+    int failed = 0;
+};
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    string scen_file = argc > 2 ? argv[2] : "AcrosstheCape.map.scen";
+    string lookaheads = argc > 3 ? argv[3] : "1,4,16,64,256";
+    string rules = argc > 4 ? argv[4] : "both";
+    int max_scenarios = argc > 5 ? stoi(argv[5]) : 100;
+    int trials = argc > 6 ? max(1, stoi(argv[6])) : 1;
+    string heuristic = argc > 7 ? argv[7] : "octile";
+
+    GridMap map = read_grid_map(map_file);
+    ComponentIndex components(map);
+    vector<Scenario> all = read_scenarios(scen_file), scenarios;
+    // Evenly spread over the buckets, solvable ones only
+    int n = min<int>(max_scenarios, all.size());
+    for (int i = 0; i < n; ++i) {
+        const Scenario& s = all[(size_t)i * all.size() / n];
+        if (components.connected(s.start, s.goal)) scenarios.push_back(s);
+    }
+
+    FastMapEmbedding embedding;
+    RealTimeSearch::BaseHeuristic base = [](const pii& a, const pii& b) { return octile(a, b); };
+    if (heuristic == "fastmap") {
+        embedding = build_fastmap(map, 8, 1);
+        base = [&](const pii& a, const pii& b) {
+            return max(octile(a, b), embedding.distance(map.index(a), map.index(b)));
+        };
+    }
+    cout << "Map " << map.rows << "x" << map.cols << ", " << scenarios.size() << " scenarios, " << heuristic
+         << " seed heuristic\n";
+
+    // Baseline: one full A* per query, which is what a step would cost
+    // without a lookahead bound
+    vector<double> optimal(scenarios.size());
+    vector<double> astar_us;
+    FlatNodeStore store;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        SearchStats stats;
+        Timer timer;
+        grid_a_star(map, scenarios[i].start, scenarios[i].goal, store, &stats);
+        astar_us.push_back(timer.seconds() * 1e6);
+        optimal[i] = stats.cost;
+    }
+    if (scenarios.empty()) return 1;
+    sort(astar_us.begin(), astar_us.end());
+    cout << "Full A*: mean " << fixed << setprecision(1)
+         << mean_of(astar_us) << " us, p99 " << astar_us[min(astar_us.size() - 1, astar_us.size() * 99 / 100)]
+         << " us, max " << astar_us.back() << " us per query\n\n";
+
+    cout << setw(6) << "rule" << setw(7) << "N" << setw(11) << "cost/opt" << setw(11) << "last/opt" << setw(10)
+         << "steps" << setw(10) << "exp/step" << setw(12) << "mean us" << setw(10) << "p99 us" << setw(10)
+         << "max us" << setw(8) << "failed" << "\n";
+    stringstream list(lookaheads);
+    for (string item; getline(list, item, ',');) {
+        int lookahead = stoi(item);
+        for (RealTimeRule rule : {RealTimeRule::LRTA, RealTimeRule::RTAA}) {
+            string rule_name = rule == RealTimeRule::LRTA ? "lrta" : "rtaa";
+            if (rules != "both" && rules != rule_name) continue;
+            RealTimeSearch agent(map, base, rule, lookahead);
+            vector<TrialTotals> totals(trials);
+            vector<double> step_us;
+            for (size_t i = 0; i < scenarios.size(); ++i) {
+                const Scenario& s = scenarios[i];
+                agent.set_goal(s.goal);
+                // Give up on trajectories far beyond any sensible length
+                uint64_t max_steps = 100 * (uint64_t)(optimal[i] + 10);
+                for (int trial = 0; trial < trials; ++trial) {
+                    TrialTotals& t = totals[trial];
+                    uint64_t before = agent.expansions;
+                    pii at = s.start;
+                    double cost = 0;
+                    uint64_t steps = 0;
+                    while (at != s.goal && steps < max_steps) {
+                        Timer timer;
+                        pii next = agent.step(at);
+                        step_us.push_back(timer.seconds() * 1e6);
+                        if (next.first < 0) break;
+                        cost += octile(at, next);
+                        at = next;
+                        ++steps;
+                    }
+                    if (at != s.goal) {
+                        ++t.failed;
+                        continue;
+                    }
+                    t.cost += cost;
+                    t.optimal += optimal[i];
+                    t.steps += steps;
+                    t.expansions += agent.expansions - before;
+                }
+            }
+            if (step_us.empty()) continue;
+            sort(step_us.begin(), step_us.end());
+            const TrialTotals& first = totals.front();
+            const TrialTotals& last = totals.back();
+            cout << setw(6) << rule_name << setw(7) << lookahead << setw(11) << setprecision(3)
+                 << first.cost / max(first.optimal, 1e-9) << setw(11) << last.cost / max(last.optimal, 1e-9)
+                 << setw(10) << first.steps << setw(10) << setprecision(1)
+                 << (double)first.expansions / max<uint64_t>(first.steps, 1) << setw(12) << setprecision(2)
+                 << mean_of(step_us) << setw(10)
+                 << step_us[min(step_us.size() - 1, step_us.size() * 99 / 100)] << setw(10) << step_us.back()
+                 << setw(8) << first.failed << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "realtime_search.h"
+#include <algorithm>
+#include <cmath>
+
+RealTimeSearch::RealTimeSearch(const GridMap& map, BaseHeuristic base, RealTimeRule rule, int lookahead)
+    : rule(rule), lookahead(max(1, lookahead)), map(map), base(move(base)) {
+    learned.assign(map.size(), 0.0f);
+    stamp.assign(map.size(), 0);
+    // Allocate the node table and lookahead buffers here, so the first
+    // step() costs no more than the others
+    store.reset(map);
+    open_list.reserve(8 * (size_t)this->lookahead + 1);
+    closed_cells.reserve(this->lookahead);
+}
+
+void RealTimeSearch::set_goal(const pii& new_goal) {
+    if (new_goal == goal) return;
+    goal = new_goal;
+    if (++goal_generation == 0) {
+        fill(stamp.begin(), stamp.end(), 0);
+        goal_generation = 1;
+    }
+}
+
+float RealTimeSearch::h(int cell) {
+    if (stamp[cell] != goal_generation) {
+        stamp[cell] = goal_generation;
+        learned[cell] = base(map.cell(cell), goal);
+    }
+    return learned[cell];
+}
+
+size_t RealTimeSearch::bytes() const {
+    return learned.capacity() * sizeof(float) + stamp.capacity() * sizeof(uint32_t) + store.bytes();
+}
+
+pii RealTimeSearch::step(const pii& current) {
+    if (current == goal) return current;
+    auto cmp = greater<pair<float, int>>();
+    store.reset(map);
+    open_list.clear();
+    closed_cells.clear();
+    int s = map.index(current);
+    int t = map.index(goal);
+    store.set(s, 0.0f, s, 0);
+    open_list.emplace_back(h(s), s);
+
+    // Bounded A*: stops with the best frontier cell on top of the heap
+    int best = -1;
+    while (!open_list.empty()) {
+        int cell = open_list.front().second;
+        if (store.closed(cell)) {
+            pop_heap(open_list.begin(), open_list.end(), cmp);
+            open_list.pop_back();
+            continue;
+        }
+        if (cell == t || (int)closed_cells.size() >= lookahead) {
+            best = cell;
+            break;
+        }
+        pop_heap(open_list.begin(), open_list.end(), cmp);
+        open_list.pop_back();
+        store.close(cell);
+        closed_cells.push_back(cell);
+        ++expansions;
+
+        int r = cell / map.cols, c = cell % map.cols;
+        float g = store.g(cell);
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!map.can_move(r, c, dir)) continue;
+            int nb = cell + map.dir_offset(dir);
+            if (store.closed(nb)) continue;
+            float tentative_g = g + dir_cost(dir);
+            if (!store.generated(nb) || tentative_g < store.g(nb)) {
+                store.set(nb, tentative_g, cell, dir);
+                open_list.emplace_back(tentative_g + h(nb), nb);
+                push_heap(open_list.begin(), open_list.end(), cmp);
+            }
+        }
+    }
+    if (best < 0) return {-1, -1}; // the whole component was searched
+
+    if (rule == RealTimeRule::RTAA) update_rtaa(best);
+    else update_lrta();
+
+    // First move on the lookahead path towards best
+    int next = best;
+    while (store.parent(next) != s) next = store.parent(next);
+    return map.cell(next);
+}
+
+void RealTimeSearch::update_rtaa(int best) {
+    float f_best = store.g(best) + h(best);
+    for (int cell : closed_cells) learned[cell] = max(learned[cell], f_best - store.g(cell));
+}
+
+void RealTimeSearch::update_lrta() {
+    // Expanded cells start at infinity and are lowered from the frontier
+    // outwards, smallest h first, so each is settled once
+    for (int cell : closed_cells) learned[cell] = INFINITY;
+    vector<pair<float, int>>& frontier = open_list;
+    auto cmp = greater<pair<float, int>>();
+    for (auto& entry : frontier) entry.first = h(entry.second);
+    make_heap(frontier.begin(), frontier.end(), cmp);
+    while (!frontier.empty()) {
+        pop_heap(frontier.begin(), frontier.end(), cmp);
+        auto [value, cell] = frontier.back();
+        frontier.pop_back();
+        if (value > learned[cell]) continue;
+        int r = cell / map.cols, c = cell % map.cols;
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!map.can_move(r, c, dir)) continue;
+            int nb = cell + map.dir_offset(dir);
+            // Moves are symmetric, so nb -> cell costs the same
+            if (!store.closed(nb) || learned[nb] <= value + dir_cost(dir)) continue;
+            learned[nb] = value + dir_cost(dir);
+            frontier.emplace_back(learned[nb], nb);
+            push_heap(frontier.begin(), frontier.end(), cmp);
+        }
+    }
+}
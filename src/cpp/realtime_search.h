@@ -0,0 +1,72 @@
+#ifndef REALTIME_SEARCH_H
+#define REALTIME_SEARCH_H
+
+#include "grid_map.h"
+#include "node_store.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+// Real-time heuristic search on a GridMap: every step() runs an A*
+// lookahead of at most `lookahead` expansions from the agent's cell, raises
+// the learned h-values of the cells it expanded, and returns the next cell
+// to move to. The work per step is bounded by the lookahead however far
+// away the goal is; the price is a longer (suboptimal) trajectory, which
+// shrinks as the lookahead grows and as the agent repeats trips to the
+// same goal, since the learned values are kept.
+//
+//   LRTA: Dijkstra-style backup from the lookahead frontier into the expanded
+//         cells, h(s) = min over neighbours c(s, s') + h(s') (LSS-LRTA*).
+//   RTAA: h(s) = f(best frontier cell) - g(s) for every expanded cell; one
+//         pass over the expanded cells, slightly less informed (Koenig and
+//         Likhachev, "Real-Time Adaptive A*").
+//
+// The agent moves one cell per step along the lookahead's path to the best
+// frontier cell (the one with the lowest f) and searches again from there.
+enum class RealTimeRule { LRTA, RTAA };
+
+class RealTimeSearch {
+public:
+    // Seed for cells the agent has not learned anything about yet
+    using BaseHeuristic = function<float(const pii& cell, const pii& goal)>;
+
+    RealTimeSearch(const GridMap& map, BaseHeuristic base, RealTimeRule rule, int lookahead);
+
+    // Learned values are per goal: they are kept when the goal is the same
+    // as before and dropped (in O(1)) when it changes
+    void set_goal(const pii& goal);
+
+    // Next cell on the way to the goal: a neighbour of current, current
+    // itself at the goal, or {-1, -1} if the goal cannot be reached
+    pii step(const pii& current);
+
+    // Learned (or seeded) h-value of a cell for the current goal
+    float h(int cell);
+
+    RealTimeRule rule;
+    int lookahead;
+    uint64_t expansions = 0; // over all steps
+    size_t bytes() const;
+
+private:
+    void update_lrta();
+    void update_rtaa(int best);
+
+    const GridMap& map;
+    BaseHeuristic base;
+    pii goal = {-1, -1};
+
+    // Flat per-cell table for the current goal; a cell whose stamp is not
+    // the goal's generation still has its seed value
+    vector<float> learned;
+    vector<uint32_t> stamp;
+    uint32_t goal_generation = 0;
+
+    FlatNodeStore store;                   // lookahead g-values and parents
+    vector<pair<float, int>> open_list;    // binary heap, smallest f first
+    vector<int> closed_cells;
+};
+
+#endif // REALTIME_SEARCH_H
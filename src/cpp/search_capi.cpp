@@ -0,0 +1,371 @@
+#include "search_capi.h"
+#include "fastmap_dynamic.h"
+#include "fastmap_embedding.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "grid_map.h"
+#include "node_store.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct sa_map {
+    GridMap grid;
+    ComponentIndex components;
+    FastMapEmbedding embedding;
+    unique_ptr<FastMapUpdater> updater; // after the first edit of a pivot embedding
+    FlatNodeStore store; // for sa_query
+};
+
+static thread_local string last_error;
+
+static int fail(int code, const string& message) {
+    last_error = message;
+    return code;
+}
+
+// Runs the body of an entry point. Exceptions must not cross into the C
+// caller, so they come back as on_error with last_error set.
+template <class R, class F>
+static R guarded(R on_error, F body) {
+    try {
+        return body();
+    } catch (const bad_alloc&) {
+        last_error = "Out of memory";
+    } catch (const exception& e) {
+        last_error = e.what();
+    }
+    return on_error;
+}
+
+// Element at byte offset i * s0 + j * s1 (+ k * s2) of a strided buffer
+template <class T>
+static T& at(T* base, ptrdiff_t s0, ptrdiff_t i, ptrdiff_t s1 = 0, ptrdiff_t j = 0, ptrdiff_t s2 = 0,
+             ptrdiff_t k = 0) {
+    using Byte = typename conditional<is_const<T>::value, const char, char>::type;
+    return *reinterpret_cast<T*>(reinterpret_cast<Byte*>(base) + i * s0 + j * s1 + k * s2);
+}
+
+static bool check_cell(const sa_map* map, int r, int c, const char* what) {
+    if (map->grid.in_bounds(r, c)) return true;
+    last_error = string(what) + " (" + to_string(r) + ", " + to_string(c) + ") is outside the " +
+                 to_string(map->grid.rows) + "x" + to_string(map->grid.cols) + " map";
+    return false;
+}
+
+static int check_heuristic(const sa_map* map, int heuristic) {
+    if (heuristic < SA_HEURISTIC_ZERO || heuristic > SA_HEURISTIC_FASTMAP)
+        return fail(SA_ERR_ARGUMENT, "Unknown heuristic " + to_string(heuristic));
+    if (heuristic == SA_HEURISTIC_FASTMAP && map->embedding.dims == 0)
+        return fail(SA_ERR_NO_EMBEDDING, "FastMap heuristic requested but the map has no embedding");
+    return SA_OK;
+}
+
+// A* on map with the selected heuristic; {} when there is no path
+static vector<pii> run_query(const sa_map* map, int heuristic, const pii& start, const pii& goal,
+                             FlatNodeStore& store, SearchStats& stats) {
+    const GridMap& grid = map->grid;
+    if (!map->components.connected(start, goal)) return {};
+    if (heuristic == SA_HEURISTIC_ZERO) {
+        auto zero = [](const pii&, const pii&) { return 0.0f; };
+        return grid_a_star_with_heuristic(grid, start, goal, store, zero, &stats);
+    }
+    if (heuristic == SA_HEURISTIC_FASTMAP) {
+        return with_fastmap_heuristic(grid, map->embedding, goal, [&](const auto& fastmap) {
+            return grid_a_star_with_heuristic(grid, start, goal, store, fastmap, &stats);
+        });
+    }
+    return grid_a_star(grid, start, goal, store, &stats);
+}
+
+extern "C" {
+
+int sa_api_version(void) {
+    return SA_API_VERSION;
+}
+
+const char* sa_last_error(void) {
+    return last_error.c_str();
+}
+
+sa_map* sa_map_load(const char* path) {
+    if (!path) {
+        last_error = "Map path is NULL";
+        return nullptr;
+    }
+    return guarded<sa_map*>(nullptr, [&]() -> sa_map* {
+        auto map = make_unique<sa_map>();
+        if (!load_grid_map(path, map->grid, &last_error)) return nullptr;
+        map->components.build(map->grid);
+        return map.release();
+    });
+}
+
+sa_map* sa_map_from_buffer(int rows, int cols, const uint8_t* passable, ptrdiff_t row_stride,
+                           ptrdiff_t col_stride) {
+    return guarded<sa_map*>(nullptr, [&]() -> sa_map* {
+        if (!passable || rows <= 0 || cols <= 0) {
+            last_error = "Map buffer must be non-empty";
+            return nullptr;
+        }
+        auto map = make_unique<sa_map>();
+        map->grid.rows = rows;
+        map->grid.cols = cols;
+        map->grid.passable.resize(map->grid.size());
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                map->grid.passable[map->grid.index(r, c)] = at(passable, row_stride, r, col_stride, c) != 0;
+            }
+        }
+        map->components.build(map->grid);
+        return map.release();
+    });
+}
+
+void sa_map_free(sa_map* map) {
+    delete map;
+}
+
+int sa_map_rows(const sa_map* map) {
+    return map->grid.rows;
+}
+
+int sa_map_cols(const sa_map* map) {
+    return map->grid.cols;
+}
+
+const uint8_t* sa_map_passable(const sa_map* map) {
+    return map->grid.passable.data();
+}
+
+int sa_map_set_passable(sa_map* map, int row, int col, int passable) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        if (!check_cell(map, row, col, "Cell")) return SA_ERR_BOUNDS;
+        if ((passable != 0) == (map->grid.passable[map->grid.index(row, col)] != 0)) return SA_OK;
+        if (passable) map->components.open_cell(map->grid, row, col);
+        else map->components.block_cell(map->grid, row, col);
+        if (map->embedding.dims == 0) return SA_OK;
+        if (map->embedding.pivots.empty()) {
+            // Caller-supplied coordinates cannot be maintained
+            if (passable) map->embedding = FastMapEmbedding(); // may now overestimate
+        } else if (!map->updater) {
+            map->updater = make_unique<FastMapUpdater>(map->grid, map->embedding);
+        } else {
+            map->updater->update({{row, col}});
+        }
+        return SA_OK;
+    });
+}
+
+int sa_map_component(const sa_map* map, int row, int col) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        if (!check_cell(map, row, col, "Cell")) return SA_ERR_BOUNDS;
+        return map->components.label(row, col);
+    });
+}
+
+int sa_build_fastmap(sa_map* map, int max_dims, uint32_t seed) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        if (max_dims < 0 || max_dims > FastMapEmbedding::MAX_DIMS)
+            return fail(SA_ERR_ARGUMENT, "max_dims must be 0 to " + to_string(FastMapEmbedding::MAX_DIMS));
+        map->updater.reset();
+        map->embedding = build_fastmap(map->grid, max_dims, seed);
+        return map->embedding.dims;
+    });
+}
+
+int sa_tune_fastmap(sa_map* map, int max_dims, uint32_t seed, int n, const int32_t* queries,
+                    ptrdiff_t query_row_stride, ptrdiff_t query_col_stride) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        if (max_dims < 0 || max_dims > FastMapEmbedding::MAX_DIMS)
+            return fail(SA_ERR_ARGUMENT, "max_dims must be 0 to " + to_string(FastMapEmbedding::MAX_DIMS));
+        if (n <= 0 || !queries) return fail(SA_ERR_ARGUMENT, "Tuning needs sample queries");
+        vector<Scenario> sample;
+        for (int i = 0; i < n; ++i) {
+            auto q = [&](int k) { return at(queries, query_row_stride, i, query_col_stride, k); };
+            if (!check_cell(map, q(0), q(1), "Start") || !check_cell(map, q(2), q(3), "Goal")) return SA_ERR_BOUNDS;
+            sample.push_back({{q(0), q(1)}, {q(2), q(3)}, 0.0});
+        }
+        FastMapTuneOptions options;
+        options.max_dims = max_dims;
+        options.seed = seed;
+        map->updater.reset();
+        map->embedding = tune_fastmap(map->grid, sample, options);
+        return map->embedding.dims;
+    });
+}
+
+int sa_set_embedding(sa_map* map, const float* coords, int dims, ptrdiff_t row_stride, ptrdiff_t col_stride,
+                     ptrdiff_t dim_stride) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        if (dims < 0 || dims > FastMapEmbedding::MAX_DIMS || (dims > 0 && !coords))
+            return fail(SA_ERR_ARGUMENT,
+                        "Embedding needs 0 to " + to_string(FastMapEmbedding::MAX_DIMS) + " dims and data");
+        map->updater.reset();
+        FastMapEmbedding& embedding = map->embedding;
+        embedding.dims = dims;
+        embedding.stride = FastMapEmbedding::stride_for(dims);
+        embedding.pivots.clear();
+        embedding.coords.assign(map->grid.size() * embedding.stride, 0.0f);
+        for (int r = 0; r < map->grid.rows; ++r) {
+            for (int c = 0; c < map->grid.cols; ++c) {
+                float* out = &embedding.coords[(size_t)map->grid.index(r, c) * embedding.stride];
+                for (int k = 0; k < dims; ++k) out[k] = at(coords, row_stride, r, col_stride, c, dim_stride, k);
+            }
+        }
+        return SA_OK;
+    });
+}
+
+int sa_embedding_dims(const sa_map* map) {
+    return map->embedding.dims;
+}
+
+int sa_embedding_stride(const sa_map* map) {
+    return map->embedding.stride;
+}
+
+const float* sa_embedding_data(const sa_map* map) {
+    return map->embedding.dims > 0 ? map->embedding.coords.data() : nullptr;
+}
+
+int sa_query(sa_map* map, int heuristic, int start_row, int start_col, int goal_row, int goal_col, float* cost,
+             int32_t* path, ptrdiff_t path_row_stride, ptrdiff_t path_col_stride, int capacity, int* length,
+             uint64_t* expansions) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        int status = check_heuristic(map, heuristic);
+        if (status != SA_OK) return status;
+        if (!check_cell(map, start_row, start_col, "Start") || !check_cell(map, goal_row, goal_col, "Goal"))
+            return SA_ERR_BOUNDS;
+
+        SearchStats stats;
+        vector<pii> cells = run_query(map, heuristic, {start_row, start_col}, {goal_row, goal_col}, map->store, stats);
+        if (expansions) *expansions = stats.expansions;
+        if (length) *length = cells.size();
+        if (cost) *cost = cells.empty() ? INFINITY : stats.cost;
+        if (cells.empty()) return SA_NO_PATH;
+        if (path) {
+            int n = min<int>(cells.size(), max(capacity, 0));
+            for (int i = 0; i < n; ++i) {
+                at(path, path_row_stride, i, path_col_stride, 0) = cells[i].first;
+                at(path, path_row_stride, i, path_col_stride, 1) = cells[i].second;
+            }
+            if (n < (int)cells.size())
+                return fail(SA_ERR_CAPACITY, "Path of " + to_string(cells.size()) + " cells does not fit in " +
+                                                 to_string(capacity));
+        }
+        return SA_OK;
+    });
+}
+
+int sa_query_batch(const sa_map* map, int heuristic, int n, const int32_t* queries, ptrdiff_t query_row_stride,
+                   ptrdiff_t query_col_stride, float* costs, ptrdiff_t cost_stride, int32_t* lengths,
+                   ptrdiff_t length_stride, uint64_t* expansions, int threads) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        int status = check_heuristic(map, heuristic);
+        if (status != SA_OK) return status;
+        if (n < 0 || (n > 0 && (!queries || !costs))) return fail(SA_ERR_ARGUMENT, "Batch needs queries and costs");
+        for (int i = 0; i < n; ++i) {
+            auto q = [&](int k) { return at(queries, query_row_stride, i, query_col_stride, k); };
+            if (!check_cell(map, q(0), q(1), "Start") || !check_cell(map, q(2), q(3), "Goal")) return SA_ERR_BOUNDS;
+        }
+
+        if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+        threads = max(1, min(threads, n));
+        atomic<int> next{0};
+        atomic<uint64_t> total_expansions{0};
+        // A worker's exception is rethrown here once all have stopped
+        vector<exception_ptr> errors(threads);
+        auto worker = [&](int t) {
+            try {
+                FlatNodeStore store;
+                SearchStats stats;
+                for (int i; (i = next.fetch_add(1)) < n;) {
+                    auto q = [&](int k) { return at(queries, query_row_stride, i, query_col_stride, k); };
+                    vector<pii> cells = run_query(map, heuristic, {q(0), q(1)}, {q(2), q(3)}, store, stats);
+                    at(costs, cost_stride, i) = cells.empty() ? INFINITY : stats.cost;
+                    if (lengths) at(lengths, length_stride, i) = cells.size();
+                }
+                total_expansions += stats.expansions;
+            } catch (...) {
+                errors[t] = current_exception();
+                next = n; // the others stop too
+            }
+        };
+        vector<thread> pool;
+        try {
+            for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+        } catch (const system_error&) {
+            // Fewer threads than asked for; the ones running share the work
+        }
+        worker(0);
+        for (thread& t : pool) t.join();
+        for (const exception_ptr& e : errors)
+            if (e) rethrow_exception(e);
+        if (expansions) *expansions = total_expansions;
+        return SA_OK;
+    });
+}
+
+int sa_dijkstra(const sa_map* map, int source_row, int source_col, const float* weights,
+                ptrdiff_t weight_row_stride, ptrdiff_t weight_col_stride, ptrdiff_t weight_dir_stride, float* dist,
+                ptrdiff_t dist_row_stride, ptrdiff_t dist_col_stride) {
+    return guarded<int>(SA_ERR_INTERNAL, [&]() -> int {
+        const GridMap& grid = map->grid;
+        if (!dist) return fail(SA_ERR_ARGUMENT, "Dijkstra needs an output buffer");
+        if (!check_cell(map, source_row, source_col, "Source")) return SA_ERR_BOUNDS;
+        // Every move the search can take; INFINITY means no move
+        for (int r = 0; weights && r < grid.rows; ++r) {
+            for (int c = 0; c < grid.cols; ++c) {
+                for (int dir = 0; dir < 8; ++dir) {
+                    if (!grid.is_passable(r, c) || !grid.can_move(r, c, dir)) continue;
+                    float w = at(weights, weight_row_stride, r, weight_col_stride, c, weight_dir_stride, dir);
+                    if (!(w >= 0.0f))
+                        return fail(SA_ERR_ARGUMENT, "Negative or NaN weight at (" + to_string(r) + ", " +
+                                                         to_string(c) + ") direction " + to_string(dir));
+                }
+            }
+        }
+
+        // A C-contiguous float32 output is filled in place
+        bool contiguous = dist_col_stride == sizeof(float) && dist_row_stride == (ptrdiff_t)(grid.cols * sizeof(float));
+        vector<float> scratch;
+        float* out = dist;
+        if (!contiguous) {
+            scratch.resize(grid.size());
+            out = scratch.data();
+        }
+
+        if (!grid.is_passable(source_row, source_col)) {
+            fill(out, out + grid.size(), INFINITY);
+        } else if (weights) {
+            auto weight = [&](int cell, int dir) {
+                return at(weights, weight_row_stride, cell / grid.cols, weight_col_stride, cell % grid.cols,
+                          weight_dir_stride, dir);
+            };
+            grid_dijkstra(grid, grid.index(source_row, source_col), weight, out);
+        } else {
+            auto weight = [](int, int dir) { return dir_cost(dir); };
+            grid_dijkstra(grid, grid.index(source_row, source_col), weight, out);
+        }
+
+        if (!contiguous) {
+            for (int r = 0; r < grid.rows; ++r) {
+                for (int c = 0; c < grid.cols; ++c) {
+                    at(dist, dist_row_stride, r, dist_col_stride, c) = scratch[grid.index(r, c)];
+                }
+            }
+        }
+        return SA_OK;
+    });
+}
+
+} // extern "C"
@@ -0,0 +1,127 @@
+#ifndef SEARCH_CAPI_H
+#define SEARCH_CAPI_H
+
+/*
+ * Stable C interface to the grid search engine, built as the search_capi
+ * shared library. Meant for ctypes/cffi callers (src/python/search_capi.py).
+ *
+ * Array arguments are a base pointer plus one byte stride per axis, the
+ * layout of a numpy array's .ctypes.data and .strides, so callers pass
+ * their own buffers and results are written straight into them. Cells are
+ * (row, col), as in GridMap.
+ *
+ * Functions returning int return SA_OK (0) or a positive status on success
+ * and a negative SA_ERR_* code on failure; sa_last_error() then describes
+ * the failure on the calling thread; functions returning a map return NULL
+ * instead. No C++ exception escapes and nothing exits the process. A map
+ * handle is not safe for concurrent calls; sa_query_batch parallelizes
+ * internally.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SA_API_VERSION 1
+
+#if defined(_WIN32)
+#define SA_EXPORT __declspec(dllexport)
+#else
+#define SA_EXPORT __attribute__((visibility("default")))
+#endif
+
+enum {
+    SA_OK = 0,
+    SA_NO_PATH = 1,
+    SA_ERR_ARGUMENT = -1,
+    SA_ERR_BOUNDS = -2,   /* cell outside the map */
+    SA_ERR_CAPACITY = -3, /* path buffer too short; *length holds the size needed */
+    SA_ERR_IO = -4,
+    SA_ERR_NO_EMBEDDING = -5,
+    SA_ERR_INTERNAL = -6  /* out of memory or another failure inside the engine */
+};
+
+/* A* heuristics. FASTMAP is max(octile, FastMap L1) and needs an embedding
+ * from sa_build_fastmap or sa_set_embedding. ZERO turns A* into Dijkstra. */
+enum {
+    SA_HEURISTIC_ZERO = 0,
+    SA_HEURISTIC_OCTILE = 1,
+    SA_HEURISTIC_FASTMAP = 2
+};
+
+typedef struct sa_map sa_map;
+
+SA_EXPORT int sa_api_version(void);
+SA_EXPORT const char* sa_last_error(void);
+
+/* Maps. The passable grid is copied once into the handle. */
+SA_EXPORT sa_map* sa_map_load(const char* path);
+SA_EXPORT sa_map* sa_map_from_buffer(int rows, int cols, const uint8_t* passable, ptrdiff_t row_stride,
+                                     ptrdiff_t col_stride);
+SA_EXPORT void sa_map_free(sa_map* map);
+SA_EXPORT int sa_map_rows(const sa_map* map);
+SA_EXPORT int sa_map_cols(const sa_map* map);
+/* Row-major rows x cols bytes, 1 = passable. Valid until sa_map_free. */
+SA_EXPORT const uint8_t* sa_map_passable(const sa_map* map);
+/* Blocks (passable = 0) or opens a cell; the component index is updated
+ * incrementally. An embedding from sa_build_fastmap / sa_tune_fastmap is
+ * kept exact (same pivots): the first edit rebuilds its pivot trees, later
+ * edits repair only what they affect. An embedding from sa_set_embedding is
+ * dropped when a cell opens (it may now overestimate) and kept when one is
+ * blocked, as distances only grow. */
+SA_EXPORT int sa_map_set_passable(sa_map* map, int row, int col, int passable);
+/* Connected-component label of a cell, -1 if it is blocked. Queries whose
+ * endpoints have different labels return SA_NO_PATH without a search. */
+SA_EXPORT int sa_map_component(const sa_map* map, int row, int col);
+
+/* Heuristics. Builds up to max_dims (at most 16) FastMap dimensions;
+ * returns the number built. The embedding is owned by the handle and valid
+ * until it is rebuilt or the map freed: sa_embedding_data points to a
+ * row-major rows x cols x stride float array whose first dims entries per
+ * cell are the coordinates (the rest is zero padding). */
+SA_EXPORT int sa_build_fastmap(sa_map* map, int max_dims, uint32_t seed);
+/* Picks the dimension per map: adds axes while A* on the n x 4 sample
+ * queries keeps getting cheaper (see tune_fastmap). Returns the dims kept. */
+SA_EXPORT int sa_tune_fastmap(sa_map* map, int max_dims, uint32_t seed, int n, const int32_t* queries,
+                              ptrdiff_t query_row_stride, ptrdiff_t query_col_stride);
+/* Replaces the embedding with a caller-computed rows x cols x dims array. */
+SA_EXPORT int sa_set_embedding(sa_map* map, const float* coords, int dims, ptrdiff_t row_stride,
+                               ptrdiff_t col_stride, ptrdiff_t dim_stride);
+SA_EXPORT int sa_embedding_dims(const sa_map* map);
+SA_EXPORT int sa_embedding_stride(const sa_map* map);
+SA_EXPORT const float* sa_embedding_data(const sa_map* map);
+
+/* Single query. Writes the path cost to *cost (INFINITY when there is no
+ * path, which returns SA_NO_PATH). If path is not NULL it receives up to
+ * capacity (row, col) pairs; *length (if not NULL) always gets the number
+ * of cells on the path. */
+SA_EXPORT int sa_query(sa_map* map, int heuristic, int start_row, int start_col, int goal_row, int goal_col,
+                       float* cost, int32_t* path, ptrdiff_t path_row_stride, ptrdiff_t path_col_stride,
+                       int capacity, int* length, uint64_t* expansions);
+
+/* n queries given as an n x 4 array of (start_row, start_col, goal_row,
+ * goal_col). costs[i] is the path cost or INFINITY; lengths (optional) the
+ * number of cells on the path or 0. *expansions (optional) is the total.
+ * threads <= 0 uses every hardware thread. */
+SA_EXPORT int sa_query_batch(const sa_map* map, int heuristic, int n, const int32_t* queries,
+                             ptrdiff_t query_row_stride, ptrdiff_t query_col_stride, float* costs,
+                             ptrdiff_t cost_stride, int32_t* lengths, ptrdiff_t length_stride,
+                             uint64_t* expansions, int threads);
+
+/* Distance field from a source cell into a rows x cols float array
+ * (INFINITY where unreachable). weights, if not NULL, is a rows x cols x 8
+ * array of non-negative move costs indexed by direction (DIR_DR/DIR_DC order in
+ * grid_map.h), INFINITY for no move; a negative or NaN cost on a move from a
+ * free cell is SA_ERR_ARGUMENT. Otherwise moves cost 1 and sqrt(2). */
+SA_EXPORT int sa_dijkstra(const sa_map* map, int source_row, int source_col, const float* weights,
+                          ptrdiff_t weight_row_stride, ptrdiff_t weight_col_stride, ptrdiff_t weight_dir_stride,
+                          float* dist, ptrdiff_t dist_row_stride, ptrdiff_t dist_col_stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEARCH_CAPI_H */
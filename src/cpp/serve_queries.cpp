@@ -0,0 +1,58 @@
+// Resident grid query server: keeps maps (and FastMap embeddings) in a
+// memory-budgeted cache and answers path queries over a Unix domain socket
+// or stdin/stdout.
+// Usage: serve_queries [socket_path|-] [threads] [fastmap_dims] [batch_size] [batch_window_us] [budget_mb] [map_root|-] [map_file...]
+// "-" serves stdin/stdout. The listed maps are preloaded and addressable by
+// position; with a map_root, requests may also name other .map files under
+// it by relative path ("-", the default, allows only the listed maps).
+// budget_mb = 0 never evicts. The protocol is described in query_server.h; query_client is
+// the matching client and load generator.
+#include "query_server.h"
+#include "bench_util.h"
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    string socket_path = argc > 1 ? argv[1] : "/tmp/search.sock";
+    int threads = argc > 2 ? stoi(argv[2]) : (int)max(1u, thread::hardware_concurrency());
+    int fastmap_dims = argc > 3 ? stoi(argv[3]) : 5;
+    int batch_size = argc > 4 ? stoi(argv[4]) : 32;
+    int batch_window_us = argc > 5 ? stoi(argv[5]) : 200;
+    double budget_mb = argc > 6 ? stod(argv[6]) : 1024;
+    string map_root = argc > 7 ? argv[7] : "-";
+    vector<string> map_files(argv + min(argc, 8), argv + argc);
+    if (map_files.empty()) map_files.push_back("AcrosstheCape.map");
+
+    Timer timer;
+    MapRegistryOptions options;
+    options.fastmap_dims = fastmap_dims;
+    options.memory_budget = (size_t)(budget_mb * 1048576);
+    QueryServer server(map_files, options);
+    server.threads = threads;
+    server.batch_size = max(1, batch_size);
+    server.batch_window = chrono::microseconds(batch_window_us);
+    if (map_root != "-") server.map_root = map_root;
+    // Logs go to stderr: stdout carries replies in stdin mode
+    for (size_t i = 0; i < map_files.size(); ++i) {
+        MapHandle m = server.maps().acquire(map_files[i]);
+        if (!m) continue;
+        cerr << "Map " << i << ": " << m->name << " " << m->grid.rows << "x" << m->grid.cols << ", FastMap "
+             << m->embedding.dims << " dims, " << m->bytes() / 1048576.0 << " MB\n";
+    }
+    cerr << server.maps().stats_line() << "\n";
+    cerr << "Loaded in " << timer.seconds() << " s; " << threads << " workers, batches of up to " << batch_size
+         << " within " << batch_window_us << " us\n";
+    if (!server.map_root.empty()) cerr << "Loading other maps on demand from " << server.map_root << "\n";
+
+    if (socket_path == "-") {
+        server.serve_stdio();
+    } else {
+        cerr << "Listening on " << socket_path << "\n";
+        if (!server.serve_socket(socket_path)) return 1;
+    }
+    cerr << server.stats_line() << "\n";
+    return 0;
+}
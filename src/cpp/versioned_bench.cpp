@@ -0,0 +1,207 @@
+// Queries under concurrent obstacle updates: reader threads run A* over the
+// scenarios while writer threads close small clusters of cells and reopen
+// them one batch later. Each mode runs for the same time and reports query
+// throughput, latency (including any wait for the map) and update rate:
+//   static    plain GridMap, no writers (baseline)
+//   snapshot  VersionedGrid, no writers (cost of the tile indirection)
+//   rwlock    GridMap edited in place under a shared_mutex, with writers
+//   rcu       VersionedGrid with writers; readers pin a snapshot, no locks
+// After the rcu run the final snapshot is checked against a flat copy of it
+// (same costs), and every reader checks its pinned versions never go back.
+// Usage: versioned_bench [map_file] [scen_file] [readers] [writers] [seconds] [batch_cells] [write_pause_us] [max_scenarios]
+#include "grid_map.h"
+#include "node_store.h"
+#include "grid_astar.h"
+#include "grid_components.h"
+#include "versioned_grid.h"
+#include "bench_util.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+enum class Mode { Static, Snapshot, RwLock, Rcu };
+
+struct RunResult {
+    uint64_t queries = 0;
+    uint64_t expansions = 0;
+    uint64_t batches = 0;
+    uint64_t version_regressions = 0;
+    vector<double> latencies_us;
+    double seconds = 0;
+};
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    string scen_file = argc > 2 ? argv[2] : "AcrosstheCape.map.scen";
+    int readers = argc > 3 ? stoi(argv[3]) : 4;
+    int writers = argc > 4 ? stoi(argv[4]) : 1;
+    double seconds = argc > 5 ? stod(argv[5]) : 2.0;
+    int batch_cells = argc > 6 ? stoi(argv[6]) : 16;
+    int write_pause_us = argc > 7 ? stoi(argv[7]) : 1000;
+    int max_scenarios = argc > 8 ? stoi(argv[8]) : 1000;
+
+    GridMap base = read_grid_map(map_file);
+    ComponentIndex components(base);
+    vector<Scenario> all = read_scenarios(scen_file), scenarios;
+    int n = min<int>(max_scenarios, all.size());
+    for (int i = 0; i < n; ++i) {
+        const Scenario& s = all[(size_t)i * all.size() / n];
+        if (components.connected(s.start, s.goal)) scenarios.push_back(s);
+    }
+    if (scenarios.empty()) {
+        cerr << "No connected scenarios" << endl;
+        return 1;
+    }
+    cout << "Map " << base.rows << "x" << base.cols << ", " << scenarios.size() << " scenarios, " << readers
+         << " readers, " << writers << " writers, batches of " << batch_cells << " cells every " << write_pause_us
+         << " us, " << thread::hardware_concurrency() << " hardware threads\n\n";
+
+    auto run = [&](Mode mode, GridMap& flat, VersionedGrid* versioned) {
+        RunResult result;
+        shared_mutex map_mutex;
+        atomic<bool> stop{false};
+        vector<RunResult> per_reader(readers);
+        vector<uint64_t> per_writer(writers, 0);
+        bool editing = mode == Mode::RwLock || mode == Mode::Rcu;
+
+        auto reader = [&](int id) {
+            RunResult& out = per_reader[id];
+            FlatNodeStore store;
+            uint64_t last_version = 0;
+            for (size_t q = id; !stop.load(memory_order_relaxed); q += readers) {
+                const Scenario& s = scenarios[q % scenarios.size()];
+                SearchStats stats;
+                Timer timer;
+                if (mode == Mode::Static) {
+                    grid_a_star_search(flat, s.start, s.goal, store, FlatNodeStore::heuristic, &stats);
+                } else if (mode == Mode::RwLock) {
+                    shared_lock<shared_mutex> lock(map_mutex);
+                    if (flat.is_passable(s.start.first, s.start.second) &&
+                        flat.is_passable(s.goal.first, s.goal.second))
+                        grid_a_star_search(flat, s.start, s.goal, store, FlatNodeStore::heuristic, &stats);
+                } else {
+                    VersionedGrid::Pin pin(*versioned, id);
+                    if (pin->version < last_version) ++out.version_regressions;
+                    last_version = pin->version;
+                    if (pin->is_passable(s.start.first, s.start.second) &&
+                        pin->is_passable(s.goal.first, s.goal.second))
+                        grid_a_star_search(*pin, s.start, s.goal, store, FlatNodeStore::heuristic, &stats);
+                }
+                out.latencies_us.push_back(timer.seconds() * 1e6);
+                out.expansions += stats.expansions;
+                ++out.queries;
+            }
+        };
+        // Closes a cluster, then reopens it with the next batch, so the map
+        // keeps returning to its original state
+        auto writer = [&](int id) {
+            mt19937 rng(1000 + id);
+            vector<CellEdit> edits;
+            while (!stop.load(memory_order_relaxed)) {
+                if (edits.empty()) {
+                    int r0 = rng() % flat.rows, c0 = rng() % flat.cols;
+                    for (int k = 0; k < batch_cells; ++k) {
+                        int r = r0 + (int)(rng() % 9) - 4, c = c0 + (int)(rng() % 9) - 4;
+                        if (flat.in_bounds(r, c) && base.passable[base.index(r, c)]) edits.push_back({r, c, 0});
+                    }
+                } else {
+                    for (CellEdit& e : edits) e.passable = 1;
+                }
+                if (mode == Mode::RwLock) {
+                    unique_lock<shared_mutex> lock(map_mutex);
+                    for (const CellEdit& e : edits) flat.passable[flat.index(e.row, e.col)] = e.passable;
+                } else {
+                    versioned->apply(edits);
+                }
+                if (!edits.empty() && edits[0].passable) edits.clear();
+                ++per_writer[id];
+                if (write_pause_us > 0) this_thread::sleep_for(chrono::microseconds(write_pause_us));
+            }
+            // Leave the map as it started
+            if (!edits.empty()) {
+                for (CellEdit& e : edits) e.passable = 1;
+                if (mode == Mode::RwLock) {
+                    unique_lock<shared_mutex> lock(map_mutex);
+                    for (const CellEdit& e : edits) flat.passable[flat.index(e.row, e.col)] = 1;
+                } else {
+                    versioned->apply(edits);
+                }
+            }
+        };
+
+        Timer timer;
+        vector<thread> threads;
+        for (int i = 0; i < readers; ++i) threads.emplace_back(reader, i);
+        for (int i = 0; editing && i < writers; ++i) threads.emplace_back(writer, i);
+        this_thread::sleep_for(chrono::duration<double>(seconds));
+        stop = true;
+        for (thread& t : threads) t.join();
+        result.seconds = timer.seconds();
+        for (RunResult& r : per_reader) {
+            result.queries += r.queries;
+            result.expansions += r.expansions;
+            result.version_regressions += r.version_regressions;
+            result.latencies_us.insert(result.latencies_us.end(), r.latencies_us.begin(), r.latencies_us.end());
+        }
+        for (uint64_t b : per_writer) result.batches += b;
+        return result;
+    };
+
+    cout << setw(10) << "mode" << setw(12) << "queries/s" << setw(12) << "Mexp/s" << setw(10) << "p50_us"
+         << setw(10) << "p99_us" << setw(11) << "batches/s" << "\n";
+    auto row = [&](const string& name, RunResult& r) {
+        sort(r.latencies_us.begin(), r.latencies_us.end());
+        auto pct = [&](double p) {
+            return r.latencies_us.empty() ? 0.0 : r.latencies_us[min(r.latencies_us.size() - 1,
+                                                                     (size_t)(p * r.latencies_us.size()))];
+        };
+        cout << setw(10) << name << setw(12) << fixed << setprecision(0) << r.queries / r.seconds << setw(12)
+             << setprecision(2) << r.expansions / r.seconds / 1e6 << setw(10) << setprecision(1) << pct(0.5)
+             << setw(10) << pct(0.99) << setw(11) << setprecision(0) << r.batches / r.seconds << "\n";
+    };
+
+    GridMap flat = base;
+    RunResult static_run = run(Mode::Static, flat, nullptr);
+    row("static", static_run);
+    VersionedGrid idle(base, readers);
+    RunResult snapshot_run = run(Mode::Snapshot, flat, &idle);
+    row("snapshot", snapshot_run);
+    RunResult rwlock_run = run(Mode::RwLock, flat, nullptr);
+    row("rwlock", rwlock_run);
+    VersionedGrid versioned(base, readers);
+    RunResult rcu_run = run(Mode::Rcu, flat, &versioned);
+    row("rcu", rcu_run);
+
+    VersionedGridStats stats = versioned.stats();
+    cout << "\nrcu: " << stats.batches << " versions published, " << setprecision(2)
+         << (double)stats.tiles_copied / max<uint64_t>(stats.batches, 1) << " tiles copied per batch ("
+         << sizeof(GridSnapshot::Tile) << " B each), " << stats.reclaimed << " objects reclaimed, " << stats.retired
+         << " still retired (" << stats.retired_bytes / 1024 << " KB), " << rcu_run.version_regressions
+         << " version regressions\n";
+
+    // The final snapshot must search exactly like a flat copy of itself
+    FlatNodeStore store;
+    int wrong = 0;
+    {
+        VersionedGrid::Pin pin(versioned, 0);
+        GridMap copy = pin->materialize();
+        if (copy.passable != base.passable) ++wrong;
+        for (size_t i = 0; i < min<size_t>(scenarios.size(), 100); ++i) {
+            const Scenario& s = scenarios[i];
+            SearchStats a, b;
+            bool found_a = grid_a_star_search(*pin, s.start, s.goal, store, FlatNodeStore::heuristic, &a);
+            bool found_b = grid_a_star_search(copy, s.start, s.goal, store, FlatNodeStore::heuristic, &b);
+            if (found_a != found_b || fabs(a.cost - b.cost) > 1e-3f * (1 + b.cost)) ++wrong;
+        }
+    }
+    cout << "Final snapshot check: " << wrong << " mismatches\n";
+    return wrong == 0 && rcu_run.version_regressions == 0 ? 0 : 1;
+}
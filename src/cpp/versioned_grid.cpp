@@ -0,0 +1,133 @@
+#include "versioned_grid.h"
+#include <algorithm>
+#include <cstring>
+
+GridMap GridSnapshot::materialize() const {
+    GridMap map;
+    map.rows = rows;
+    map.cols = cols;
+    map.passable.resize(size());
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < cols; ++c) map.passable[index(r, c)] = is_passable(r, c);
+    return map;
+}
+
+VersionedGrid::VersionedGrid(const GridMap& map, int max_readers) : slots(max(max_readers, 1)) {
+    GridSnapshot* snapshot = new GridSnapshot;
+    snapshot->version = 1;
+    snapshot->rows = map.rows;
+    snapshot->cols = map.cols;
+    snapshot->tile_cols = (map.cols + GridSnapshot::TILE_MASK) >> GridSnapshot::TILE_SHIFT;
+    int tile_rows = (map.rows + GridSnapshot::TILE_MASK) >> GridSnapshot::TILE_SHIFT;
+    for (int tr = 0; tr < tile_rows; ++tr) {
+        for (int tc = 0; tc < snapshot->tile_cols; ++tc) {
+            GridSnapshot::Tile* tile = new GridSnapshot::Tile;
+            memset(tile->cells, 0, sizeof(tile->cells)); // cells past the map edge stay blocked
+            for (int r = 0; r < GridSnapshot::TILE; ++r) {
+                for (int c = 0; c < GridSnapshot::TILE; ++c) {
+                    int mr = tr * GridSnapshot::TILE + r, mc = tc * GridSnapshot::TILE + c;
+                    if (map.is_passable(mr, mc)) tile->cells[r << GridSnapshot::TILE_SHIFT | c] = 1;
+                }
+            }
+            snapshot->tiles.push_back(tile);
+        }
+    }
+    counters.version = 1;
+    current.store(snapshot, memory_order_release);
+}
+
+VersionedGrid::~VersionedGrid() {
+    // Readers must be gone; everything not retired belongs to the current
+    // snapshot
+    for (const Retired& r : retired) {
+        delete r.snapshot;
+        delete r.tile;
+    }
+    const GridSnapshot* snapshot = current.load(memory_order_acquire);
+    for (const GridSnapshot::Tile* tile : snapshot->tiles) delete tile;
+    delete snapshot;
+}
+
+VersionedGrid::Pin::Pin(VersionedGrid& grid, int reader) : slot(grid.slots[reader].epoch) {
+    // Announce the epoch before loading the pointer (both seq_cst): a
+    // writer that unlinks this snapshot afterwards tags it with a later
+    // epoch and sees this slot when it scans
+    slot.store(grid.global_epoch.load());
+    snapshot = grid.current.load();
+}
+
+VersionedGrid::Pin::~Pin() {
+    slot.store(0, memory_order_release);
+}
+
+uint64_t VersionedGrid::apply(const vector<CellEdit>& edits) {
+    lock_guard<mutex> lock(write_mutex);
+    const GridSnapshot* old = current.load(memory_order_relaxed);
+    GridSnapshot* next = new GridSnapshot(*old);
+    next->version = old->version + 1;
+
+    // Each touched tile is copied once per batch
+    vector<GridSnapshot::Tile*> copies(old->tiles.size(), nullptr);
+    vector<const GridSnapshot::Tile*> replaced;
+    for (const CellEdit& e : edits) {
+        if (!old->in_bounds(e.row, e.col)) continue;
+        int t = (e.row >> GridSnapshot::TILE_SHIFT) * old->tile_cols + (e.col >> GridSnapshot::TILE_SHIFT);
+        int offset = (e.row & GridSnapshot::TILE_MASK) << GridSnapshot::TILE_SHIFT |
+                     (e.col & GridSnapshot::TILE_MASK);
+        uint8_t value = e.passable != 0;
+        if ((copies[t] ? copies[t]->cells[offset] : old->tiles[t]->cells[offset]) == value) continue;
+        if (!copies[t]) {
+            copies[t] = new GridSnapshot::Tile(*old->tiles[t]);
+            replaced.push_back(old->tiles[t]);
+            next->tiles[t] = copies[t];
+        }
+        copies[t]->cells[offset] = value;
+    }
+    if (replaced.empty()) {
+        delete next;
+        return old->version;
+    }
+
+    current.store(next); // publish
+    uint64_t epoch = global_epoch.fetch_add(1) + 1;
+    retired.push_back({epoch, old, nullptr});
+    for (const GridSnapshot::Tile* tile : replaced) retired.push_back({epoch, nullptr, tile});
+    ++counters.batches;
+    counters.tiles_copied += replaced.size();
+    counters.version = next->version;
+    reclaim_locked();
+    return next->version;
+}
+
+size_t VersionedGrid::reclaim() {
+    lock_guard<mutex> lock(write_mutex);
+    return reclaim_locked();
+}
+
+size_t VersionedGrid::reclaim_locked() {
+    uint64_t oldest = UINT64_MAX; // oldest epoch a reader is pinned at
+    for (const ReaderSlot& s : slots) {
+        uint64_t e = s.epoch.load();
+        if (e != 0) oldest = min(oldest, e);
+    }
+    auto safe = partition(retired.begin(), retired.end(), [&](const Retired& r) { return r.epoch > oldest; });
+    size_t freed = retired.end() - safe;
+    for (auto it = safe; it != retired.end(); ++it) {
+        delete it->snapshot;
+        delete it->tile;
+    }
+    retired.erase(safe, retired.end());
+    counters.reclaimed += freed;
+    return freed;
+}
+
+VersionedGridStats VersionedGrid::stats() const {
+    lock_guard<mutex> lock(write_mutex);
+    VersionedGridStats s = counters;
+    s.live_tiles = current.load(memory_order_relaxed)->tiles.size();
+    s.retired = retired.size();
+    for (const Retired& r : retired)
+        s.retired_bytes += r.tile ? sizeof(GridSnapshot::Tile)
+                                  : sizeof(GridSnapshot) + r.snapshot->tiles.capacity() * sizeof(void*);
+    return s;
+}
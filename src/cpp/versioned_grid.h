@@ -0,0 +1,147 @@
+#ifndef VERSIONED_GRID_H
+#define VERSIONED_GRID_H
+
+#include "grid_map.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+// Immutable version of a grid: a table of pointers to 64x64 tiles of
+// passable bytes. It has GridMap's read interface, so grid_a_star_search
+// and the node stores run on it unchanged. Consecutive versions share every
+// tile an edit batch did not touch.
+struct GridSnapshot {
+    static const int TILE_SHIFT = 6;
+    static const int TILE = 1 << TILE_SHIFT;
+    static const int TILE_MASK = TILE - 1;
+
+    struct Tile {
+        uint8_t cells[TILE * TILE];
+    };
+
+    uint64_t version = 0;
+    int rows = 0;
+    int cols = 0;
+    int tile_cols = 0; // tiles per row of tiles
+    vector<const Tile*> tiles;
+
+    int index(int r, int c) const { return r * cols + c; }
+    int index(const pii& p) const { return p.first * cols + p.second; }
+    pii cell(int idx) const { return {idx / cols, idx % cols}; }
+    size_t size() const { return (size_t)rows * cols; }
+
+    bool in_bounds(int r, int c) const {
+        return r >= 0 && r < rows && c >= 0 && c < cols;
+    }
+
+    bool is_passable(int r, int c) const {
+        if (!in_bounds(r, c)) return false;
+        const Tile* t = tiles[(r >> TILE_SHIFT) * tile_cols + (c >> TILE_SHIFT)];
+        return t->cells[(r & TILE_MASK) << TILE_SHIFT | (c & TILE_MASK)];
+    }
+
+    // Same rules as GridMap::can_move
+    bool can_move(int r, int c, int dir) const {
+        int nr = r + DIR_DR[dir];
+        int nc = c + DIR_DC[dir];
+        if (!is_passable(nr, nc)) return false;
+        if (is_diagonal(dir) && (!is_passable(r, nc) || !is_passable(nr, c))) return false;
+        return true;
+    }
+
+    int dir_offset(int dir) const { return DIR_DR[dir] * cols + DIR_DC[dir]; }
+
+    // Flat copy, for code that needs a GridMap
+    GridMap materialize() const;
+};
+
+struct CellEdit {
+    int row, col;
+    uint8_t passable;
+};
+
+struct VersionedGridStats {
+    uint64_t version = 0;
+    uint64_t batches = 0;       // apply() calls that published a version
+    uint64_t tiles_copied = 0;
+    uint64_t reclaimed = 0;     // snapshots and tiles freed
+    size_t live_tiles = 0;      // tiles in the current version
+    size_t retired = 0;         // snapshots and tiles waiting for readers
+    size_t retired_bytes = 0;
+};
+
+// A grid that is edited while searches run on it, RCU style. Writers apply
+// a batch of cell edits to copies of the touched tiles (copy-on-write),
+// build a new tile table and publish it with one atomic pointer swap; the
+// old snapshot and the replaced tiles are retired. Readers pin the current
+// snapshot and search it for as long as they like: it never changes, and
+// the only synchronization is one store to the reader's own epoch slot and
+// one atomic load, both outside the expansion loop.
+//
+// Reclamation is epoch based. A reader announces the global epoch in its
+// slot before loading the snapshot pointer; a writer bumps the epoch after
+// unlinking a snapshot and tags the garbage with the new value. Garbage is
+// freed once every active slot shows that epoch or later, since readers
+// that pinned earlier may still hold it and later ones cannot reach it.
+// A reader that stays pinned holds back reclamation, not writers.
+//
+// Writers are serialized by a mutex. Reader slots are indexed by the
+// caller (0 to max_readers - 1), one per thread.
+class VersionedGrid {
+public:
+    VersionedGrid(const GridMap& map, int max_readers);
+    ~VersionedGrid();
+    VersionedGrid(const VersionedGrid&) = delete;
+    VersionedGrid& operator=(const VersionedGrid&) = delete;
+
+    // Pins the current snapshot for reader slot `reader` until destroyed
+    class Pin {
+    public:
+        Pin(VersionedGrid& grid, int reader);
+        ~Pin();
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+
+        const GridSnapshot& operator*() const { return *snapshot; }
+        const GridSnapshot* operator->() const { return snapshot; }
+
+    private:
+        atomic<uint64_t>& slot;
+        const GridSnapshot* snapshot;
+    };
+
+    // Applies the edits as one new version and returns its number; edits
+    // that change nothing publish nothing. Then frees what readers released.
+    uint64_t apply(const vector<CellEdit>& edits);
+    // Frees retired snapshots and tiles no reader can still see
+    size_t reclaim();
+
+    uint64_t version() const { return current.load(memory_order_acquire)->version; }
+    VersionedGridStats stats() const;
+
+private:
+    // Epoch slot on its own cache line; 0 = not reading
+    struct alignas(64) ReaderSlot {
+        atomic<uint64_t> epoch{0};
+    };
+    struct Retired {
+        uint64_t epoch;
+        const GridSnapshot* snapshot; // one of the two is set
+        const GridSnapshot::Tile* tile;
+    };
+
+    atomic<const GridSnapshot*> current{nullptr};
+    atomic<uint64_t> global_epoch{1};
+    vector<ReaderSlot> slots;
+
+    mutable mutex write_mutex;
+    vector<Retired> retired;
+    VersionedGridStats counters;
+
+    size_t reclaim_locked();
+};
+
+#endif // VERSIONED_GRID_H
@@ -0,0 +1,171 @@
+#include "wavefront.h"
+#include <algorithm>
+
+BitGrid passable_bits(const GridMap& map) {
+    BitGrid bits(map.rows, map.cols);
+    for (int r = 0; r < map.rows; ++r) {
+        const uint8_t* cells = &map.passable[(size_t)r * map.cols];
+        for (int c = 0; c < map.cols; ++c) {
+            if (cells[c]) bits.set(r, c);
+        }
+    }
+    return bits;
+}
+
+WavefrontBfs::WavefrontBfs(const GridMap& map, bool eight_connected)
+    : rows(map.rows), cols(map.cols), eight(eight_connected), passable(passable_bits(map)),
+      visited(map.rows, map.cols), frontier(map.rows, map.cols), next(map.rows, map.cols) {
+    words = passable.words;
+    mask_words = (words + 63) / 64;
+    word_mask.assign((size_t)rows * mask_words, 0);
+    next_word_mask = word_mask;
+    near.assign(mask_words, 0);
+    zero_row.assign(passable.stride, 0);
+}
+
+bool WavefrontBfs::row_has_bits(const vector<uint64_t>& mask, int r) const {
+    const uint64_t* m = &mask[(size_t)r * mask_words];
+    for (int i = 0; i < mask_words; ++i)
+        if (m[i]) return true;
+    return false;
+}
+
+// Clears row r of the current frontier, touching only its marked words.
+void WavefrontBfs::retire_row(int r) {
+    uint64_t* m = mask_row(word_mask, r);
+    uint64_t* f = frontier.row(r);
+    for (int i = 0; i < mask_words; ++i) {
+        for (uint64_t bits = m[i]; bits; bits &= bits - 1) f[i * 64 + __builtin_ctzll(bits)] = 0;
+        m[i] = 0;
+    }
+}
+
+// x shifted one column east (c -> c + 1) / west (c -> c - 1), at word w.
+// Reads the guard words at w = -1 and w = words.
+static inline uint64_t east(const uint64_t* x, int w) { return (x[w] << 1) | (x[w - 1] >> 63); }
+static inline uint64_t west(const uint64_t* x, int w) { return (x[w] >> 1) | (x[w + 1] << 63); }
+
+template <bool EIGHT>
+void WavefrontBfs::expand_span(int r, int w0, int w1, vector<uint32_t>* dist, uint32_t layer) {
+    const uint64_t* f = frontier.row(r);
+    const uint64_t* up = r > 0 ? frontier.row(r - 1) : zero_row.data() + 1;
+    const uint64_t* down = r + 1 < rows ? frontier.row(r + 1) : zero_row.data() + 1;
+    const uint64_t* p = passable.row(r);
+    const uint64_t* p_up = r > 0 ? passable.row(r - 1) : zero_row.data() + 1;
+    const uint64_t* p_down = r + 1 < rows ? passable.row(r + 1) : zero_row.data() + 1;
+    uint64_t* v = visited.row(r);
+    uint64_t* out = next.row(r);
+
+    // Branch-free word loop: the part worth vectorizing
+    for (int w = w0; w <= w1; ++w) {
+        uint64_t n = east(f, w) | west(f, w) | up[w] | down[w];
+        if (EIGHT) {
+            // A diagonal step from row r -+ 1 needs the cell beside it on
+            // that row (p_up / p_down) and the cell below/above it on row r
+            // (the neighbor row's frontier masked by p before shifting).
+            uint64_t up_ok_e = ((up[w] & p[w]) << 1) | ((up[w - 1] & p[w - 1]) >> 63);
+            uint64_t up_ok_w = ((up[w] & p[w]) >> 1) | ((up[w + 1] & p[w + 1]) << 63);
+            uint64_t down_ok_e = ((down[w] & p[w]) << 1) | ((down[w - 1] & p[w - 1]) >> 63);
+            uint64_t down_ok_w = ((down[w] & p[w]) >> 1) | ((down[w + 1] & p[w + 1]) << 63);
+            n |= (east(up, w) & p_up[w] & up_ok_e) | (west(up, w) & p_up[w] & up_ok_w) |
+                 (east(down, w) & p_down[w] & down_ok_e) | (west(down, w) & p_down[w] & down_ok_w);
+        }
+        out[w] = n & p[w] & ~v[w];
+    }
+
+    uint64_t* m = mask_row(next_word_mask, r);
+    for (int w = w0; w <= w1; ++w) {
+        uint64_t n = out[w];
+        if (!n) continue;
+        v[w] |= n;
+        m[w >> 6] |= 1ull << (w & 63);
+        // Edge bits spill into the next word over when shifted
+        if ((n & 1) && w > 0) m[(w - 1) >> 6] |= 1ull << ((w - 1) & 63);
+        if ((n >> 63) && w + 1 < words) m[(w + 1) >> 6] |= 1ull << ((w + 1) & 63);
+        reached += __builtin_popcountll(n);
+        if (dist) {
+            uint32_t* d = dist->data() + (size_t)r * cols + w * 64;
+            for (uint64_t bits = n; bits; bits &= bits - 1) d[__builtin_ctzll(bits)] = layer;
+        }
+    }
+}
+
+long WavefrontBfs::run(const vector<pii>& sources, long goal, vector<uint32_t>* dist) {
+    fill(visited.bits.begin(), visited.bits.end(), 0);
+    fill(frontier.bits.begin(), frontier.bits.end(), 0);
+    fill(next.bits.begin(), next.bits.end(), 0);
+    fill(word_mask.begin(), word_mask.end(), 0);
+    fill(next_word_mask.begin(), next_word_mask.end(), 0);
+    if (dist) dist->assign((size_t)rows * cols, WAVE_UNREACHED);
+    layers = 0;
+    reached = 0;
+
+    // Rows [row_lo, row_hi] may hold frontier bits
+    int row_lo = rows, row_hi = -1;
+    for (const pii& s : sources) {
+        int r = s.first, c = s.second;
+        if (r < 0 || r >= rows || c < 0 || c >= cols || !passable.test(r, c) || visited.test(r, c)) continue;
+        visited.set(r, c);
+        frontier.set(r, c);
+        for (int w = max(0, (c - 1) >> 6); w <= min(words - 1, (c + 1) >> 6); ++w)
+            mask_row(word_mask, r)[w >> 6] |= 1ull << (w & 63);
+        row_lo = min(row_lo, r);
+        row_hi = max(row_hi, r);
+        ++reached;
+        if (dist) (*dist)[(size_t)r * cols + c] = 0;
+        if ((long)r * cols + c == goal) return 0;
+    }
+
+    uint32_t layer = 0;
+    while (row_lo <= row_hi) {
+        ++layer;
+        ++layers;
+        int first = max(0, row_lo - 1), last = min(rows - 1, row_hi + 1);
+        int next_lo = rows, next_hi = -1;
+
+        for (int r = first; r <= last; ++r) {
+            // Words that can receive cells: marked in this or an adjacent row
+            fill(near.begin(), near.end(), 0);
+            for (int q = max(0, r - 1); q <= min(rows - 1, r + 1); ++q) {
+                const uint64_t* m = mask_row(word_mask, q);
+                for (int i = 0; i < mask_words; ++i) near[i] |= m[i];
+            }
+
+            // Expand each run of consecutive marked words in one pass
+            int start = -1, prev = -2;
+            for (int i = 0; i < mask_words; ++i) {
+                for (uint64_t bits = near[i]; bits; bits &= bits - 1) {
+                    int w = i * 64 + __builtin_ctzll(bits);
+                    if (w != prev + 1) {
+                        if (start >= 0) {
+                            if (eight) expand_span<true>(r, start, prev, dist, layer);
+                            else expand_span<false>(r, start, prev, dist, layer);
+                        }
+                        start = w;
+                    }
+                    prev = w;
+                }
+            }
+            if (start >= 0) {
+                if (eight) expand_span<true>(r, start, prev, dist, layer);
+                else expand_span<false>(r, start, prev, dist, layer);
+            }
+            if (row_has_bits(next_word_mask, r)) {
+                next_lo = min(next_lo, r);
+                next_hi = r;
+            }
+
+            // Row r - 1 of the old frontier has been read for the last time
+            if (r > first) retire_row(r - 1);
+        }
+        retire_row(last);
+
+        swap(frontier, next);
+        swap(word_mask, next_word_mask);
+        row_lo = next_lo;
+        row_hi = next_hi;
+
+        if (goal >= 0 && visited.test(goal / cols, goal % cols)) return layer;
+    }
+    return goal >= 0 ? -1 : (long)layer - 1;
+}
@@ -0,0 +1,77 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include "grid_map.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+const uint32_t WAVE_UNREACHED = UINT32_MAX;
+
+// Row-padded bitset over a grid: bit c % 64 of word c / 64 in a row is
+// column c. Every row has one zero guard word on each side so that word-wise
+// shifts can read w - 1 and w + 1 without bounds checks.
+struct BitGrid {
+    int rows = 0;
+    int cols = 0;
+    int words = 0;  // 64-bit words per row
+    int stride = 0; // words + 2 guard words
+    vector<uint64_t> bits;
+
+    BitGrid() = default;
+    BitGrid(int rows, int cols)
+        : rows(rows), cols(cols), words((cols + 63) / 64), stride(words + 2), bits((size_t)rows * stride, 0) {}
+
+    uint64_t* row(int r) { return &bits[(size_t)r * stride + 1]; }
+    const uint64_t* row(int r) const { return &bits[(size_t)r * stride + 1]; }
+    bool test(int r, int c) const { return row(r)[c >> 6] >> (c & 63) & 1; }
+    void set(int r, int c) { row(r)[c >> 6] |= 1ull << (c & 63); }
+};
+
+BitGrid passable_bits(const GridMap& map);
+
+// Breadth-first wavefront over a unit-cost grid, one layer per step.
+// The frontier is a BitGrid; a layer is a handful of shifts, ANDs and ORs per
+// 64-bit word of the rows the frontier touches, so each step processes 64
+// cells per word operation. Word loops have no carried dependence and are
+// left to the compiler to vectorize (see SEARCH_NATIVE in CMakeLists.txt).
+//
+// Eight-connected mode uses unit-cost diagonals with the same corner rule as
+// get_neighbors_8: a diagonal step needs both orthogonal cells free.
+class WavefrontBfs {
+public:
+    uint64_t layers = 0;
+    uint64_t reached = 0;
+
+    WavefrontBfs(const GridMap& map, bool eight_connected);
+
+    // Expands from all sources at once. With goal >= 0 (flat index) stops as
+    // soon as the goal is reached and returns its distance, else -1. With
+    // goal < 0 runs until the map is exhausted and returns the last layer.
+    // `dist`, if given, is resized to rows * cols and filled with distances
+    // (WAVE_UNREACHED elsewhere).
+    long run(const vector<pii>& sources, long goal = -1, vector<uint32_t>* dist = nullptr);
+
+private:
+    int rows, cols, words;
+    int mask_words; // words of word_mask per row
+    bool eight;
+    BitGrid passable;
+    BitGrid visited, frontier, next;
+    // Per row, one bit per word the frontier can spread into: words holding
+    // frontier bits, plus a neighbor word when a bit sits on the word edge.
+    // Only marked words are expanded, so a layer costs the frontier's width
+    // rather than the width of the rows it spans.
+    vector<uint64_t> word_mask, next_word_mask;
+    vector<uint64_t> near;
+    vector<uint64_t> zero_row;
+
+    uint64_t* mask_row(vector<uint64_t>& mask, int r) { return &mask[(size_t)r * mask_words]; }
+    bool row_has_bits(const vector<uint64_t>& mask, int r) const;
+    void retire_row(int r);
+    template <bool EIGHT>
+    void expand_span(int r, int w0, int w1, vector<uint32_t>* dist, uint32_t layer);
+};
+
+#endif // WAVEFRONT_H
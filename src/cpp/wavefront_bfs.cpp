@@ -0,0 +1,91 @@
+// Whole-map BFS distance fields with the bit-parallel wavefront, checked
+// against a plain queue BFS.
+// Usage: wavefront_bfs [map_file] [4|8] [sources]
+#include "grid_map.h"
+#include "wavefront.h"
+#include "bench_util.h"
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+
+using namespace std;
+
+// Reference: one cell at a time, same move rules as WavefrontBfs.
+vector<uint32_t> queue_bfs(const GridMap& map, const pii& source, bool eight) {
+    vector<uint32_t> dist(map.size(), WAVE_UNREACHED);
+    queue<int> q;
+    int s = map.index(source);
+    dist[s] = 0;
+    q.push(s);
+    while (!q.empty()) {
+        int cur = q.front();
+        q.pop();
+        int r = cur / map.cols, c = cur % map.cols;
+        for (int dir = 0; dir < 8; ++dir) {
+            if (!eight && is_diagonal(dir)) continue;
+            if (!map.can_move(r, c, dir)) continue;
+            int nb = cur + map.dir_offset(dir);
+            if (dist[nb] != WAVE_UNREACHED) continue;
+            dist[nb] = dist[cur] + 1;
+            q.push(nb);
+        }
+    }
+    return dist;
+}
+
+int main(int argc, char** argv) {
+    string map_file = argc > 1 ? argv[1] : "AcrosstheCape.map";
+    bool eight = argc > 2 ? string(argv[2]) != "4" : true;
+    int num_sources = argc > 3 ? stoi(argv[3]) : 10;
+
+    GridMap map = read_grid_map(map_file);
+    vector<int> free_cells;
+    for (int i = 0; i < (int)map.size(); ++i)
+        if (map.passable[i]) free_cells.push_back(i);
+    if (free_cells.empty()) {
+        cerr << "Map has no free cells" << endl;
+        return 1;
+    }
+
+    WavefrontBfs wave(map, eight);
+    mt19937 rng(1);
+    double wave_secs = 0, queue_secs = 0;
+    uint64_t cells = 0, layers = 0;
+    int mismatches = 0;
+
+    for (int i = 0; i < num_sources; ++i) {
+        pii source = map.cell(free_cells[rng() % free_cells.size()]);
+        vector<uint32_t> field;
+
+        Timer timer;
+        wave.run({source}, -1, &field);
+        wave_secs += timer.seconds();
+        cells += wave.reached;
+        layers += wave.layers;
+
+        timer.reset();
+        vector<uint32_t> expected = queue_bfs(map, source, eight);
+        queue_secs += timer.seconds();
+        if (field != expected) mismatches++;
+    }
+
+    cout << "Map " << map.rows << "x" << map.cols << ", " << (eight ? 8 : 4) << "-connected, "
+         << num_sources << " distance fields\n";
+    cout << "Wavefront: " << wave_secs * 1000 / num_sources << " ms/field, "
+         << cells / wave_secs / 1e6 << " M cells/s, " << layers / num_sources << " layers/field\n";
+    cout << "Queue BFS: " << queue_secs * 1000 / num_sources << " ms/field\n";
+    cout << "Mismatched fields: " << mismatches << "\n";
+
+    // Early-exit single-pair queries
+    Timer timer;
+    long total = 0;
+    for (int i = 0; i < num_sources; ++i) {
+        pii s = map.cell(free_cells[rng() % free_cells.size()]);
+        int g = free_cells[rng() % free_cells.size()];
+        total += max(0L, wave.run({s}, g));
+    }
+    cout << "Point queries: " << timer.seconds() * 1000 / num_sources << " ms/query (avg distance "
+         << (double)total / num_sources << ")\n";
+    return mismatches == 0 ? 0 : 1;
+}
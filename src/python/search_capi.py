@@ -0,0 +1,242 @@
+"""
+Thin ctypes wrapper around the C++ search engine (libsearch_capi, see
+src/cpp/search_capi.h).
+
+Arrays go to the library as pointer + byte strides, so numpy inputs and
+outputs are used in place, without conversion to Python objects:
+
+    engine = GridEngine.from_file("AcrosstheCape.map")
+    cost, path, expansions = engine.astar((r0, c0), (r1, c1))
+    dist = engine.dijkstra_with_weights((r0, c0))       # rows x cols float32
+    coords = engine.build_fastmap(5)                    # rows x cols x 5 view
+    costs, lengths, _ = engine.astar_batch(queries, heuristic="fastmap")
+
+The library is looked up in $SEARCH_CAPI_LIB, then in the usual CMake build
+directories next to the repository root.
+"""
+import ctypes
+import os
+
+import numpy as np
+
+OK = 0
+NO_PATH = 1
+ERR_CAPACITY = -3
+
+HEURISTICS = {"zero": 0, "octile": 1, "fastmap": 2}
+
+# Same order as DIR_DR / DIR_DC in grid_map.h: the last axis of a weights array
+DIRECTIONS = [(-1, -1), (-1, 0), (-1, 1), (0, -1), (0, 1), (1, -1), (1, 0), (1, 1)]
+
+_p = ctypes.c_void_p
+_i = ctypes.c_int
+_s = ctypes.c_ssize_t
+
+
+def _find_library():
+    env = os.environ.get("SEARCH_CAPI_LIB")
+    if env:
+        return env
+    root = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+    for build in ("build", "cmake-build-release"):
+        path = os.path.join(root, build, "libsearch_capi.so")
+        if os.path.exists(path):
+            return path
+    raise OSError("libsearch_capi.so not found; build the search_capi target or set SEARCH_CAPI_LIB")
+
+
+def _load():
+    lib = ctypes.CDLL(_find_library())
+    signatures = {
+        "sa_api_version": (_i, []),
+        "sa_last_error": (ctypes.c_char_p, []),
+        "sa_map_load": (_p, [ctypes.c_char_p]),
+        "sa_map_from_buffer": (_p, [_i, _i, _p, _s, _s]),
+        "sa_map_free": (None, [_p]),
+        "sa_map_rows": (_i, [_p]),
+        "sa_map_cols": (_i, [_p]),
+        "sa_map_passable": (_p, [_p]),
+        "sa_map_set_passable": (_i, [_p, _i, _i, _i]),
+        "sa_map_component": (_i, [_p, _i, _i]),
+        "sa_build_fastmap": (_i, [_p, _i, ctypes.c_uint32]),
+        "sa_tune_fastmap": (_i, [_p, _i, ctypes.c_uint32, _i, _p, _s, _s]),
+        "sa_set_embedding": (_i, [_p, _p, _i, _s, _s, _s]),
+        "sa_embedding_dims": (_i, [_p]),
+        "sa_embedding_stride": (_i, [_p]),
+        "sa_embedding_data": (_p, [_p]),
+        "sa_query": (_i, [_p, _i, _i, _i, _i, _i, _p, _p, _s, _s, _i, _p, _p]),
+        "sa_query_batch": (_i, [_p, _i, _i, _p, _s, _s, _p, _s, _p, _s, _p, _i]),
+        "sa_dijkstra": (_i, [_p, _i, _i, _p, _s, _s, _s, _p, _s, _s]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        fn = getattr(lib, name)
+        fn.restype = restype
+        fn.argtypes = argtypes
+    return lib
+
+
+_lib = _load()
+
+
+def _check(status):
+    if status < 0:
+        raise RuntimeError(_lib.sa_last_error().decode())
+    return status
+
+
+def _ptr(a):
+    return a.ctypes.data
+
+
+class GridEngine:
+    """A loaded map plus its heuristic data. Not safe for concurrent calls;
+    astar_batch runs its queries on a thread pool inside the library."""
+
+    def __init__(self, handle):
+        self._handle = None
+        if not handle:
+            raise RuntimeError(_lib.sa_last_error().decode())
+        self._handle = handle
+        self.rows = _lib.sa_map_rows(handle)
+        self.cols = _lib.sa_map_cols(handle)
+
+    @classmethod
+    def from_file(cls, path):
+        return cls(_lib.sa_map_load(os.fsencode(path)))
+
+    @classmethod
+    def from_array(cls, passable):
+        """passable: 2-D array, nonzero = traversable (any dtype castable to uint8)."""
+        passable = np.asarray(passable)
+        if passable.dtype != np.uint8:
+            passable = passable.astype(np.uint8)
+        rows, cols = passable.shape
+        return cls(_lib.sa_map_from_buffer(rows, cols, _ptr(passable), *passable.strides))
+
+    def close(self):
+        if self._handle:
+            _lib.sa_map_free(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    @property
+    def passable(self):
+        """Read-only rows x cols uint8 view of the engine's grid."""
+        buf = (ctypes.c_uint8 * (self.rows * self.cols)).from_address(_lib.sa_map_passable(self._handle))
+        view = np.frombuffer(buf, dtype=np.uint8).reshape(self.rows, self.cols)
+        view.flags.writeable = False
+        return view
+
+    def set_passable(self, row, col, passable):
+        """Blocks or opens one cell. A built embedding is updated to match;
+        one from set_embedding is dropped when a cell opens."""
+        _check(_lib.sa_map_set_passable(self._handle, row, col, int(bool(passable))))
+
+    def component(self, row, col):
+        """Connected-component label of a cell, -1 if it is blocked."""
+        label = _lib.sa_map_component(self._handle, row, col)
+        return label if label >= -1 else _check(label)
+
+    # Heuristics
+
+    def build_fastmap(self, dims=5, seed=0):
+        """Builds a FastMap embedding of up to dims dimensions and returns a
+        rows x cols x k view of it (valid until the next rebuild)."""
+        _check(_lib.sa_build_fastmap(self._handle, dims, seed))
+        return self.embedding
+
+    def tune_fastmap(self, sample_queries, max_dims=16, seed=0):
+        """Builds FastMap axes while they keep cutting A* expansions on the
+        n x 4 sample_queries; returns a view of the embedding kept."""
+        queries = np.asarray(sample_queries, dtype=np.int32)
+        _check(_lib.sa_tune_fastmap(self._handle, max_dims, seed, queries.shape[0], _ptr(queries),
+                                    *queries.strides))
+        return self.embedding
+
+    def set_embedding(self, coords):
+        coords = np.asarray(coords, dtype=np.float32)
+        if coords.shape[:2] != (self.rows, self.cols) or coords.ndim != 3:
+            raise ValueError("embedding must be rows x cols x dims")
+        _check(_lib.sa_set_embedding(self._handle, _ptr(coords), coords.shape[2], *coords.strides))
+
+    @property
+    def embedding(self):
+        dims = _lib.sa_embedding_dims(self._handle)
+        if dims == 0:
+            return None
+        stride = _lib.sa_embedding_stride(self._handle)
+        n = self.rows * self.cols * stride
+        buf = (ctypes.c_float * n).from_address(_lib.sa_embedding_data(self._handle))
+        return np.frombuffer(buf, dtype=np.float32).reshape(self.rows, self.cols, stride)[:, :, :dims]
+
+    # Queries
+
+    def astar(self, start, goal, heuristic="octile", path_capacity=None):
+        """Returns (cost, path, expansions); path is an n x 2 int32 array of
+        (row, col), or None with cost = inf when the goal is unreachable."""
+        h = HEURISTICS[heuristic]
+        cost = ctypes.c_float()
+        length = ctypes.c_int()
+        expansions = ctypes.c_uint64()
+        capacity = path_capacity or 4 * (self.rows + self.cols)
+        while True:
+            path = np.empty((capacity, 2), dtype=np.int32)
+            status = _lib.sa_query(self._handle, h, start[0], start[1], goal[0], goal[1], ctypes.byref(cost),
+                                   _ptr(path), *path.strides, capacity, ctypes.byref(length),
+                                   ctypes.byref(expansions))
+            if status != ERR_CAPACITY:
+                break
+            capacity = length.value
+        _check(status)
+        if status == NO_PATH:
+            return float("inf"), None, expansions.value
+        return cost.value, path[:length.value], expansions.value
+
+    def astar_batch(self, queries, heuristic="octile", threads=0, costs=None, lengths=None):
+        """queries: n x 4 array of (start_row, start_col, goal_row, goal_col).
+        Results go into costs / lengths if given (float32 / int32, length n).
+        Returns (costs, lengths, total expansions)."""
+        queries = np.asarray(queries, dtype=np.int32)
+        if queries.ndim != 2 or queries.shape[1] != 4:
+            raise ValueError("queries must be n x 4")
+        n = queries.shape[0]
+        if costs is None:
+            costs = np.empty(n, dtype=np.float32)
+        elif costs.dtype != np.float32 or costs.ndim != 1 or costs.shape[0] < n:
+            raise ValueError("costs must be a float32 vector of length n")
+        if lengths is None:
+            lengths = np.empty(n, dtype=np.int32)
+        elif lengths.dtype != np.int32 or lengths.ndim != 1 or lengths.shape[0] < n:
+            raise ValueError("lengths must be an int32 vector of length n")
+        expansions = ctypes.c_uint64()
+        _check(_lib.sa_query_batch(self._handle, HEURISTICS[heuristic], n, _ptr(queries), *queries.strides,
+                                   _ptr(costs), costs.strides[0], _ptr(lengths), lengths.strides[0],
+                                   ctypes.byref(expansions), threads))
+        return costs, lengths, expansions.value
+
+    def dijkstra_with_weights(self, source, edge_weights=None, out=None):
+        """Distance field from source as a rows x cols float32 array (inf
+        where unreachable). edge_weights: optional rows x cols x 8 array of
+        move costs in DIRECTIONS order; default octile costs."""
+        if out is None:
+            out = np.empty((self.rows, self.cols), dtype=np.float32)
+        elif out.dtype != np.float32 or out.shape != (self.rows, self.cols):
+            raise ValueError("out must be a rows x cols float32 array")
+        if edge_weights is None:
+            weights, strides = None, (0, 0, 0)
+        else:
+            weights = np.asarray(edge_weights, dtype=np.float32)
+            if weights.shape != (self.rows, self.cols, 8):
+                raise ValueError("edge_weights must be rows x cols x 8")
+            strides = weights.strides
+        _check(_lib.sa_dijkstra(self._handle, source[0], source[1],
+                                None if weights is None else _ptr(weights), *strides, _ptr(out), *out.strides))
+        return out